@@ -0,0 +1,425 @@
+// Audio pre-filter benchmark
+//
+//   audio-filter-bench [--step MS] [--vad-thold F] [--no-vad]
+//                      [--highpass HZ] [--notch LIST] [--spectral-gate DB]
+//                      [FILE.wav | DIR ...]
+//
+// 1. Cost: filters a synthetic minute of audio step by step with several
+//    filter chains (and a plain scalar biquad cascade for reference) and
+//    reports CPU time per second of audio.
+// 2. Replay: runs recordings (--record-dir output, or any mono 16 kHz WAV)
+//    through the VAD gate with and without the configured filter and counts
+//    the steps that would have reached whisper_full. When a recording has its
+//    .jsonl sidecar, steps are cut exactly as the live loop cut them and the
+//    live count is shown next to the replayed one.
+//
+// Without filter options the configured chain is --highpass 80 --notch
+// 60,120,180; without files the replay uses the synthetic minute.
+
+#include "audio_filter.h"
+#include "util.h"
+#include "vad_gate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static constexpr float k_pi = 3.14159265358979323846f;
+
+// ---------------------------------------------------------------------------
+// Input
+// ---------------------------------------------------------------------------
+
+struct replay_step {
+    size_t offset;
+    size_t samples;
+};
+
+struct recording {
+    std::string              name;
+    std::vector<float>       samples;
+    std::vector<replay_step> steps;       // from the sidecar; empty = cut by --step
+    int                      live_calls = -1;
+};
+
+static uint16_t get_u16(const unsigned char * p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const unsigned char * p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Mono 16 kHz PCM16 or IEEE float. A data size the writer has not patched
+// yet (recording still in progress) is taken as "up to end of file".
+static bool read_wav(const std::string & path, std::vector<float> & out) {
+    std::ifstream f(path, std::ios::binary);
+    const std::vector<unsigned char> buf((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (buf.size() < 12 || memcmp(buf.data(), "RIFF", 4) != 0 || memcmp(buf.data() + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "%s: not a WAV file\n", path.c_str());
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= buf.size()) {
+        const uint32_t size = get_u32(&buf[pos + 4]);
+        const size_t   body = pos + 8;
+        if (memcmp(&buf[pos], "fmt ", 4) == 0 && body + 16 <= buf.size()) {
+            format   = get_u16(&buf[body]);
+            channels = get_u16(&buf[body + 2]);
+            rate     = get_u32(&buf[body + 4]);
+            bits     = get_u16(&buf[body + 14]);
+        } else if (memcmp(&buf[pos], "data", 4) == 0) {
+            if (channels != 1 || rate != k_sample_rate || !((format == 1 && bits == 16) || (format == 3 && bits == 32))) {
+                fprintf(stderr, "%s: need mono 16 kHz PCM16 or float32\n", path.c_str());
+                return false;
+            }
+            const size_t avail = buf.size() - body;
+            const size_t bytes = size == 0 || size > avail ? avail : size;
+            if (format == 3) {
+                out.resize(bytes / 4);
+                memcpy(out.data(), &buf[body], out.size() * 4);
+            } else {
+                out.resize(bytes / 2);
+                for (size_t i = 0; i < out.size(); ++i) {
+                    out[i] = (int16_t)get_u16(&buf[body + 2 * i]) / 32768.0f;
+                }
+            }
+            return true;
+        }
+        pos = body + size + (size & 1);
+    }
+    fprintf(stderr, "%s: no data chunk\n", path.c_str());
+    return false;
+}
+
+static bool json_int(const std::string & line, const char * key, long long & out) {
+    const size_t at = line.find(key);
+    if (at == std::string::npos) return false;
+    out = strtoll(line.c_str() + at + strlen(key), nullptr, 10);
+    return true;
+}
+
+static void read_sidecar(const std::string & path, recording & rec) {
+    std::ifstream f(path);
+    if (!f) return;
+
+    rec.live_calls = 0;
+    std::string line;
+    while (std::getline(f, line)) {
+        long long offset = 0, samples = 0;
+        if (!json_int(line, "\"offset\":", offset) || !json_int(line, "\"samples\":", samples)) continue;
+        if (offset < 0 || samples <= 0 || (size_t)(offset + samples) > rec.samples.size()) continue;
+        rec.steps.push_back({ (size_t)offset, (size_t)samples });
+        if (line.find("\"whisper\":true") != std::string::npos) {
+            ++rec.live_calls;
+        }
+    }
+}
+
+// A minute of room tone: broadband noise, a fridge compressor (60 Hz hum
+// plus harmonics) cycling on and off, footstep/door thumps, and a few
+// stretches of voiced "speech" (harmonic stack with syllable envelope).
+static std::vector<float> synthetic_minute() {
+    std::vector<float> out(60 * k_sample_rate);
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.0015f);
+
+    for (size_t i = 0; i < out.size(); ++i) {
+        const float t = (float)i / k_sample_rate;
+        float x = noise(rng);
+
+        const bool compressor_on = fmodf(t, 20.0f) >= 8.0f;
+        if (compressor_on) {
+            x += 0.010f * sinf(2 * k_pi * 60 * t) + 0.004f * sinf(2 * k_pi * 120 * t) + 0.002f * sinf(2 * k_pi * 180 * t);
+        }
+
+        const float since_thump = fmodf(t + 1.3f, 3.7f);
+        x += 0.05f * expf(-since_thump * 25.0f) * sinf(2 * k_pi * 35 * since_thump);
+
+        const bool speaking = fmodf(t, 15.0f) < 3.0f && t >= 5.0f;
+        if (speaking) {
+            const float envelope = 0.5f - 0.5f * cosf(2 * k_pi * 4.0f * t);
+            for (int h = 1; h <= 8; ++h) {
+                x += envelope * 0.03f / h * sinf(2 * k_pi * 180 * h * t);
+            }
+        }
+        out[i] = x;
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Cost
+// ---------------------------------------------------------------------------
+
+// Same sections as biquad_cascade, one after the other per sample.
+class scalar_cascade {
+public:
+    explicit scalar_cascade(const std::vector<biquad_cascade::coeffs> & sections)
+        : c_(sections), z_(sections.size() * 2, 0.0f) {}
+
+    void process(const float * in, float * out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            float x = in[i];
+            for (size_t s = 0; s < c_.size(); ++s) {
+                float & z1 = z_[2 * s];
+                float & z2 = z_[2 * s + 1];
+                const float y = c_[s].b0 * x + z1;
+                z1 = c_[s].b1 * x - c_[s].a1 * y + z2;
+                z2 = c_[s].b2 * x - c_[s].a2 * y;
+                x = y;
+            }
+            out[i] = x;
+        }
+    }
+
+private:
+    std::vector<biquad_cascade::coeffs> c_;
+    std::vector<float> z_;
+};
+
+// Best of several passes over the signal in step-sized blocks, in
+// microseconds of CPU per second of audio.
+template <typename Fn>
+static double cost_us_per_audio_s(const std::vector<float> & signal, size_t step, Fn && process) {
+    std::vector<float> out(step);
+    double best = 1e30;
+    for (int pass = 0; pass < 5; ++pass) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t off = 0; off < signal.size(); off += step) {
+            const size_t n = std::min(step, signal.size() - off);
+            process(signal.data() + off, out.data(), n);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+    return best / ((double)signal.size() / k_sample_rate);
+}
+
+static void report_cost(const char * label, double us) {
+    printf("  %-34s %9.1f us/s   %8.0fx realtime\n", label, us, 1e6 / us);
+}
+
+static void run_cost(const std::vector<float> & signal, size_t step, const audio_filter_config & configured) {
+    printf("cost (%.0f s synthetic audio, %zu-sample steps, best of 5)\n",
+           (double)signal.size() / k_sample_rate, step);
+
+    audio_filter_config hp;
+    hp.highpass_hz = 80.0f;
+    audio_filter_config hp_notch = hp;
+    hp_notch.notch_hz = { 60.0f, 120.0f, 180.0f, 240.0f, 300.0f, 360.0f };
+    audio_filter_config gate;
+    gate.spectral_gate_db = 12.0f;
+    audio_filter_config all = hp_notch;
+    all.spectral_gate_db = 12.0f;
+
+    const struct { const char * label; audio_filter_config cfg; } chains[] = {
+        { "highpass 80 (2 sections)",         hp },
+        { "highpass + 6 notches (8 sections)", hp_notch },
+        { "spectral gate 12 dB",              gate },
+        { "highpass + notches + gate",        all },
+    };
+    for (const auto & c : chains) {
+        audio_filter f(c.cfg, (float)k_sample_rate);
+        report_cost(c.label, cost_us_per_audio_s(signal, step, [&](const float * in, float * out, size_t n) {
+            f.process(in, out, n);
+        }));
+    }
+
+    std::vector<biquad_cascade::coeffs> sections = {
+        biquad_cascade::highpass(80.0f, 0.54119610f, (float)k_sample_rate),
+        biquad_cascade::highpass(80.0f, 1.30656296f, (float)k_sample_rate),
+    };
+    for (float hz : hp_notch.notch_hz) {
+        sections.push_back(biquad_cascade::notch(hz, 30.0f, (float)k_sample_rate));
+    }
+    scalar_cascade scalar(sections);
+    report_cost("  same 8 sections, scalar", cost_us_per_audio_s(signal, step, [&](const float * in, float * out, size_t n) {
+        scalar.process(in, out, n);
+    }));
+
+    audio_filter f(configured, (float)k_sample_rate);
+    const std::string label = "configured: " + describe_audio_filter(configured);
+    report_cost(label.c_str(), cost_us_per_audio_s(signal, step, [&](const float * in, float * out, size_t n) {
+        f.process(in, out, n);
+    }));
+    printf("\n");
+}
+
+// ---------------------------------------------------------------------------
+// Replay
+// ---------------------------------------------------------------------------
+
+struct replay_counts {
+    int steps    = 0;
+    int raw      = 0;
+    int filtered = 0;
+};
+
+static replay_counts replay(const recording & rec, size_t step, float vad_thold, bool use_vad,
+                            const audio_filter_config & cfg) {
+    std::vector<replay_step> steps = rec.steps;
+    if (steps.empty()) {
+        for (size_t off = 0; off + step <= rec.samples.size(); off += step) {
+            steps.push_back({ off, step });
+        }
+    }
+
+    replay_counts counts;
+    vad_gate raw_gate;
+    vad_gate filtered_gate;
+    audio_filter filter(cfg, (float)k_sample_rate);
+    std::vector<float> raw;
+    std::vector<float> filtered;
+    size_t filtered_to = 0;
+
+    for (const replay_step & s : steps) {
+        raw.assign(rec.samples.begin() + s.offset, rec.samples.begin() + s.offset + s.samples);
+
+        // The live filter only ever saw the recorded steps; restart it
+        // across a gap (dropped steps) like a fresh stream.
+        if (s.offset != filtered_to) {
+            filter.reset();
+        }
+        filter.process(raw, filtered);
+        filtered_to = s.offset + s.samples;
+
+        ++counts.steps;
+        counts.raw      += vad_runs_inference(raw_gate.judge(raw, vad_thold, use_vad).outcome);
+        counts.filtered += vad_runs_inference(filtered_gate.judge(filtered, vad_thold, use_vad).outcome);
+    }
+    return counts;
+}
+
+static void collect_inputs(const std::vector<std::string> & args, std::vector<std::string> & files) {
+    for (const std::string & a : args) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(a, ec)) {
+            std::vector<std::string> found;
+            for (const auto & e : std::filesystem::directory_iterator(a, ec)) {
+                if (e.path().extension() == ".wav") {
+                    found.push_back(e.path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(a);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+
+static bool parse_float(const char * name, const char * raw, float & out, float min_v, float max_v) {
+    char * end = nullptr;
+    const float v = strtof(raw, &end);
+    if (*raw == '\0' || *end != '\0' || !std::isfinite(v) || v < min_v || v > max_v) {
+        fprintf(stderr, "error: invalid value for %s: '%s'\n", name, raw);
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    float step_ms   = 1000.0f;
+    float vad_thold = 0.6f;
+    bool  use_vad   = true;
+    audio_filter_config cfg;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--step" && has_value) {
+            if (!parse_float("--step", argv[++i], step_ms, 10.0f, 60000.0f)) return 1;
+        } else if (arg == "--vad-thold" && has_value) {
+            if (!parse_float("--vad-thold", argv[++i], vad_thold, 0.0f, 1.0f)) return 1;
+        } else if (arg == "--no-vad") {
+            use_vad = false;
+        } else if (arg == "--highpass" && has_value) {
+            if (!parse_float("--highpass", argv[++i], cfg.highpass_hz, 0.0f, 1000.0f)) return 1;
+        } else if (arg == "--notch" && has_value) {
+            if (!parse_frequency_list(argv[++i], 20.0f, 4000.0f, cfg.notch_hz)) {
+                fprintf(stderr, "error: invalid value for --notch: '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--spectral-gate" && has_value) {
+            if (!parse_float("--spectral-gate", argv[++i], cfg.spectral_gate_db, 0.0f, 60.0f)) return 1;
+        } else if (arg == "-h" || arg == "--help") {
+            fprintf(stderr, "usage: %s [--step MS] [--vad-thold F] [--no-vad] [--highpass HZ] "
+                            "[--notch LIST] [--spectral-gate DB] [FILE.wav|DIR ...]\n", argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "error: unknown option or missing value: %s\n", arg.c_str());
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (!cfg.enabled()) {
+        cfg.highpass_hz = 80.0f;
+        cfg.notch_hz    = { 60.0f, 120.0f, 180.0f };
+    }
+
+    const size_t step = (size_t)(step_ms * k_sample_rate / 1000.0f);
+    const std::vector<float> synthetic = synthetic_minute();
+    run_cost(synthetic, step, cfg);
+
+    std::vector<recording> corpus;
+    std::vector<std::string> files;
+    collect_inputs(inputs, files);
+    for (const std::string & path : files) {
+        recording rec;
+        rec.name = std::filesystem::path(path).filename().string();
+        if (!read_wav(path, rec.samples)) continue;
+        read_sidecar(std::filesystem::path(path).replace_extension(".jsonl").string(), rec);
+        corpus.push_back(std::move(rec));
+    }
+    if (files.empty()) {
+        recording rec;
+        rec.name    = "(synthetic minute)";
+        rec.samples = synthetic;
+        corpus.push_back(std::move(rec));
+    }
+    if (corpus.empty()) {
+        fprintf(stderr, "error: no readable recordings\n");
+        return 1;
+    }
+
+    printf("replay: whisper_full calls, vad %s %.2f, filter %s\n",
+           use_vad ? "on" : "off", vad_thold, describe_audio_filter(cfg).c_str());
+    printf("  %-32s %7s %7s %7s %9s %8s\n", "recording", "steps", "live", "raw", "filtered", "saved");
+
+    replay_counts total;
+    for (const recording & rec : corpus) {
+        const replay_counts c = replay(rec, step, vad_thold, use_vad, cfg);
+        char live[16] = "-";
+        if (rec.live_calls >= 0) {
+            snprintf(live, sizeof(live), "%d", rec.live_calls);
+        }
+        printf("  %-32s %7d %7s %7d %9d %7.1f%%\n", rec.name.c_str(), c.steps, live, c.raw, c.filtered,
+               c.raw > 0 ? 100.0 * (c.raw - c.filtered) / c.raw : 0.0);
+        total.steps    += c.steps;
+        total.raw      += c.raw;
+        total.filtered += c.filtered;
+    }
+    if (corpus.size() > 1) {
+        printf("  %-32s %7d %7s %7d %9d %7.1f%%\n", "total", total.steps, "", total.raw, total.filtered,
+               total.raw > 0 ? 100.0 * (total.raw - total.filtered) / total.raw : 0.0);
+    }
+    return 0;
+}
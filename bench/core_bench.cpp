@@ -0,0 +1,165 @@
+// Pipeline component microbenchmark
+//
+//   core-bench [--iters N]
+//
+// Times the per-segment hot helpers of live-subtitle-core on multilingual
+// inputs (Korean, Japanese, English, emoji, and decoder-loop repetitions)
+// and reports ns per call and throughput. Each case runs --iters times
+// (default 20000) and the best of five rounds is reported.
+
+#include "json.h"
+#include "text_filter.h"
+#include "util.h"
+#include "vad_gate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Inputs
+// ---------------------------------------------------------------------------
+
+struct text_case {
+    const char * name;
+    std::string  text;
+};
+
+static std::vector<text_case> make_text_cases() {
+    std::vector<text_case> cases = {
+        { "en",    "So the next thing we want to look at is how the model handles long, \"quoted\" phrases." },
+        { "ko",    "오늘 회의에서는 다음 분기 계획과 \"실시간 자막\" 기능의 지연 시간을 중점적으로 논의하겠습니다." },
+        { "ja",    "それでは次のスライドに進みます。「リアルタイム字幕」の遅延について説明します。" },
+        { "emoji", "Great job everyone 🎉👏 let's ship it 🚀\tnext week\\today 😄" },
+        { "mixed", "Whisper 모델은 日本語 and English를 함께 처리할 수 있습니다 (v3, 16 kHz)." },
+    };
+
+    // Long paragraph as produced by a 10 s window.
+    std::string para;
+    for (int i = 0; i < 8; ++i) para += cases[(size_t)i % cases.size()].text + " ";
+    cases.push_back({ "para", para });
+    return cases;
+}
+
+struct repeat_case {
+    const char * name;
+    std::string  text;
+    std::string  prev;
+};
+
+static std::vector<repeat_case> make_repeat_cases() {
+    std::string loop_en, loop_ko, loop_ja;
+    for (int i = 0; i < 24; ++i) loop_en += "thank you ";
+    for (int i = 0; i < 24; ++i) loop_ko += "감사합니다 ";
+    for (int i = 0; i < 24; ++i) loop_ja += "ありがとう ";
+
+    return {
+        { "en ok",   "So the next thing we want to look at is how the model handles long phrases.",
+                     "Okay, let's get started." },
+        { "ko ok",   "오늘 회의에서는 다음 분기 계획과 실시간 자막 기능을 논의하겠습니다.",
+                     "안녕하세요 여러분." },
+        { "en loop", loop_en, "thank you" },
+        { "ko loop", loop_ko, "감사합니다" },
+        { "ja loop", loop_ja, "ありがとう" },
+        { "extend",  "오늘 회의에서는 네 네 네 네 네 네 네 네", "오늘 회의에서는" },
+    };
+}
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+
+// Keeps results observable so the calls are not optimized away.
+static volatile size_t g_sink = 0;
+
+template <typename Fn>
+static double best_ns_per_call(int iters, Fn && fn) {
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; ++i) {
+            fn();
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / iters);
+    }
+    return best;
+}
+
+static void report(const char * group, const char * name, size_t bytes, double ns) {
+    const double mb_s = bytes > 0 ? (double)bytes / ns * 1e3 : 0.0;
+    printf("  %-28s %-8s %6zu B %10.1f ns %9.1f MB/s\n", group, name, bytes, ns, mb_s);
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char ** argv) {
+    int iters = 20000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iters") == 0 && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+            if (iters <= 0) {
+                fprintf(stderr, "--iters must be positive\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [--iters N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const auto texts   = make_text_cases();
+    const auto repeats = make_repeat_cases();
+
+    printf("core-bench: %d iterations, best of 5\n\n", iters);
+    printf("  %-28s %-8s %8s %13s %14s\n", "function", "input", "size", "per call", "throughput");
+
+    for (const auto & c : texts) {
+        const double ns = best_ns_per_call(iters, [&] { g_sink += escape_json(c.text).size(); });
+        report("escape_json", c.name, c.text.size(), ns);
+    }
+
+    for (const auto & c : texts) {
+        const std::string token = "\"" + escape_json(c.text) + "\"";
+        std::string out;
+        const double ns = best_ns_per_call(iters, [&] {
+            size_t pos = 0;
+            g_sink += parse_json_string_token(token, pos, out) ? out.size() : 0;
+        });
+        report("parse_json_string_token", c.name, token.size(), ns);
+    }
+
+    for (const auto & c : texts) {
+        const double ns = best_ns_per_call(iters, [&] { g_sink += normalize_for_dedup(c.text).size(); });
+        report("normalize_for_dedup", c.name, c.text.size(), ns);
+    }
+
+    for (const auto & c : repeats) {
+        std::string reason;
+        const double ns = best_ns_per_call(iters, [&] {
+            g_sink += should_drop_repetitive_text(c.text, c.prev, reason) ? 1 : 0;
+        });
+        report("should_drop_repetitive_text", c.name, c.text.size(), ns);
+    }
+
+    // One --step of audio at the default 1000 ms, at 500 ms and at 3000 ms.
+    for (const int step_ms : { 500, 1000, 3000 }) {
+        std::vector<float> samples((size_t)step_ms * k_sample_rate / 1000);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = 0.1f * sinf(0.07f * (float)i) + 0.01f * (float)((i * 2654435761u) % 1000) / 1000.0f;
+        }
+        char name[16];
+        snprintf(name, sizeof(name), "%d ms", step_ms);
+        const double ns = best_ns_per_call(iters, [&] { g_sink += (size_t)average_abs_energy(samples); });
+        report("average_abs_energy", name, samples.size() * sizeof(float), ns);
+    }
+
+    return 0;
+}
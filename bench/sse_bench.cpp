@@ -0,0 +1,651 @@
+// SSE fan-out load test against an in-process /events server
+//
+//   sse-bench [--clients N] [--slow N] [--slow-rate BYTES] [--rate HZ]
+//             [--duration S] [--text-bytes N] [--readers N] [--mode full|delta]
+//
+// Forks a server process that serves /events the way live-subtitle does
+// (handoff_server + sse_broadcaster) and publishes synthetic subtitle
+// frames at --rate. The bench then opens --clients connections that read
+// as fast as they can and --slow connections that read at most --slow-rate
+// bytes per second (0 = never). The server runs in its own process so its
+// CPU time and RSS are its own.
+//
+// Reports publish -> receive latency over every frame every fast client
+// received, publish -> last client per frame, frames skipped (superseded
+// before the broadcaster got to a client), server CPU per frame per
+// connection, server RSS per connection, and how many connections the
+// broadcaster dropped for exceeding its backlog limit. Latencies include
+// the bench's own reader threads; raise --readers if they are saturated.
+// Runs entirely on localhost.
+
+#include "handoff_server.h"
+#include "model_file.h"
+#include "sse_broadcaster.h"
+#include "subtitle_events.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using bench_clock = std::chrono::steady_clock;
+
+// steady_clock is system-wide (CLOCK_MONOTONIC / mach_absolute_time), so
+// the two processes' readings compare directly.
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        bench_clock::now().time_since_epoch()).count();
+}
+
+struct bench_config {
+    int      clients    = 1000;
+    int      slow       = 0;
+    int      slow_rate  = 0;     // bytes per second per slow reader
+    int      rate       = 10;    // frames per second
+    int      duration_s = 10;
+    int      text_bytes = 120;
+    int      readers    = 4;
+    sse_mode mode       = sse_mode::full;
+};
+
+// ---------------------------------------------------------------------------
+// State shared with the server process
+// ---------------------------------------------------------------------------
+
+constexpr size_t k_publish_slots = 1 << 16;
+
+static_assert(std::atomic<int64_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared_state needs address-free atomics");
+
+enum class server_command : int {
+    idle = 0,
+    publish,
+    stop,
+};
+
+// Lives in a MAP_SHARED anonymous mapping created before fork().
+struct shared_state {
+    std::atomic<int>      command{(int)server_command::idle};
+    std::atomic<int>      port{0};            // -1: the server failed to start
+    std::atomic<uint64_t> published{0};
+    std::atomic<int64_t>  cpu_us{0};          // server user + system time
+    std::atomic<int64_t>  rss_bytes{-1};
+    std::atomic<uint64_t> clients{0};
+    std::atomic<uint64_t> dropped{0};         // sse_broadcaster::dropped_count()
+
+    // Publish time of frame v in slots[v % k_publish_slots].
+    struct slot {
+        std::atomic<uint64_t> version{0};
+        std::atomic<int64_t>  ns{0};
+    };
+    slot slots[k_publish_slots];
+};
+
+static bool publish_time_ns(const shared_state & shared, uint64_t version, int64_t & ns) {
+    const shared_state::slot & s = shared.slots[version % k_publish_slots];
+    if (s.version.load(std::memory_order_acquire) != version) return false;
+    ns = s.ns.load(std::memory_order_relaxed);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Server process
+// ---------------------------------------------------------------------------
+
+// A subtitle-sized line whose ending changes every frame, like a window
+// that recognized one more word.
+static std::string make_text(uint64_t version, int bytes) {
+    static const char k_sentence[] = "오늘 회의에서는 실시간 자막의 지연 시간을 중점적으로 논의하겠습니다 ";
+    const std::string tag = " #" + std::to_string(version);
+    std::string text;
+    while ((int)(text.size() + tag.size()) < bytes) text += k_sentence;
+    size_t cut = (size_t)std::max(0, bytes - (int)tag.size());
+    if (cut < text.size()) {
+        while (cut > 0 && ((unsigned char)text[cut] & 0xC0) == 0x80) --cut;
+        text.resize(cut);
+    }
+    return text + tag;
+}
+
+static int64_t cpu_time_us() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return (int64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+           (int64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+static int run_server(shared_state & shared, const bench_config & cfg) {
+    sse_broadcaster broadcaster;
+    handoff_server  svr;
+
+    // Same route as live-subtitle's /events.
+    svr.Get("/events", [&broadcaster](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("Access-Control-Allow-Origin", "*");
+
+        const sse_mode mode = req.get_param_value("mode") == "delta" ? sse_mode::delta : sse_mode::full;
+
+        res.set_chunked_content_provider("text/event-stream",
+            [&broadcaster, mode](size_t /*offset*/, httplib::DataSink & /*sink*/) {
+                broadcaster.add_client(handoff_server::take_current_socket(), mode);
+                return false;
+            }
+        );
+    });
+
+    const int port = broadcaster.start() ? svr.bind_to_any_port("127.0.0.1") : -1;
+    if (port <= 0) {
+        shared.port.store(-1);
+        broadcaster.stop();
+        return 1;
+    }
+    std::thread server_thread([&svr] { svr.listen_after_bind(); });
+    svr.wait_until_ready();
+    shared.port.store(port);
+
+    const auto interval = std::chrono::nanoseconds((int64_t)(1e9 / cfg.rate));
+    const auto stats_interval = std::chrono::milliseconds(50);
+    bench_clock::time_point next_frame = bench_clock::now();
+    bench_clock::time_point next_stats = bench_clock::now();
+    uint64_t version = 0;
+
+    while (true) {
+        const server_command cmd = (server_command)shared.command.load();
+        if (cmd == server_command::stop) break;
+
+        bench_clock::time_point now = bench_clock::now();
+        if (cmd != server_command::publish) {
+            next_frame = now;
+        } else if (now >= next_frame) {
+            subtitle_frame frame;
+            frame.version  = ++version;
+            frame.text     = make_text(version, cfg.text_bytes);
+            frame.language = "ko";
+            const int64_t ms = unix_time_ms();
+            frame.timing.capture_ms = frame.timing.infer_start_ms = frame.timing.infer_end_ms =
+                frame.timing.translated_ms = frame.timing.publish_ms = ms;
+
+            shared_state::slot & s = shared.slots[version % k_publish_slots];
+            s.ns.store(now_ns(), std::memory_order_relaxed);
+            s.version.store(version, std::memory_order_release);
+            broadcaster.publish(std::move(frame));
+            shared.published.store(version);
+
+            // A late frame does not make the next ones burst.
+            next_frame += interval;
+            if (next_frame < now) next_frame = now + interval;
+        }
+
+        if (now >= next_stats) {
+            shared.cpu_us.store(cpu_time_us());
+            shared.rss_bytes.store(current_rss_bytes());
+            shared.clients.store(broadcaster.client_count());
+            shared.dropped.store(broadcaster.dropped_count());
+            next_stats = now + stats_interval;
+        }
+
+        now = bench_clock::now();
+        const bench_clock::time_point wake =
+            cmd == server_command::publish ? std::min(next_frame, next_stats) : next_stats;
+        if (wake > now) std::this_thread::sleep_until(wake);
+    }
+
+    svr.stop();
+    server_thread.join();
+    broadcaster.stop();
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Clients
+// ---------------------------------------------------------------------------
+
+// Connects, sends the GET and reads the response headers (blocking), then
+// leaves the socket non-blocking. Bytes read past the headers go to `rest`.
+static int open_events(int port, sse_mode mode, int rcvbuf, std::string & rest) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    timeval tv{};
+    tv.tv_sec = 10;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    const std::string request = std::string("GET /events") + (mode == sse_mode::delta ? "?mode=delta" : "") +
+                                " HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: text/event-stream\r\n\r\n";
+    size_t sent = 0;
+    while (sent < request.size()) {
+        const ssize_t n = send(fd, request.data() + sent, request.size() - sent, 0);
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+
+    std::string head;
+    size_t end = std::string::npos;
+    char buf[1024];
+    while (end == std::string::npos) {
+        const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0 || head.size() > 16384) {
+            close(fd);
+            return -1;
+        }
+        head.append(buf, (size_t)n);
+        end = head.find("\r\n\r\n");
+    }
+    if (head.compare(0, 12, "HTTP/1.1 200") != 0) {
+        close(fd);
+        return -1;
+    }
+    rest = head.substr(end + 4);
+
+    const int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    return fd;
+}
+
+struct connection {
+    int         fd     = -1;
+    bool        closed = false;   // EOF or error before the bench ended
+    std::string buf;              // incomplete line
+    uint64_t    last_version = 0;
+};
+
+struct reader_result {
+    std::vector<double> connect_ms;
+    std::vector<double> latency_ms;
+    std::vector<int64_t> first_ns;   // per version, 0 = not received
+    std::vector<int64_t> last_ns;
+    uint64_t frames   = 0;
+    uint64_t skipped  = 0;
+    uint64_t failed   = 0;           // connections that could not be opened
+    uint64_t closed   = 0;
+    uint64_t bytes    = 0;
+};
+
+static std::atomic<bool> g_readers_stop{false};
+static std::atomic<int>  g_readers_ready{0};
+
+// Consumes the complete lines in c.buf; "data: {"v":N,..." is one frame.
+static void consume_lines(connection & c, const shared_state & shared, int64_t recv_ns, reader_result & out) {
+    static const char k_prefix[] = "data: {\"v\":";
+    size_t pos = 0;
+    for (size_t nl; (nl = c.buf.find('\n', pos)) != std::string::npos; pos = nl + 1) {
+        if (c.buf.compare(pos, sizeof(k_prefix) - 1, k_prefix) != 0) continue;
+        const uint64_t v = std::strtoull(c.buf.c_str() + pos + sizeof(k_prefix) - 1, nullptr, 10);
+        if (v == 0) continue;
+
+        ++out.frames;
+        if (c.last_version > 0 && v > c.last_version + 1) out.skipped += v - c.last_version - 1;
+        c.last_version = std::max(c.last_version, v);
+
+        int64_t published_ns = 0;
+        if (publish_time_ns(shared, v, published_ns)) {
+            out.latency_ms.push_back((double)(recv_ns - published_ns) / 1e6);
+        }
+        if (v >= out.first_ns.size()) {
+            out.first_ns.resize((size_t)v * 2, 0);
+            out.last_ns.resize((size_t)v * 2, 0);
+        }
+        if (out.first_ns[v] == 0) out.first_ns[v] = recv_ns;
+        out.last_ns[v] = recv_ns;
+    }
+    c.buf.erase(0, pos);
+}
+
+static void run_fast_reader(int port, sse_mode mode, int n_connections, const shared_state & shared,
+                            reader_result & out) {
+    std::vector<connection> conns;
+    conns.reserve((size_t)n_connections);
+    for (int i = 0; i < n_connections; ++i) {
+        connection c;
+        const bench_clock::time_point t0 = bench_clock::now();
+        c.fd = open_events(port, mode, 0, c.buf);
+        if (c.fd < 0) {
+            ++out.failed;
+            continue;
+        }
+        out.connect_ms.push_back(std::chrono::duration<double, std::milli>(bench_clock::now() - t0).count());
+        conns.push_back(std::move(c));
+    }
+
+    event_poller poller;
+    std::unordered_map<int, size_t> by_fd;
+    for (size_t i = 0; i < conns.size(); ++i) {
+        poller.add(conns[i].fd, false);
+        by_fd[conns[i].fd] = i;
+    }
+    g_readers_ready.fetch_add(1);
+
+    std::vector<event_poller::event> events;
+    char buf[65536];
+    while (!g_readers_stop.load()) {
+        const int n = poller.wait(events, 50);
+        for (int e = 0; e < n; ++e) {
+            auto it = by_fd.find(events[(size_t)e].fd);
+            if (it == by_fd.end()) continue;
+            connection & c = conns[it->second];
+            while (true) {
+                const ssize_t r = recv(c.fd, buf, sizeof(buf), 0);
+                if (r > 0) {
+                    const int64_t recv_ns = now_ns();
+                    out.bytes += (uint64_t)r;
+                    c.buf.append(buf, (size_t)r);
+                    consume_lines(c, shared, recv_ns, out);
+                    continue;
+                }
+                if (r < 0 && errno == EINTR) continue;
+                if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                c.closed = true;
+                ++out.closed;
+                poller.remove(c.fd);
+                by_fd.erase(it);
+                break;
+            }
+        }
+    }
+    for (connection & c : conns) close(c.fd);
+}
+
+// Slow readers: a small receive buffer, read at most `rate` bytes per
+// second each (0 = never), so the server's per-client backlog grows.
+static void run_slow_reader(int port, sse_mode mode, int n_connections, int rate, reader_result & out) {
+    constexpr int k_slow_rcvbuf = 4096;
+    constexpr int k_tick_ms     = 100;
+
+    std::vector<connection> conns;
+    for (int i = 0; i < n_connections; ++i) {
+        connection c;
+        c.fd = open_events(port, mode, k_slow_rcvbuf, c.buf);
+        if (c.fd < 0) {
+            ++out.failed;
+            continue;
+        }
+        conns.push_back(std::move(c));
+    }
+    g_readers_ready.fetch_add(1);
+
+    const size_t budget = (size_t)rate * k_tick_ms / 1000;
+    std::vector<char> buf(std::max<size_t>(budget, 1));
+    while (!g_readers_stop.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(k_tick_ms));
+        if (budget == 0) continue;
+        // A dropped client still has its receive buffer to drain before
+        // EOF, so drops are counted on the server side.
+        for (connection & c : conns) {
+            const ssize_t r = recv(c.fd, buf.data(), budget, 0);
+            if (r > 0) out.bytes += (uint64_t)r;
+        }
+    }
+    for (connection & c : conns) close(c.fd);
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+// ---------------------------------------------------------------------------
+
+// `v` sorted ascending.
+static double percentile(const std::vector<double> & v, double p) {
+    if (v.empty()) return 0.0;
+    const size_t idx = std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5));
+    return v[idx];
+}
+
+static void report_latency(const char * name, std::vector<double> & v) {
+    std::sort(v.begin(), v.end());
+    printf("  %-22s %9zu %9.2f %9.2f %9.2f %9.2f\n", name, v.size(),
+           percentile(v, 0.50), percentile(v, 0.90), percentile(v, 0.99), v.empty() ? 0.0 : v.back());
+}
+
+// Each side holds one fd per connection plus its own few.
+static bool raise_fd_limit(rlim_t needed) {
+    rlimit rl{};
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0) return false;
+    if (rl.rlim_cur >= needed) return true;
+    rl.rlim_cur = rl.rlim_max == RLIM_INFINITY ? needed : std::min(needed, rl.rlim_max);
+    return setrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur >= needed;
+}
+
+struct server_snapshot {
+    int64_t  cpu_us    = 0;
+    int64_t  rss_bytes = -1;
+    uint64_t clients   = 0;
+    uint64_t dropped   = 0;
+};
+
+// Waits for the server's next stats update so the values are current.
+static server_snapshot snapshot(const shared_state & shared) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    server_snapshot s;
+    s.cpu_us    = shared.cpu_us.load();
+    s.rss_bytes = shared.rss_bytes.load();
+    s.clients   = shared.clients.load();
+    s.dropped   = shared.dropped.load();
+    return s;
+}
+
+int main(int argc, char ** argv) {
+    bench_config cfg;
+
+    auto usage = [&] {
+        fprintf(stderr,
+                "usage: %s [--clients N] [--slow N] [--slow-rate BYTES] [--rate HZ] [--duration S]\n"
+                "          [--text-bytes N] [--readers N] [--mode full|delta]\n",
+                argv[0]);
+    };
+    auto int_arg = [&](int & i, int min_v, int max_v, int & out) {
+        if (i + 1 >= argc) return false;
+        char * end = nullptr;
+        const long v = std::strtol(argv[++i], &end, 10);
+        if (*end != '\0' || v < min_v || v > max_v) return false;
+        out = (int)v;
+        return true;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--clients") {
+            ok = int_arg(i, 0, 1000000, cfg.clients);
+        } else if (arg == "--slow") {
+            ok = int_arg(i, 0, 1000000, cfg.slow);
+        } else if (arg == "--slow-rate") {
+            ok = int_arg(i, 0, 100000000, cfg.slow_rate);
+        } else if (arg == "--rate") {
+            ok = int_arg(i, 1, 10000, cfg.rate);
+        } else if (arg == "--duration") {
+            ok = int_arg(i, 1, 86400, cfg.duration_s);
+        } else if (arg == "--text-bytes") {
+            ok = int_arg(i, 16, 1000000, cfg.text_bytes);
+        } else if (arg == "--readers") {
+            ok = int_arg(i, 1, 256, cfg.readers);
+        } else if (arg == "--mode") {
+            const std::string m = i + 1 < argc ? argv[++i] : "";
+            ok = m == "full" || m == "delta";
+            cfg.mode = m == "delta" ? sse_mode::delta : sse_mode::full;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+    if (cfg.clients + cfg.slow == 0) {
+        fprintf(stderr, "error: --clients + --slow must be at least 1\n");
+        return 1;
+    }
+
+    const rlim_t needed = (rlim_t)(cfg.clients + cfg.slow) + 64;
+    if (!raise_fd_limit(needed)) {
+        fprintf(stderr, "error: need %llu open files per process, raise the limit (ulimit -n)\n",
+                (unsigned long long)needed);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    void * mem = mmap(nullptr, sizeof(shared_state), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    if (mem == MAP_FAILED) {
+        fprintf(stderr, "error: mmap: %s\n", strerror(errno));
+        return 1;
+    }
+    shared_state & shared = *new (mem) shared_state();
+
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "error: fork: %s\n", strerror(errno));
+        return 1;
+    }
+    if (pid == 0) {
+        _exit(run_server(shared, cfg));
+    }
+
+    while (shared.port.load() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const int port = shared.port.load();
+    if (port < 0) {
+        fprintf(stderr, "error: the server could not start on 127.0.0.1\n");
+        waitpid(pid, nullptr, 0);
+        return 1;
+    }
+
+    printf("sse-bench: %d clients + %d slow (%d B/s), %d readers, %d frames/s x %d B text, %d s, mode %s\n",
+           cfg.clients, cfg.slow, cfg.slow_rate, cfg.readers, cfg.rate, cfg.text_bytes, cfg.duration_s,
+           cfg.mode == sse_mode::delta ? "delta" : "full");
+    printf("server: http://127.0.0.1:%d/events (pid %d)\n\n", port, (int)pid);
+
+    const server_snapshot idle = snapshot(shared);
+
+    // ── Connect ──────────────────────────────────────────────────────────
+
+    const int n_readers = std::min(cfg.readers, std::max(1, cfg.clients));
+    std::vector<reader_result> fast((size_t)n_readers);
+    reader_result slow;
+    std::vector<std::thread> threads;
+    const bench_clock::time_point connect_start = bench_clock::now();
+    for (int r = 0; r < n_readers; ++r) {
+        const int share = cfg.clients / n_readers + (r < cfg.clients % n_readers ? 1 : 0);
+        threads.emplace_back(run_fast_reader, port, cfg.mode, share, std::cref(shared), std::ref(fast[(size_t)r]));
+    }
+    const int n_threads = n_readers + (cfg.slow > 0 ? 1 : 0);
+    if (cfg.slow > 0) {
+        threads.emplace_back(run_slow_reader, port, cfg.mode, cfg.slow, cfg.slow_rate, std::ref(slow));
+    }
+    while (g_readers_ready.load() < n_threads) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const double connect_s = std::chrono::duration<double>(bench_clock::now() - connect_start).count();
+
+    uint64_t failed = slow.failed;
+    for (const auto & f : fast) failed += f.failed;
+    const uint64_t connected = (uint64_t)(cfg.clients + cfg.slow) - failed;
+
+    // The broadcaster picks up handed-off sockets on its next wakeup.
+    for (int i = 0; i < 100 && shared.clients.load() < connected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    const server_snapshot loaded = snapshot(shared);
+
+    // ── Publish ──────────────────────────────────────────────────────────
+
+    shared.command.store((int)server_command::publish);
+    std::this_thread::sleep_for(std::chrono::seconds(cfg.duration_s));
+    shared.command.store((int)server_command::idle);
+    const uint64_t published = shared.published.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));   // frames still in flight
+    const server_snapshot done = snapshot(shared);
+
+    g_readers_stop = true;
+    for (auto & t : threads) t.join();
+    shared.command.store((int)server_command::stop);
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    // ── Report ───────────────────────────────────────────────────────────
+
+    reader_result all;
+    for (auto & f : fast) {
+        all.connect_ms.insert(all.connect_ms.end(), f.connect_ms.begin(), f.connect_ms.end());
+        all.latency_ms.insert(all.latency_ms.end(), f.latency_ms.begin(), f.latency_ms.end());
+        all.frames  += f.frames;
+        all.skipped += f.skipped;
+        all.closed  += f.closed;
+        all.bytes   += f.bytes;
+    }
+    // Per frame: when the last fast client had it.
+    std::vector<double> last_client_ms;
+    for (uint64_t v = 1; v <= published; ++v) {
+        int64_t last = 0;
+        for (const auto & f : fast) {
+            if (v < f.last_ns.size()) last = std::max(last, f.last_ns[v]);
+        }
+        int64_t published_ns = 0;
+        if (last > 0 && publish_time_ns(shared, v, published_ns)) {
+            last_client_ms.push_back((double)(last - published_ns) / 1e6);
+        }
+    }
+
+    const uint64_t fast_connected = connected - (uint64_t)(cfg.slow - (int)slow.failed);
+    const double publish_s = (double)cfg.duration_s;
+    const double cpu_s = (double)(done.cpu_us - loaded.cpu_us) / 1e6;
+
+    printf("  connect                %llu connections in %.2f s (%llu failed)\n",
+           (unsigned long long)connected, connect_s, (unsigned long long)failed);
+    if (loaded.rss_bytes >= 0 && idle.rss_bytes >= 0 && connected > 0) {
+        printf("  server rss             %s idle, %s connected (%.1f KB per connection)\n",
+               format_bytes(idle.rss_bytes).c_str(), format_bytes(loaded.rss_bytes).c_str(),
+               (double)(loaded.rss_bytes - idle.rss_bytes) / 1024.0 / (double)connected);
+    }
+    printf("  server cpu             %.2f s over %.0f s publishing (%.1f%% of a core", cpu_s, publish_s,
+           cpu_s * 100.0 / publish_s);
+    if (published > 0 && loaded.clients > 0) {
+        printf(", %.2f us per frame per connection", cpu_s * 1e6 / (double)published / (double)loaded.clients);
+    }
+    printf(")\n");
+    printf("  frames                 %llu published, %llu received by %llu fast clients (%.1f%%), %llu skipped\n",
+           (unsigned long long)published, (unsigned long long)all.frames, (unsigned long long)fast_connected,
+           published * fast_connected > 0 ? all.frames * 100.0 / (double)(published * fast_connected) : 0.0,
+           (unsigned long long)all.skipped);
+    printf("  throughput             %.1f MB/s to fast clients\n", (double)all.bytes / publish_s / (1 << 20));
+    printf("  disconnected           %llu by the backlog limit, %llu fast clients closed\n\n",
+           (unsigned long long)(done.dropped - idle.dropped), (unsigned long long)all.closed);
+
+    printf("  %-22s %9s %9s %9s %9s %9s\n", "latency (ms)", "count", "p50", "p90", "p99", "max");
+    report_latency("connect", all.connect_ms);
+    report_latency("publish -> receive", all.latency_ms);
+    report_latency("publish -> last client", last_client_ms);
+
+    munmap(mem, sizeof(shared_state));
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : 1;
+}
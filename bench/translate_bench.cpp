@@ -0,0 +1,459 @@
+// Translation path load test against an in-process fake LibreTranslate
+//
+//   translate-bench [--streams N] [--segments N] [--step MS] [--infer MS]
+//                   [--latency DIST] [--error-rate F] [--timeout-rate F]
+//                   [--read-timeout MS] [--seed N]
+//
+// Starts a fake LibreTranslate (/translate, /languages) on 127.0.0.1 and
+// drives it through the same `translator` the main loop uses. Each stream
+// plays one live session: every --step a window is "recognized" (--infer
+// ms of simulated inference) and translated, with the text growing word by
+// word through an utterance and repeating while the window still covers it,
+// as consecutive whisper steps do. Like the main loop, a stream is serial,
+// so a slow translation delays the steps queued behind it.
+//
+// DIST is fixed:MS, uniform:MIN:MAX, lognormal:MEDIAN:SIGMA or
+// bimodal:FAST:SLOW:P_SLOW (all in ms). A timed-out request is held by the
+// fake server until after the client's --read-timeout.
+//
+// Reports end-to-end step latency (window ready -> translation done),
+// translation request latency, translator QPS and the 1-entry cache's hit
+// rate. Runs entirely on localhost.
+
+#include "json.h"
+#include "translator.h"
+
+#include "httplib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double ms_since(bench_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - t0).count();
+}
+
+// ---------------------------------------------------------------------------
+// Latency distributions
+// ---------------------------------------------------------------------------
+
+struct latency_dist {
+    enum class kind { fixed, uniform, lognormal, bimodal };
+
+    kind   type = kind::lognormal;
+    double a    = 40.0;
+    double b    = 0.5;
+    double c    = 0.0;
+    std::string spec = "lognormal:40:0.5";
+
+    double sample(std::mt19937_64 & rng) const {
+        switch (type) {
+            case kind::fixed:
+                return a;
+            case kind::uniform:
+                return std::uniform_real_distribution<double>(a, b)(rng);
+            case kind::lognormal:
+                return std::lognormal_distribution<double>(std::log(a), b)(rng);
+            case kind::bimodal:
+                return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < c ? b : a;
+        }
+        return a;
+    }
+};
+
+static bool parse_latency_dist(const std::string & spec, latency_dist & out) {
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    for (std::string part; std::getline(ss, part, ':');) parts.push_back(part);
+    if (parts.empty()) return false;
+
+    std::vector<double> v;
+    for (size_t i = 1; i < parts.size(); ++i) {
+        char * end = nullptr;
+        const double x = std::strtod(parts[i].c_str(), &end);
+        if (end == parts[i].c_str() || *end != '\0' || x < 0.0) return false;
+        v.push_back(x);
+    }
+
+    latency_dist d;
+    d.spec = spec;
+    if (parts[0] == "fixed" && v.size() == 1) {
+        d.type = latency_dist::kind::fixed;
+        d.a = v[0];
+    } else if (parts[0] == "uniform" && v.size() == 2 && v[0] <= v[1]) {
+        d.type = latency_dist::kind::uniform;
+        d.a = v[0];
+        d.b = v[1];
+    } else if (parts[0] == "lognormal" && v.size() == 2 && v[0] > 0.0) {
+        d.type = latency_dist::kind::lognormal;
+        d.a = v[0];
+        d.b = v[1];
+    } else if (parts[0] == "bimodal" && v.size() == 3 && v[2] <= 1.0) {
+        d.type = latency_dist::kind::bimodal;
+        d.a = v[0];
+        d.b = v[1];
+        d.c = v[2];
+    } else {
+        return false;
+    }
+    out = d;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Fake LibreTranslate
+// ---------------------------------------------------------------------------
+
+struct fake_config {
+    latency_dist latency;
+    double       error_rate      = 0.02;
+    double       timeout_rate    = 0.005;
+    int          read_timeout_ms = 1000;
+    uint64_t     seed            = 1;
+};
+
+class fake_translator {
+public:
+    explicit fake_translator(const fake_config & cfg) : cfg_(cfg), rng_(cfg.seed) {
+        svr_.Post("/translate", [this](const httplib::Request & req, httplib::Response & res) {
+            handle_translate(req, res);
+        });
+        svr_.Get("/languages", [](const httplib::Request &, httplib::Response & res) {
+            res.set_content(
+                "[{\"code\":\"en\",\"name\":\"English\",\"targets\":[\"ja\",\"ko\",\"zh\"]},"
+                "{\"code\":\"ja\",\"name\":\"Japanese\",\"targets\":[\"en\",\"ko\",\"zh\"]},"
+                "{\"code\":\"ko\",\"name\":\"Korean\",\"targets\":[\"en\",\"ja\",\"zh\"]},"
+                "{\"code\":\"zh\",\"name\":\"Chinese\",\"targets\":[\"en\",\"ja\",\"ko\"]}]",
+                "application/json");
+        });
+    }
+
+    bool start() {
+        port_ = svr_.bind_to_any_port("127.0.0.1");
+        if (port_ <= 0) return false;
+        thread_ = std::thread([this] { svr_.listen_after_bind(); });
+        svr_.wait_until_ready();
+        return true;
+    }
+
+    void stop() {
+        svr_.stop();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    uint64_t requests() const { return requests_.load(); }
+    uint64_t errors()   const { return errors_.load(); }
+    uint64_t timeouts() const { return timeouts_.load(); }
+
+private:
+    enum class outcome { ok, error, timeout };
+
+    void handle_translate(const httplib::Request & req, httplib::Response & res) {
+        requests_.fetch_add(1);
+
+        std::string q, target;
+        if (!json_get_string_field(req.body, "q", q) || !json_get_string_field(req.body, "target", target)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid request\"}", "application/json");
+            return;
+        }
+
+        outcome result = outcome::ok;
+        double delay_ms = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(rng_mtx_);
+            const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+            if (roll < cfg_.timeout_rate) {
+                result = outcome::timeout;
+            } else if (roll < cfg_.timeout_rate + cfg_.error_rate) {
+                result = outcome::error;
+            }
+            delay_ms = cfg_.latency.sample(rng_);
+        }
+        if (result == outcome::timeout) {
+            timeouts_.fetch_add(1);
+            delay_ms = cfg_.read_timeout_ms + 200.0;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(delay_ms * 1000.0)));
+
+        if (result == outcome::error) {
+            errors_.fetch_add(1);
+            res.status = 500;
+            res.set_content("{\"error\":\"Translation failed\"}", "application/json");
+            return;
+        }
+        res.set_content("{" + json_str("translatedText", "[" + target + "] " + q) + "}", "application/json");
+    }
+
+    const fake_config cfg_;
+    httplib::Server   svr_;
+    std::thread       thread_;
+    int               port_ = -1;
+
+    std::mutex      rng_mtx_;
+    std::mt19937_64 rng_;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> timeouts_{0};
+};
+
+// ---------------------------------------------------------------------------
+// Segment streams
+// ---------------------------------------------------------------------------
+
+struct utterance {
+    const char * lang;
+    const char * target;
+    const char * text;
+};
+
+static const utterance k_utterances[] = {
+    { "ko", "en", "오늘 회의에서는 다음 분기 계획과 실시간 자막 기능의 지연 시간을 중점적으로 논의하겠습니다" },
+    { "ko", "en", "먼저 지난주에 배포한 버전에서 발견된 문제부터 살펴보겠습니다" },
+    { "ko", "en", "번역 서버가 느려지면 자막이 늦게 표시되는 문제가 있었습니다" },
+    { "en", "ko", "So the next thing we want to look at is how the model handles long quoted phrases" },
+    { "en", "ko", "If the translator stalls every viewer sees the subtitle late" },
+    { "ja", "ko", "それでは 次の スライドに 進みます リアルタイム 字幕の 遅延について 説明します" },
+};
+
+// The texts one stream's steps recognize, in order.
+static std::vector<const utterance *> make_stream(int segments, std::mt19937_64 & rng,
+                                                  std::vector<std::string> & texts) {
+    std::vector<const utterance *> langs;
+    std::uniform_int_distribution<size_t> pick(0, sizeof(k_utterances) / sizeof(k_utterances[0]) - 1);
+    std::uniform_int_distribution<int> grow(1, 3);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    while ((int)texts.size() < segments) {
+        const utterance & u = k_utterances[pick(rng)];
+        std::vector<std::string> words;
+        std::stringstream ss(u.text);
+        for (std::string w; ss >> w;) words.push_back(w);
+
+        std::string prev;
+        size_t shown = 0;
+        while (shown < words.size() && (int)texts.size() < segments) {
+            // A step that heard nothing new recognizes the same text again.
+            if (shown > 0 && unit(rng) < 0.2) {
+                texts.push_back(prev);
+                langs.push_back(&u);
+                continue;
+            }
+            shown = std::min(words.size(), shown + (size_t)grow(rng));
+            std::string text;
+            for (size_t i = 0; i < shown; ++i) text += (i ? " " : "") + words[i];
+            texts.push_back(text);
+            langs.push_back(&u);
+            prev = text;
+        }
+        // The window still covers the finished utterance for a step or two.
+        for (int k = (int)(unit(rng) * 3); k > 0 && (int)texts.size() < segments; --k) {
+            texts.push_back(prev);
+            langs.push_back(&u);
+        }
+    }
+    return langs;
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+// ---------------------------------------------------------------------------
+
+struct stream_result {
+    std::vector<double> end_to_end_ms;
+    std::vector<double> request_ms;    // steps that went to the server
+    std::vector<double> all_translate_ms;
+    uint64_t requests   = 0;
+    uint64_t cache_hits = 0;
+    uint64_t failures   = 0;
+    uint64_t late_steps = 0;           // started after the next window was ready
+};
+
+static void run_stream(const std::string & url, int index, int segments, int step_ms, int infer_ms,
+                       int read_timeout_ms, uint64_t seed, stream_result & out) {
+    std::mt19937_64 rng(seed + (uint64_t)index * 7919);
+    std::vector<std::string> texts;
+    const std::vector<const utterance *> langs = make_stream(segments, rng, texts);
+
+    translator client(url, translator::k_connect_timeout_ms, read_timeout_ms);
+    const bench_clock::time_point start = bench_clock::now();
+    for (size_t i = 0; i < texts.size(); ++i) {
+        // Window i is ready at start + i * step; a serial loop that fell
+        // behind starts it late.
+        const bench_clock::time_point ready = start + std::chrono::milliseconds((int64_t)i * step_ms);
+        if (bench_clock::now() < ready) {
+            std::this_thread::sleep_until(ready);
+        } else if (i > 0 && step_ms > 0 && bench_clock::now() > ready + std::chrono::milliseconds(step_ms)) {
+            ++out.late_steps;
+        }
+        const bench_clock::time_point step_start = step_ms > 0 ? ready : bench_clock::now();
+
+        if (infer_ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(infer_ms));
+
+        const bench_clock::time_point t0 = bench_clock::now();
+        bool cached = false;
+        client.translate(texts[i], langs[i]->lang, langs[i]->target, cached);
+        const double translate_ms = ms_since(t0);
+
+        out.all_translate_ms.push_back(translate_ms);
+        if (!cached) out.request_ms.push_back(translate_ms);
+        out.end_to_end_ms.push_back(ms_since(step_start));
+    }
+    out.requests   = client.requests();
+    out.cache_hits = client.cache_hits();
+    out.failures   = client.failures();
+}
+
+// `v` sorted ascending.
+static double percentile(const std::vector<double> & v, double p) {
+    if (v.empty()) return 0.0;
+    const size_t idx = std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5));
+    return v[idx];
+}
+
+static void report_latency(const char * name, std::vector<double> & v) {
+    std::sort(v.begin(), v.end());
+    printf("  %-22s %7zu %9.1f %9.1f %9.1f %9.1f\n", name, v.size(),
+           percentile(v, 0.50), percentile(v, 0.90), percentile(v, 0.99), v.empty() ? 0.0 : v.back());
+}
+
+int main(int argc, char ** argv) {
+    int streams  = 4;
+    int segments = 300;
+    int step_ms  = 100;
+    int infer_ms = 0;
+    fake_config cfg;
+
+    auto usage = [&] {
+        fprintf(stderr,
+                "usage: %s [--streams N] [--segments N] [--step MS] [--infer MS] [--latency DIST]\n"
+                "          [--error-rate F] [--timeout-rate F] [--read-timeout MS] [--seed N]\n"
+                "DIST: fixed:MS | uniform:MIN:MAX | lognormal:MEDIAN:SIGMA | bimodal:FAST:SLOW:P_SLOW\n",
+                argv[0]);
+    };
+    auto int_arg = [&](int & i, int min_v, int & out) {
+        if (i + 1 >= argc) return false;
+        char * end = nullptr;
+        const long v = std::strtol(argv[++i], &end, 10);
+        if (*end != '\0' || v < min_v || v > 1000000) return false;
+        out = (int)v;
+        return true;
+    };
+    auto rate_arg = [&](int & i, double & out) {
+        if (i + 1 >= argc) return false;
+        char * end = nullptr;
+        const double v = std::strtod(argv[++i], &end);
+        if (*end != '\0' || v < 0.0 || v > 1.0) return false;
+        out = v;
+        return true;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--streams") {
+            ok = int_arg(i, 1, streams);
+        } else if (arg == "--segments") {
+            ok = int_arg(i, 1, segments);
+        } else if (arg == "--step") {
+            ok = int_arg(i, 0, step_ms);
+        } else if (arg == "--infer") {
+            ok = int_arg(i, 0, infer_ms);
+        } else if (arg == "--read-timeout") {
+            ok = int_arg(i, 1, cfg.read_timeout_ms);
+        } else if (arg == "--latency") {
+            ok = i + 1 < argc && parse_latency_dist(argv[++i], cfg.latency);
+        } else if (arg == "--error-rate") {
+            ok = rate_arg(i, cfg.error_rate);
+        } else if (arg == "--timeout-rate") {
+            ok = rate_arg(i, cfg.timeout_rate);
+        } else if (arg == "--seed") {
+            int seed = 0;
+            ok = int_arg(i, 0, seed);
+            cfg.seed = (uint64_t)seed;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+    if (cfg.error_rate + cfg.timeout_rate > 1.0) {
+        fprintf(stderr, "--error-rate + --timeout-rate must not exceed 1\n");
+        return 1;
+    }
+
+    fake_translator server(cfg);
+    if (!server.start()) {
+        fprintf(stderr, "error: cannot bind the fake translator on 127.0.0.1\n");
+        return 1;
+    }
+
+    printf("translate-bench: %d streams x %d segments, step %d ms, infer %d ms\n",
+           streams, segments, step_ms, infer_ms);
+    printf("fake translator: %s, latency %s, errors %.1f%%, timeouts %.1f%% (read timeout %d ms)\n",
+           server.url().c_str(), cfg.latency.spec.c_str(), cfg.error_rate * 100.0,
+           cfg.timeout_rate * 100.0, cfg.read_timeout_ms);
+
+    const std::string languages = fetch_translate_languages(server.url());
+    size_t n_languages = 0;
+    for (size_t pos = 0; (pos = languages.find("\"code\"", pos)) != std::string::npos; ++pos) ++n_languages;
+    printf("/languages: %zu languages\n\n", n_languages);
+
+    std::vector<stream_result> results((size_t)streams);
+    std::vector<std::thread> threads;
+    const bench_clock::time_point start = bench_clock::now();
+    for (int s = 0; s < streams; ++s) {
+        threads.emplace_back(run_stream, server.url(), s, segments, step_ms, infer_ms,
+                             cfg.read_timeout_ms, cfg.seed, std::ref(results[(size_t)s]));
+    }
+    for (auto & t : threads) t.join();
+    const double wall_ms = ms_since(start);
+    server.stop();
+
+    stream_result all;
+    for (auto & r : results) {
+        all.end_to_end_ms.insert(all.end_to_end_ms.end(), r.end_to_end_ms.begin(), r.end_to_end_ms.end());
+        all.request_ms.insert(all.request_ms.end(), r.request_ms.begin(), r.request_ms.end());
+        all.all_translate_ms.insert(all.all_translate_ms.end(), r.all_translate_ms.begin(), r.all_translate_ms.end());
+        all.requests   += r.requests;
+        all.cache_hits += r.cache_hits;
+        all.failures   += r.failures;
+        all.late_steps += r.late_steps;
+    }
+    const uint64_t steps = all.end_to_end_ms.size();
+
+    printf("  steps                  %llu in %.1f s (%llu started a step late)\n",
+           (unsigned long long)steps, wall_ms / 1000.0, (unsigned long long)all.late_steps);
+    printf("  translator requests    %llu (%.1f QPS)\n",
+           (unsigned long long)server.requests(), server.requests() * 1000.0 / wall_ms);
+    printf("  cache hits             %llu (%.1f%%)\n", (unsigned long long)all.cache_hits,
+           steps > 0 ? all.cache_hits * 100.0 / steps : 0.0);
+    printf("  failures               %llu (server errors %llu, timeouts %llu)\n\n",
+           (unsigned long long)all.failures, (unsigned long long)server.errors(),
+           (unsigned long long)server.timeouts());
+
+    printf("  %-22s %7s %9s %9s %9s %9s\n", "latency (ms)", "count", "p50", "p90", "p99", "max");
+    report_latency("translate request", all.request_ms);
+    report_latency("translate (all steps)", all.all_translate_ms);
+    report_latency("end to end", all.end_to_end_ms);
+    return 0;
+}
@@ -0,0 +1,160 @@
+# Generate the embedded web asset table from web/ (run in script mode)
+#
+#   cmake -DWEB_DIR=... -DOUTPUT=... -DWORK_DIR=... [-DBROTLI_EXECUTABLE=...]
+#         -P embed_web_assets.cmake
+#
+# Every file under WEB_DIR becomes one entry with its identity bytes, a
+# precompressed gzip variant (and brotli, when the tool is available), a
+# content-hash ETag and a Cache-Control policy. index.html is served at "/".
+#
+# HTML/CSS/JS may reference sibling assets as "/app.js?v=__ASSET_VERSION__";
+# the placeholder is replaced by a hash over all sources so those URLs can be
+# cached as immutable while index.html itself is always revalidated.
+
+cmake_minimum_required(VERSION 3.19)
+
+foreach(var WEB_DIR OUTPUT WORK_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "embed_web_assets: ${var} is required")
+    endif()
+endforeach()
+
+file(GLOB_RECURSE asset_files LIST_DIRECTORIES false RELATIVE "${WEB_DIR}" "${WEB_DIR}/*")
+list(SORT asset_files)
+
+# Version over the raw sources: any edit to any asset busts every URL.
+set(version_input "")
+foreach(rel IN LISTS asset_files)
+    file(SHA256 "${WEB_DIR}/${rel}" file_hash)
+    string(APPEND version_input "${rel}:${file_hash}\n")
+endforeach()
+string(SHA256 asset_version "${version_input}")
+string(SUBSTRING "${asset_version}" 0 12 asset_version)
+
+function(content_type_for rel out_var)
+    get_filename_component(ext "${rel}" LAST_EXT)
+    string(TOLOWER "${ext}" ext)
+    if(ext STREQUAL ".html" OR ext STREQUAL ".htm")
+        set(type "text/html; charset=utf-8")
+    elseif(ext STREQUAL ".css")
+        set(type "text/css; charset=utf-8")
+    elseif(ext STREQUAL ".js" OR ext STREQUAL ".mjs")
+        set(type "text/javascript; charset=utf-8")
+    elseif(ext STREQUAL ".json")
+        set(type "application/json")
+    elseif(ext STREQUAL ".svg")
+        set(type "image/svg+xml")
+    elseif(ext STREQUAL ".png")
+        set(type "image/png")
+    elseif(ext STREQUAL ".ico")
+        set(type "image/x-icon")
+    elseif(ext STREQUAL ".woff2")
+        set(type "font/woff2")
+    elseif(ext STREQUAL ".woff")
+        set(type "font/woff")
+    elseif(ext STREQUAL ".ttf")
+        set(type "font/ttf")
+    else()
+        set(type "application/octet-stream")
+    endif()
+    set(${out_var} "${type}" PARENT_SCOPE)
+endfunction()
+
+# Emits "static const unsigned char NAME[] = {...};" for FILE into out_var.
+function(byte_array name file out_var)
+    file(READ "${file}" hex HEX)
+    string(LENGTH "${hex}" hex_len)
+    if(hex_len EQUAL 0)
+        set(${out_var} "static const unsigned char ${name}[] = { 0x00 };\n" PARENT_SCOPE)
+        return()
+    endif()
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    # Wrap lines at 16 bytes so diffs/compilers stay happy with large fonts.
+    string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],){16})" "\\1\n    " bytes "${bytes}")
+    set(${out_var} "static const unsigned char ${name}[] = {\n    ${bytes}\n};\n" PARENT_SCOPE)
+endfunction()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+set(arrays "")
+set(entries "")
+set(index 0)
+
+foreach(rel IN LISTS asset_files)
+    content_type_for("${rel}" content_type)
+    set(src "${WORK_DIR}/asset${index}")
+
+    if(content_type MATCHES "^text/")
+        file(READ "${WEB_DIR}/${rel}" text)
+        string(REPLACE "__ASSET_VERSION__" "${asset_version}" text "${text}")
+        file(WRITE "${src}" "${text}")
+    else()
+        configure_file("${WEB_DIR}/${rel}" "${src}" COPYONLY)
+    endif()
+
+    file(SIZE "${src}" identity_size)
+    file(SHA256 "${src}" etag)
+    string(SUBSTRING "${etag}" 0 20 etag)
+
+    byte_array("k_asset${index}_identity" "${src}" identity_bytes)
+    string(APPEND arrays "${identity_bytes}")
+    set(gzip_blob "{ nullptr, 0 }")
+    set(brotli_blob "{ nullptr, 0 }")
+
+    # Already-compressed formats (fonts, images) gain nothing from another
+    # pass; keep a variant only when it saves at least 10%.
+    file(ARCHIVE_CREATE OUTPUT "${src}.gz" PATHS "${src}"
+         FORMAT raw COMPRESSION GZip COMPRESSION_LEVEL 9)
+    file(SIZE "${src}.gz" gzip_size)
+    math(EXPR gzip_limit "${identity_size} * 9 / 10")
+    if(gzip_size LESS gzip_limit)
+        byte_array("k_asset${index}_gzip" "${src}.gz" gzip_bytes)
+        string(APPEND arrays "${gzip_bytes}")
+        set(gzip_blob "{ k_asset${index}_gzip, ${gzip_size} }")
+    endif()
+
+    if(BROTLI_EXECUTABLE)
+        execute_process(COMMAND "${BROTLI_EXECUTABLE}" -q 11 -f -o "${src}.br" "${src}"
+                        RESULT_VARIABLE brotli_result)
+        if(brotli_result EQUAL 0)
+            file(SIZE "${src}.br" brotli_size)
+            if(brotli_size LESS gzip_limit)
+                byte_array("k_asset${index}_brotli" "${src}.br" brotli_bytes)
+                string(APPEND arrays "${brotli_bytes}")
+                set(brotli_blob "{ k_asset${index}_brotli, ${brotli_size} }")
+            endif()
+        endif()
+    endif()
+
+    if(rel STREQUAL "index.html")
+        set(url_path "/")
+        set(cache_control "no-cache")
+    else()
+        set(url_path "/${rel}")
+        set(cache_control "public, max-age=31536000, immutable")
+    endif()
+
+    string(APPEND entries
+        "    { \"${url_path}\", \"${content_type}\", \"W/\\\"${etag}\\\"\", \"${cache_control}\",\n"
+        "      { k_asset${index}_identity, ${identity_size} }, ${gzip_blob}, ${brotli_blob} },\n")
+
+    math(EXPR index "${index} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated by cmake/embed_web_assets.cmake from web/ - do not edit.
+
+#include \"web_assets.h\"
+
+${arrays}
+static const web_asset k_web_assets[] = {
+${entries}};
+
+const web_asset * web_assets_begin() { return k_web_assets; }
+const web_asset * web_assets_end()   { return k_web_assets + sizeof(k_web_assets) / sizeof(k_web_assets[0]); }
+")
+
+# Only touch the output when it changed so dependents don't rebuild needlessly.
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
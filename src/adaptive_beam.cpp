@@ -0,0 +1,66 @@
+#include "adaptive_beam.h"
+
+#include <cstdio>
+
+const char * beam_trigger_name(beam_trigger trigger) {
+    switch (trigger) {
+        case beam_trigger::none:        return "none";
+        case beam_trigger::logprob:     return "logprob";
+        case beam_trigger::compression: return "compression";
+    }
+    return "?";
+}
+
+beam_trigger adaptive_beam::judge(int n_tokens, float mean_logprob, double compression_ratio) {
+    beam_trigger trigger = beam_trigger::none;
+    if (n_tokens <= 0) {
+        // nothing decoded, nothing to improve
+    } else if (compression_thold_ > 0.0f && compression_ratio > compression_thold_) {
+        trigger = beam_trigger::compression;
+    } else if (mean_logprob < logprob_thold_) {
+        trigger = beam_trigger::logprob;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++steps_;
+    if (trigger == beam_trigger::logprob)     ++by_logprob_;
+    if (trigger == beam_trigger::compression) ++by_compression_;
+    return trigger;
+}
+
+bool adaptive_beam::improves(beam_trigger trigger, float greedy_logprob,
+                             int beam_n_tokens, float beam_logprob, double beam_compression) const {
+    if (beam_n_tokens <= 0) return false;
+    const bool beam_loops = compression_thold_ > 0.0f && beam_compression > compression_thold_;
+    if (trigger == beam_trigger::compression) {
+        return !beam_loops || beam_logprob > greedy_logprob;
+    }
+    return !beam_loops && beam_logprob > greedy_logprob;
+}
+
+void adaptive_beam::on_redecoded(double greedy_ms, double beam_ms, bool improved) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++redecoded_;
+    if (improved) ++improved_;
+    greedy_ms_sum_ += greedy_ms;
+    beam_ms_sum_   += beam_ms;
+}
+
+std::string adaptive_beam::to_json() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t fallbacks = by_logprob_ + by_compression_;
+    char buf[384];
+    snprintf(buf, sizeof(buf),
+             "{\"beam_size\":%d,\"logprob_thold\":%.3f,\"compression_thold\":%.3f,"
+             "\"steps\":%llu,\"fallbacks\":%llu,\"fallback_rate\":%.4f,"
+             "\"by_logprob\":%llu,\"by_compression\":%llu,\"improved\":%llu,"
+             "\"greedy_ms_avg\":%.1f,\"beam_ms_avg\":%.1f}",
+             beam_size_, logprob_thold_, compression_thold_,
+             (unsigned long long)steps_, (unsigned long long)fallbacks,
+             steps_ > 0 ? (double)fallbacks / (double)steps_ : 0.0,
+             (unsigned long long)by_logprob_, (unsigned long long)by_compression_,
+             (unsigned long long)improved_,
+             redecoded_ > 0 ? greedy_ms_sum_ / (double)redecoded_ : 0.0,
+             redecoded_ > 0 ? beam_ms_sum_ / (double)redecoded_ : 0.0);
+    return buf;
+}
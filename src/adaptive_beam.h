@@ -0,0 +1,68 @@
+// Greedy-first decoding with a beam-search re-decode for hard steps
+// (--adaptive-beam).
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class beam_trigger {
+    none,
+    logprob,       // mean token log-probability below --beam-logprob-thold
+    compression,   // text compression ratio above --beam-compression-thold
+};
+
+const char * beam_trigger_name(beam_trigger trigger);
+
+// Beam search costs several decoder passes per token, yet most speech
+// decodes just as well greedily. With --adaptive-beam every step is first
+// decoded greedily; only a step whose result looks unreliable (low mean
+// token log-probability, or the high compression ratio of a decoder loop)
+// is decoded again with beam search. The typical step therefore costs what
+// greedy costs. The re-decode's result replaces the greedy one only when
+// improves() says it is better; otherwise the greedy result is published.
+//
+// Driven by the inference thread; to_json() may be called from any thread.
+class adaptive_beam {
+public:
+    adaptive_beam(int beam_size, float logprob_thold, float compression_thold)
+        : beam_size_(beam_size), logprob_thold_(logprob_thold), compression_thold_(compression_thold) {}
+
+    bool enabled() const { return beam_size_ > 1; }
+    int beam_size() const { return beam_size_; }
+
+    // Judges a greedy step that decoded n_tokens text tokens (none = never
+    // re-decoded).
+    beam_trigger judge(int n_tokens, float mean_logprob, double compression_ratio);
+
+    // Whether the re-decode of a step judge() flagged beats its greedy
+    // result: it decoded text, does not loop where the greedy pass did not,
+    // and either has a higher mean log-probability or (for a compression
+    // trigger) brought the compression ratio back under the threshold.
+    bool improves(beam_trigger trigger, float greedy_logprob,
+                  int beam_n_tokens, float beam_logprob, double beam_compression) const;
+
+    // The re-decode of a step judge() flagged finished; `improved` is
+    // whether its result was kept.
+    void on_redecoded(double greedy_ms, double beam_ms, bool improved);
+
+    // {"beam_size":..,"logprob_thold":..,"compression_thold":..,"steps":..,
+    //  "fallbacks":..,"fallback_rate":..,"by_logprob":..,"by_compression":..,
+    //  "improved":..,"greedy_ms_avg":..,"beam_ms_avg":..}
+    std::string to_json() const;
+
+private:
+    const int   beam_size_;
+    const float logprob_thold_;
+    const float compression_thold_;
+
+    mutable std::mutex mtx_;
+    uint64_t steps_          = 0;
+    uint64_t by_logprob_     = 0;
+    uint64_t by_compression_ = 0;
+    uint64_t redecoded_      = 0;
+    uint64_t improved_       = 0;
+    double   greedy_ms_sum_  = 0.0;
+    double   beam_ms_sum_    = 0.0;
+};
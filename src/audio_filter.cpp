@@ -0,0 +1,353 @@
+#include "audio_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+typedef float f32x4 __attribute__((vector_size(16)));
+
+constexpr float k_pi = 3.14159265358979323846f;
+
+// Added to every section input so recursive state settles on a tiny DC
+// value instead of decaying into denormals during digital silence.
+constexpr float k_denormal_guard = 1e-18f;
+
+// Q of the two sections of a 4th-order Butterworth high-pass.
+constexpr float k_butterworth4_q[2] = { 0.54119610f, 1.30656296f };
+
+// Spectral gate: a bin is speech when it is this far above its mean noise
+// magnitude (a noise-only bin exceeds 2.5x its mean <1% of the time).
+constexpr float k_gate_open_ratio = 2.5f;
+// Frames averaged into the initial noise estimate before slow tracking.
+constexpr int   k_gate_learn_frames = 32;
+
+inline f32x4 load4(const float * p) {
+    f32x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void store4(float * p, f32x4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+void fft(std::complex<float> * a, int n, const int * bit_reverse,
+         const std::complex<float> * twiddles, bool inverse) {
+    for (int i = 0; i < n; ++i) {
+        if (i < bit_reverse[i]) {
+            std::swap(a[i], a[bit_reverse[i]]);
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        const int half   = len / 2;
+        const int stride = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < half; ++j) {
+                const std::complex<float> w = inverse ? std::conj(twiddles[j * stride]) : twiddles[j * stride];
+                const std::complex<float> u = a[i + j];
+                const std::complex<float> v = a[i + j + half] * w;
+                a[i + j]        = u + v;
+                a[i + j + half] = u - v;
+            }
+        }
+    }
+    if (inverse) {
+        const float scale = 1.0f / n;
+        for (int i = 0; i < n; ++i) {
+            a[i] *= scale;
+        }
+    }
+}
+
+} // namespace
+
+bool parse_frequency_list(const std::string & s, float min_hz, float max_hz, std::vector<float> & out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        const size_t comma = std::min(s.find(',', pos), s.size());
+        const std::string item = s.substr(pos, comma - pos);
+        char * end = nullptr;
+        const float hz = strtof(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || !std::isfinite(hz) || hz < min_hz || hz > max_hz) {
+            return false;
+        }
+        out.push_back(hz);
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+std::string describe_audio_filter(const audio_filter_config & cfg) {
+    if (!cfg.enabled()) {
+        return "off";
+    }
+
+    std::string out;
+    char buf[64];
+    if (cfg.highpass_hz > 0.0f) {
+        snprintf(buf, sizeof(buf), "highpass %.0f Hz", cfg.highpass_hz);
+        out += buf;
+    }
+    if (!cfg.notch_hz.empty()) {
+        out += out.empty() ? "notch " : ", notch ";
+        for (size_t i = 0; i < cfg.notch_hz.size(); ++i) {
+            snprintf(buf, sizeof(buf), "%s%.0f", i ? "/" : "", cfg.notch_hz[i]);
+            out += buf;
+        }
+        out += " Hz";
+    }
+    if (cfg.spectral_gate_db > 0.0f) {
+        snprintf(buf, sizeof(buf), "%sspectral gate -%.0f dB", out.empty() ? "" : ", ", cfg.spectral_gate_db);
+        out += buf;
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Biquad cascade
+// ---------------------------------------------------------------------------
+
+// RBJ audio EQ cookbook designs.
+biquad_cascade::coeffs biquad_cascade::highpass(float hz, float q, float sample_rate) {
+    const float w0    = 2.0f * k_pi * hz / sample_rate;
+    const float cs    = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * q);
+    const float a0    = 1.0f + alpha;
+    return { (1.0f + cs) / 2.0f / a0, -(1.0f + cs) / a0, (1.0f + cs) / 2.0f / a0,
+             -2.0f * cs / a0, (1.0f - alpha) / a0 };
+}
+
+biquad_cascade::coeffs biquad_cascade::notch(float hz, float q, float sample_rate) {
+    const float w0    = 2.0f * k_pi * hz / sample_rate;
+    const float cs    = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * q);
+    const float a0    = 1.0f + alpha;
+    return { 1.0f / a0, -2.0f * cs / a0, 1.0f / a0, -2.0f * cs / a0, (1.0f - alpha) / a0 };
+}
+
+void biquad_cascade::add(const coeffs & c) {
+    sections_.push_back(c);
+    rebuild();
+}
+
+void biquad_cascade::rebuild() {
+    const size_t groups = (sections_.size() + 3) / 4;
+    lanes_.assign(groups * 32, 0.0f);
+    for (size_t i = 0; i < groups * 4; ++i) {
+        const coeffs c = i < sections_.size() ? sections_[i] : coeffs{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        float * g = &lanes_[(i / 4) * 32];
+        const size_t lane = i % 4;
+        g[ 0 + lane] = c.b0;
+        g[ 4 + lane] = c.b1;
+        g[ 8 + lane] = c.b2;
+        g[12 + lane] = c.a1;
+        g[16 + lane] = c.a2;
+    }
+}
+
+void biquad_cascade::reset() {
+    for (size_t g = 0; g < lanes_.size(); g += 32) {
+        std::fill(lanes_.begin() + g + 20, lanes_.begin() + g + 32, 0.0f);
+    }
+}
+
+// Runs G consecutive groups in one pass so their recurrences overlap in the
+// pipeline. Group g+1 takes group g's last lane from the previous tick.
+template <int G>
+static void process_groups(float * lanes, const float * in, float * out, size_t n) {
+    const f32x4 guard = { k_denormal_guard, k_denormal_guard, k_denormal_guard, k_denormal_guard };
+    f32x4 b0[G], b1[G], b2[G], a1[G], a2[G], z1[G], z2[G], y[G];
+    for (int g = 0; g < G; ++g) {
+        const float * p = lanes + g * 32;
+        b0[g] = load4(p +  0);
+        b1[g] = load4(p +  4);
+        b2[g] = load4(p +  8);
+        a1[g] = load4(p + 12);
+        a2[g] = load4(p + 16);
+        z1[g] = load4(p + 20);
+        z2[g] = load4(p + 24);
+        y[g]  = load4(p + 28);
+    }
+
+    // Transposed direct form II, one section per lane. Lane k's input is
+    // lane k-1's output from the previous tick.
+    for (size_t i = 0; i < n; ++i) {
+        float carry = in[i];
+        for (int g = 0; g < G; ++g) {
+            const f32x4 x = f32x4{ carry, y[g][0], y[g][1], y[g][2] } + guard;
+            carry = y[g][3];
+            y[g]  = b0[g] * x + z1[g];
+            z1[g] = b1[g] * x - a1[g] * y[g] + z2[g];
+            z2[g] = b2[g] * x - a2[g] * y[g];
+        }
+        out[i] = y[G - 1][3];
+    }
+
+    for (int g = 0; g < G; ++g) {
+        float * p = lanes + g * 32;
+        store4(p + 20, z1[g]);
+        store4(p + 24, z2[g]);
+        store4(p + 28, y[g]);
+    }
+}
+
+void biquad_cascade::process(const float * in, float * out, size_t n) {
+    if (sections_.empty()) {
+        if (in != out) {
+            memmove(out, in, n * sizeof(float));
+        }
+        return;
+    }
+
+    // Two groups (eight sections) per pass keep the state in registers.
+    const size_t groups = lanes_.size() / 32;
+    const float * src = in;
+    for (size_t g = 0; g < groups; g += 2) {
+        if (groups - g >= 2) {
+            process_groups<2>(&lanes_[g * 32], src, out, n);
+        } else {
+            process_groups<1>(&lanes_[g * 32], src, out, n);
+        }
+        src = out;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Spectral gate
+// ---------------------------------------------------------------------------
+
+spectral_gate::spectral_gate(float attenuation_db)
+    : floor_gain_(powf(10.0f, -attenuation_db / 20.0f)) {
+    const int n = k_fft_size;
+    window_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        // Periodic sqrt-Hann: squared windows at 50% overlap sum to one, so
+        // an all-pass gain reconstructs the input exactly.
+        window_[i] = sqrtf(0.5f - 0.5f * cosf(2.0f * k_pi * i / n));
+    }
+    twiddles_.resize(n / 2);
+    for (int i = 0; i < n / 2; ++i) {
+        twiddles_[i] = std::polar(1.0f, -2.0f * k_pi * i / n);
+    }
+    bit_reverse_.resize(n);
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = r;
+    }
+
+    spectrum_.resize(n);
+    reset();
+}
+
+void spectral_gate::reset() {
+    in_buf_.assign(k_fft_size, 0.0f);
+    out_buf_.assign(k_hop, 0.0f);
+    overlap_.assign(k_fft_size, 0.0f);
+    noise_.assign(k_fft_size / 2 + 1, 0.0f);
+    gain_.assign(k_fft_size / 2 + 1, 1.0f);
+    fill_   = k_fft_size - k_hop;
+    frames_ = 0;
+}
+
+void spectral_gate::process(const float * in, float * out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const float x = in[i];
+        out[i] = out_buf_[fill_ - (k_fft_size - k_hop)];
+        in_buf_[fill_] = x;
+        if (++fill_ == k_fft_size) {
+            process_frame();
+            fill_ = k_fft_size - k_hop;
+        }
+    }
+}
+
+void spectral_gate::process_frame() {
+    const int n    = k_fft_size;
+    const int half = n / 2;
+
+    for (int i = 0; i < n; ++i) {
+        spectrum_[i] = std::complex<float>(in_buf_[i] * window_[i], 0.0f);
+    }
+    fft(spectrum_.data(), n, bit_reverse_.data(), twiddles_.data(), false);
+
+    // Mean noise magnitude per bin. The first frames are simply averaged;
+    // after that noise-like frames are tracked over ~0.3 s and speech-like
+    // ones only leak in over ~8 s, so a louder room is still learned.
+    for (int k = 0; k <= half; ++k) {
+        const float mag = std::abs(spectrum_[k]);
+        float & noise = noise_[k];
+        const bool speech_like = mag > k_gate_open_ratio * noise;
+        if (frames_ < k_gate_learn_frames) {
+            noise += (mag - noise) / (frames_ + 1);
+        } else {
+            noise += (speech_like ? 0.002f : 0.05f) * (mag - noise);
+        }
+
+        // Open instantly, close over a few frames to avoid musical noise.
+        const float target = speech_like ? 1.0f : floor_gain_;
+        gain_[k] = target >= gain_[k] ? target : 0.7f * gain_[k] + 0.3f * target;
+
+        spectrum_[k] *= gain_[k];
+        if (k > 0 && k < half) {
+            spectrum_[n - k] *= gain_[k];
+        }
+    }
+    ++frames_;
+
+    fft(spectrum_.data(), n, bit_reverse_.data(), twiddles_.data(), true);
+
+    for (int i = 0; i < n; ++i) {
+        overlap_[i] += spectrum_[i].real() * window_[i];
+    }
+    std::copy(overlap_.begin(), overlap_.begin() + k_hop, out_buf_.begin());
+    std::copy(overlap_.begin() + k_hop, overlap_.end(), overlap_.begin());
+    std::fill(overlap_.end() - k_hop, overlap_.end(), 0.0f);
+    std::copy(in_buf_.begin() + k_hop, in_buf_.end(), in_buf_.begin());
+}
+
+// ---------------------------------------------------------------------------
+// Filter chain
+// ---------------------------------------------------------------------------
+
+audio_filter::audio_filter(const audio_filter_config & cfg, float sample_rate) {
+    if (cfg.highpass_hz > 0.0f) {
+        for (float q : k_butterworth4_q) {
+            cascade_.add(biquad_cascade::highpass(cfg.highpass_hz, q, sample_rate));
+        }
+    }
+    for (float hz : cfg.notch_hz) {
+        cascade_.add(biquad_cascade::notch(hz, cfg.notch_q, sample_rate));
+    }
+    if (cfg.spectral_gate_db > 0.0f) {
+        gate_ = std::make_unique<spectral_gate>(cfg.spectral_gate_db);
+    }
+}
+
+void audio_filter::process(const float * in, float * out, size_t n) {
+    cascade_.process(in, out, n);
+    if (gate_) {
+        gate_->process(out, out, n);
+    }
+}
+
+void audio_filter::process(const std::vector<float> & in, std::vector<float> & out) {
+    out.resize(in.size());
+    process(in.data(), out.data(), in.size());
+}
+
+void audio_filter::reset() {
+    cascade_.reset();
+    if (gate_) {
+        gate_->reset();
+    }
+}
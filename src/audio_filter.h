@@ -0,0 +1,105 @@
+// Streaming pre-filter applied to captured audio before the VAD gate and
+// whisper_full (--highpass, --notch, --spectral-gate).
+//
+// State carries across calls, so feeding one step at a time gives the same
+// output as filtering the whole stream at once. The output is delayed by the
+// biquad pipeline (about one sample per section) and, with the spectral gate
+// on, by one FFT frame (32 ms).
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct audio_filter_config {
+    float              highpass_hz      = 0.0f;   // 0 = off; 4th-order Butterworth
+    std::vector<float> notch_hz;                  // hum fundamentals / harmonics
+    float              notch_q          = 30.0f;
+    float              spectral_gate_db = 0.0f;   // attenuation of noise-only bins, 0 = off
+
+    bool enabled() const {
+        return highpass_hz > 0.0f || !notch_hz.empty() || spectral_gate_db > 0.0f;
+    }
+};
+
+// Parses "50,100,150" (Hz). Every entry must lie within [min_hz, max_hz].
+bool parse_frequency_list(const std::string & s, float min_hz, float max_hz, std::vector<float> & out);
+
+// Human-readable summary for the startup banner ("off" when disabled).
+std::string describe_audio_filter(const audio_filter_config & cfg);
+
+// Cascade of biquad sections evaluated four at a time: lane k of a vector
+// runs section k on the sample lane k-1 produced one tick earlier, so four
+// sections cost one vector update per sample instead of four dependent
+// scalar ones.
+class biquad_cascade {
+public:
+    struct coeffs {
+        float b0, b1, b2, a1, a2;   // normalized by a0
+    };
+
+    void add(const coeffs & c);
+    bool empty() const { return sections_.empty(); }
+    void process(const float * in, float * out, size_t n);
+    void reset();
+
+    static coeffs highpass(float hz, float q, float sample_rate);
+    static coeffs notch(float hz, float q, float sample_rate);
+
+private:
+    void rebuild();
+
+    std::vector<coeffs> sections_;
+    // Groups of four sections, each stored as eight 4-lane rows: b0, b1,
+    // b2, a1, a2, then the state z1, z2 and the previous tick's outputs.
+    // Unused lanes of the last group hold pass-through sections.
+    std::vector<float>  lanes_;
+};
+
+// Per-bin noise gate over a 512-point STFT (32 ms at 16 kHz, 50% overlap,
+// sqrt-Hann analysis/synthesis). Each bin tracks its own noise level; bins that do
+// not rise clearly above it are attenuated.
+class spectral_gate {
+public:
+    explicit spectral_gate(float attenuation_db);
+
+    void process(const float * in, float * out, size_t n);
+    void reset();
+
+    static constexpr int k_fft_size = 512;
+    static constexpr int k_hop      = k_fft_size / 2;
+
+private:
+    void process_frame();
+
+    float floor_gain_;
+    std::vector<float> window_;
+    std::vector<std::complex<float>> twiddles_;
+    std::vector<int> bit_reverse_;
+
+    std::vector<float> in_buf_;      // last k_fft_size input samples
+    std::vector<float> out_buf_;     // next k_hop output samples
+    std::vector<float> overlap_;     // overlap-add accumulator
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<float> noise_;
+    std::vector<float> gain_;
+    int  fill_   = 0;
+    int  frames_ = 0;
+};
+
+class audio_filter {
+public:
+    audio_filter(const audio_filter_config & cfg, float sample_rate);
+
+    // In-place is fine (in == out).
+    void process(const float * in, float * out, size_t n);
+    void process(const std::vector<float> & in, std::vector<float> & out);
+    void reset();
+
+private:
+    biquad_cascade cascade_;
+    std::unique_ptr<spectral_gate> gate_;
+};
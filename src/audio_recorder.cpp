@@ -0,0 +1,212 @@
+#include "audio_recorder.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+audio_recorder::audio_recorder(int chunk_samples, int keep_files)
+    : keep_files_(keep_files), free_(k_pool_chunks), filled_(k_pool_chunks) {
+    pool_.resize(k_pool_chunks);
+    for (auto & c : pool_) {
+        c = std::make_unique<chunk>();
+        c->samples.reserve(chunk_samples);
+        free_.try_push(c.get());
+    }
+    write_buf_.reserve(k_write_buffer_bytes);
+    sidecar_buf_.reserve(64 * 1024);
+}
+
+bool audio_recorder::open_dir(const std::string & dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        fprintf(stderr, "error: cannot create record dir '%s': %s\n", dir.c_str(), ec.message().c_str());
+        return false;
+    }
+    dir_ = dir;
+
+    for (const auto & entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("capture-", 0) == 0 && entry.path().extension() == ".wav") {
+            finished_.push_back(entry.path().string());
+        }
+    }
+    std::sort(finished_.begin(), finished_.end());
+    prune_old_files();
+
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void audio_recorder::stop() {
+    if (!running_.exchange(false)) return;
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void audio_recorder::submit(const std::vector<float> & samples, const recorded_step_info & info) {
+    chunk * c = nullptr;
+    if (!free_.try_pop(c)) {
+        n_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    c->samples.assign(samples.begin(), samples.end());
+    c->info = info;
+    filled_.try_push(std::move(c));  // cannot fail: both rings hold the whole pool
+    cv_.notify_one();
+}
+
+void audio_recorder::make_wav_header(char * h, uint32_t data_bytes) {
+    memcpy(h, "RIFF", 4);
+    put_u32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_u32(h + 16, 16);
+    put_u16(h + 20, 3);                          // WAVE_FORMAT_IEEE_FLOAT
+    put_u16(h + 22, 1);
+    put_u32(h + 24, k_sample_rate);
+    put_u32(h + 28, k_sample_rate * 4);
+    put_u16(h + 32, 4);
+    put_u16(h + 34, 32);
+    memcpy(h + 36, "data", 4);
+    put_u32(h + 40, data_bytes);
+}
+
+bool audio_recorder::open_new_file(int64_t first_ms) {
+    char name[64];
+    snprintf(name, sizeof(name), "capture-%013lld", (long long)first_ms);
+    const std::filesystem::path base = std::filesystem::path(dir_) / name;
+    wav_path_ = base.string() + ".wav";
+
+    wav_fd_ = open(wav_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    sidecar_fd_ = open((base.string() + ".jsonl").c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (wav_fd_ < 0 || sidecar_fd_ < 0) {
+        fprintf(stderr, "warning: record: cannot create '%s'\n", wav_path_.c_str());
+        close_current();
+        return false;
+    }
+
+    file_samples_ = 0;
+    char header[44];
+    make_wav_header(header, 0);
+    write_buf_.insert(write_buf_.end(), header, header + sizeof(header));
+    return true;
+}
+
+bool audio_recorder::write_all(int fd, const char * p, size_t n) {
+    while (n > 0) {
+        const ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+void audio_recorder::flush() {
+    if (wav_fd_ < 0 || (write_buf_.empty() && sidecar_buf_.empty())) return;
+
+    if (!write_all(wav_fd_, write_buf_.data(), write_buf_.size()) ||
+        !write_all(sidecar_fd_, sidecar_buf_.data(), sidecar_buf_.size())) {
+        if (!write_failed_) {
+            fprintf(stderr, "warning: record: write to '%s' failed\n", wav_path_.c_str());
+            write_failed_ = true;
+        }
+    }
+    n_bytes_.fetch_add(write_buf_.size() + sidecar_buf_.size(), std::memory_order_relaxed);
+    write_buf_.clear();
+    sidecar_buf_.clear();
+
+    char header[44];
+    make_wav_header(header, (uint32_t)(file_samples_ * sizeof(float)));
+    if (pwrite(wav_fd_, header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        write_failed_ = true;
+    }
+}
+
+void audio_recorder::close_current() {
+    if (wav_fd_ >= 0) {
+        flush();
+        close(wav_fd_);
+        finished_.push_back(wav_path_);
+    }
+    if (sidecar_fd_ >= 0) close(sidecar_fd_);
+    wav_fd_ = -1;
+    sidecar_fd_ = -1;
+    prune_old_files();
+}
+
+void audio_recorder::prune_old_files() {
+    if (keep_files_ <= 0) return;
+    while ((int)finished_.size() > keep_files_) {
+        std::error_code ec;
+        const std::filesystem::path wav = finished_.front();
+        std::filesystem::remove(wav, ec);
+        std::filesystem::remove(std::filesystem::path(wav).replace_extension(".jsonl"), ec);
+        finished_.erase(finished_.begin());
+    }
+}
+
+void audio_recorder::write_chunk(const chunk & c) {
+    if (wav_fd_ < 0 || file_samples_ >= k_file_samples) {
+        close_current();
+        if (!open_new_file(c.info.capture_ms)) {
+            n_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    const size_t n_bytes = c.samples.size() * sizeof(float);
+    if (write_buf_.size() + n_bytes > k_write_buffer_bytes) flush();
+    const char * bytes = reinterpret_cast<const char *>(c.samples.data());
+    write_buf_.insert(write_buf_.end(), bytes, bytes + n_bytes);
+
+    char line[320];
+    const int n = snprintf(line, sizeof(line),
+        "{\"step\":%llu,\"t\":%lld,\"offset\":%lld,\"samples\":%zu,"
+        "\"energy\":%.6g,\"gate\":%.6g,\"floor\":%.6g,\"outcome\":\"%s\",\"whisper\":%s}\n",
+        (unsigned long long)c.info.step, (long long)c.info.capture_ms, (long long)file_samples_,
+        c.samples.size(), c.info.energy, c.info.gate, c.info.noise_floor, c.info.outcome,
+        c.info.whisper_ran ? "true" : "false");
+    if (n > 0) sidecar_buf_.append(line, std::min((size_t)n, sizeof(line) - 1));
+
+    file_samples_ += (int64_t)c.samples.size();
+}
+
+void audio_recorder::run() {
+    auto last_flush = std::chrono::steady_clock::now();
+    chunk * c = nullptr;
+
+    while (true) {
+        const bool keep_running = running_.load();
+        bool wrote = false;
+        while (filled_.try_pop(c)) {
+            write_chunk(*c);
+            free_.try_push(std::move(c));
+            wrote = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!keep_running ||
+            now - last_flush >= std::chrono::milliseconds(k_flush_interval_ms)) {
+            flush();
+            last_flush = now;
+        }
+        if (!keep_running) break;
+
+        if (!wrote) {
+            std::unique_lock<std::mutex> lock(wait_mtx_);
+            cv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+    close_current();
+}
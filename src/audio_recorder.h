@@ -0,0 +1,117 @@
+// Rotating WAV + JSONL recording of every captured step (--record-dir).
+
+#pragma once
+
+#include "spsc_ring.h"
+#include "util.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Gate decision for one captured step, as written to the sidecar.
+struct recorded_step_info {
+    uint64_t     step        = 0;
+    int64_t      capture_ms  = 0;
+    float        energy      = 0.0f;
+    float        gate        = 0.0f;
+    float        noise_floor = 0.0f;
+    const char * outcome     = "";    // static string: silent/warmup/vad_skip/vad_bypass/infer
+    bool         whisper_ran = false;
+};
+
+// Every step the main loop pulls (pcmf32_new) is appended to rotating
+// 32-bit float WAV files, bit-exact so a replay sees the same energies the
+// VAD saw, plus one sidecar JSON line per step in a .jsonl of the same name.
+// The WAV is the raw capture even with a pre-filter on; the sidecar
+// energies are those of the filtered step the VAD judged:
+//
+//   {"step":12,"t":1739500000000,"offset":176000,"samples":16000,
+//    "energy":0.0123,"gate":0.0041,"floor":0.0025,"outcome":"infer","whisper":true}
+//
+// "offset" is the first sample of the step within the WAV. The inference
+// thread only copies into a preallocated chunk taken from a free list; the
+// writer thread batches chunks into large sequential writes. When the pool
+// is exhausted (disk stalled) the step is dropped and counted instead of
+// waiting, so step numbers in the sidecar show the gap.
+class audio_recorder {
+public:
+    static constexpr size_t  k_pool_chunks       = 64;
+    static constexpr size_t  k_write_buffer_bytes = 1024 * 1024;
+    static constexpr int64_t k_flush_interval_ms = 1000;
+    static constexpr int64_t k_file_samples      = 5 * 60 * k_sample_rate;  // 5 min per file
+
+    audio_recorder(int chunk_samples, int keep_files);
+
+    ~audio_recorder() {
+        stop();
+    }
+
+    bool open_dir(const std::string & dir);
+
+    void stop();
+
+    // Inference thread. Never blocks on the writer.
+    void submit(const std::vector<float> & samples, const recorded_step_info & info);
+
+    uint64_t dropped_count() const { return n_dropped_.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return n_bytes_.load(std::memory_order_relaxed); }
+
+private:
+    struct chunk {
+        std::vector<float> samples;
+        recorded_step_info info;
+    };
+
+    static void put_u16(char * p, uint16_t v) { p[0] = (char)(v & 0xff); p[1] = (char)(v >> 8); }
+    static void put_u32(char * p, uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = (char)((v >> (8 * i)) & 0xff);
+    }
+
+    // RIFF/WAVE header for IEEE float mono 16 kHz with data_bytes of samples.
+    static void make_wav_header(char * h, uint32_t data_bytes);
+
+    bool open_new_file(int64_t first_ms);
+
+    static bool write_all(int fd, const char * p, size_t n);
+
+    // Writes the batched samples and sidecar lines, then patches the WAV
+    // sizes so the file is playable even if the process dies afterwards.
+    void flush();
+
+    void close_current();
+
+    void prune_old_files();
+
+    void write_chunk(const chunk & c);
+
+    void run();
+
+    std::string                          dir_;
+    int                                  keep_files_;
+    std::vector<std::unique_ptr<chunk>>  pool_;
+    spsc_ring<chunk *>                   free_;     // writer -> inference thread
+    spsc_ring<chunk *>                   filled_;   // inference thread -> writer
+    std::thread                          thread_;
+    std::atomic<bool>                    running_{false};
+    std::mutex                           wait_mtx_;
+    std::condition_variable              cv_;
+    std::atomic<uint64_t>                n_dropped_{0};
+    std::atomic<uint64_t>                n_bytes_{0};
+
+    // Writer thread only.
+    int                      wav_fd_     = -1;
+    int                      sidecar_fd_ = -1;
+    std::string              wav_path_;
+    int64_t                  file_samples_ = 0;
+    std::vector<char>        write_buf_;
+    std::string              sidecar_buf_;
+    std::vector<std::string> finished_;
+    bool                     write_failed_ = false;
+};
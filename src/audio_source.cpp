@@ -0,0 +1,120 @@
+#include "audio_source.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void ingest_decoder::decode(const char * data, size_t len, std::vector<float> & out) {
+    const size_t bytes_per_sample = format_ == ingest_format::s16le ? 2 : 4;
+    const size_t frame_bytes = bytes_per_sample * (size_t)channels_;
+
+    carry_.append(data, len);
+    const size_t n_frames = carry_.size() / frame_bytes;
+    const char * p = carry_.data();
+
+    for (size_t i = 0; i < n_frames; ++i) {
+        float mono = 0.0f;
+        for (int ch = 0; ch < channels_; ++ch) {
+            if (format_ == ingest_format::s16le) {
+                int16_t v;
+                memcpy(&v, p, 2);
+                mono += v / 32768.0f;
+            } else {
+                float v;
+                memcpy(&v, p, 4);
+                mono += std::isfinite(v) ? v : 0.0f;
+            }
+            p += bytes_per_sample;
+        }
+        resample(mono / channels_, out);
+    }
+    carry_.erase(0, n_frames * frame_bytes);
+}
+
+void ingest_decoder::resample(float x, std::vector<float> & out) {
+    if (step_ >= 1.0) {
+        acc_ += x;
+        ++acc_n_;
+        phase_ += 1.0;
+        if (phase_ >= step_) {
+            out.push_back((float)(acc_ / acc_n_));
+            phase_ -= step_;
+            acc_ = 0.0;
+            acc_n_ = 0;
+        }
+        return;
+    }
+    while (phase_ <= 1.0) {
+        out.push_back(prev_ + (x - prev_) * (float)phase_);
+        phase_ += step_;
+    }
+    phase_ -= 1.0;
+    prev_ = x;
+}
+
+network_audio_source::network_audio_source(int capacity_ms, int jitter_ms)
+    : jitter_samples_((size_t)jitter_ms * k_sample_rate / 1000) {
+    size_t cap = 1024;
+    while (cap < (size_t)capacity_ms * k_sample_rate / 1000) cap <<= 1;
+    ring_.resize(cap);
+    mask_ = cap - 1;
+}
+
+void network_audio_source::write(const float * samples, size_t n) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    const size_t room = ring_.size() - (head - tail);
+    if (n > room) {
+        n_overflow_.fetch_add(n - room, std::memory_order_relaxed);
+        n = room;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        ring_[(head + i) & mask_] = samples[i];
+    }
+    head_.store(head + n, std::memory_order_release);
+}
+
+void network_audio_source::get(int ms, std::vector<float> & out) {
+    update_release();
+
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t want = (size_t)ms * k_sample_rate / 1000;
+    const size_t n = std::min(want, released_ - tail);
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = ring_[(released_ - n + i) & mask_];
+    }
+}
+
+void network_audio_source::update_release() {
+    using clock = std::chrono::steady_clock;
+    const size_t head = head_.load(std::memory_order_acquire);
+    const auto now = clock::now();
+
+    if (!primed_) {
+        if (head - released_ < std::max<size_t>(jitter_samples_, 1)) {
+            return;
+        }
+        primed_ = true;
+        release_base_ = released_;
+        release_t0_ = now;
+    }
+
+    const double elapsed = std::chrono::duration<double>(now - release_t0_).count();
+    size_t target = release_base_ + (size_t)(elapsed * k_sample_rate);
+
+    if (target >= head) {
+        if (target > head) {
+            n_underruns_.fetch_add(1, std::memory_order_relaxed);
+            primed_ = false;
+        }
+        target = head;
+    } else if (head - target > 3 * jitter_samples_ + k_sample_rate / 10) {
+        const size_t surplus = head - target - jitter_samples_;
+        release_base_ += surplus;
+        target += surplus;
+        n_catchups_.fetch_add(1, std::memory_order_relaxed);
+    }
+    released_ = std::max(released_, target);
+}
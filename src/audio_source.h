@@ -0,0 +1,119 @@
+// Audio sources the main loop can pull from besides SDL capture.
+
+#pragma once
+
+#include "util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What the main loop pulls audio from. Implementations follow audio_async's
+// contract: get() returns the newest `ms` of buffered audio without
+// consuming it, clear() discards everything buffered so far.
+class audio_source {
+public:
+    virtual ~audio_source() = default;
+
+    // Returns false when the process should stop (e.g. SDL quit event).
+    virtual bool poll() { return true; }
+    virtual void get(int ms, std::vector<float> & out) = 0;
+    virtual void clear() = 0;
+    virtual void pause() {}
+};
+
+// Sample formats accepted by POST /api/ingest.
+enum class ingest_format {
+    s16le,
+    f32le,
+};
+
+// Turns raw interleaved PCM in any rate/channel layout into 16 kHz mono
+// floats. Input may be split at arbitrary byte boundaries.
+class ingest_decoder {
+public:
+    ingest_decoder(ingest_format format, int sample_rate, int channels)
+        : format_(format), channels_(channels),
+          step_((double)sample_rate / k_sample_rate) {}
+
+    void decode(const char * data, size_t len, std::vector<float> & out);
+
+private:
+    // Downsampling averages the input over each output period (a box
+    // filter, enough to keep speech-band aliasing down); upsampling
+    // interpolates linearly.
+    void resample(float x, std::vector<float> & out);
+
+    ingest_format format_;
+    int           channels_;
+    double        step_;
+    double        phase_ = 0.0;
+    double        acc_   = 0.0;
+    int           acc_n_ = 0;
+    float         prev_  = 0.0f;
+    std::string   carry_;
+};
+
+// Network audio: the ingest handler (producer) writes 16 kHz samples into a
+// lock-free SPSC ring; the main loop (consumer) reads it through the
+// audio_source interface.
+//
+// Jitter buffer and clock-drift policy: samples are released to the main
+// loop at the local 16 kHz clock, starting once jitter_ms of audio has
+// arrived. If the sender's clock runs slow the buffer underruns; release
+// then pauses and the buffer re-primes to jitter_ms. If it runs fast the
+// backlog grows; once it exceeds 3 x jitter_ms the surplus is released at
+// once (a single catch-up step) so latency stays bounded. Audio is only
+// discarded when the ring itself overflows or the main loop falls behind.
+class network_audio_source : public audio_source {
+public:
+    network_audio_source(int capacity_ms, int jitter_ms);
+
+    // Only one sender at a time.
+    bool begin_stream() {
+        bool expected = false;
+        return streaming_.compare_exchange_strong(expected, true);
+    }
+
+    void end_stream() {
+        streaming_ = false;
+    }
+
+    // Producer.
+    void write(const float * samples, size_t n);
+
+    // Consumer.
+    void get(int ms, std::vector<float> & out) override;
+
+    void clear() override {
+        tail_.store(released_, std::memory_order_release);
+    }
+
+    uint64_t overflow_samples() const { return n_overflow_.load(std::memory_order_relaxed); }
+    uint64_t underruns()        const { return n_underruns_.load(std::memory_order_relaxed); }
+    uint64_t catchups()         const { return n_catchups_.load(std::memory_order_relaxed); }
+
+private:
+    void update_release();
+
+    std::vector<float> ring_;
+    size_t             mask_ = 0;
+    const size_t       jitter_samples_;
+
+    alignas(64) std::atomic<size_t> head_{0};  // written by the producer
+    alignas(64) std::atomic<size_t> tail_{0};  // written by the consumer
+
+    // Consumer only.
+    size_t             released_ = 0;
+    size_t             release_base_ = 0;
+    bool               primed_ = false;
+    std::chrono::steady_clock::time_point release_t0_;
+
+    std::atomic<bool>     streaming_{false};
+    std::atomic<uint64_t> n_overflow_{0};
+    std::atomic<uint64_t> n_underruns_{0};
+    std::atomic<uint64_t> n_catchups_{0};
+};
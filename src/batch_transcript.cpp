@@ -0,0 +1,170 @@
+#include "batch_transcript.h"
+#include "json.h"
+#include "text_filter.h"
+#include "transcript_log.h"
+#include "util.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+bool parse_batch_format(const std::string & s, batch_format & out) {
+    if (s == "srt") {
+        out = batch_format::srt;
+    } else if (s == "vtt") {
+        out = batch_format::vtt;
+    } else if (s == "jsonl") {
+        out = batch_format::jsonl;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char * batch_format_extension(batch_format format) {
+    switch (format) {
+        case batch_format::srt:   return "srt";
+        case batch_format::vtt:   return "vtt";
+        case batch_format::jsonl: return "jsonl";
+    }
+    return "txt";
+}
+
+bool expand_batch_inputs(const std::vector<std::string> & entries, std::vector<std::string> & out,
+                         std::string & error) {
+    for (const std::string & entry : entries) {
+        if (entry.empty() || entry[0] != '@') {
+            out.push_back(entry);
+            continue;
+        }
+        std::ifstream list(entry.substr(1));
+        if (!list) {
+            error = "cannot read list '" + entry.substr(1) + "'";
+            return false;
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            line = trim_whitespace(line);
+            if (line.empty() || line[0] == '#') continue;
+            out.push_back(line);
+        }
+    }
+    if (out.empty()) {
+        error = "no input files";
+        return false;
+    }
+    return true;
+}
+
+std::string batch_output_path(const std::string & input, const std::string & out_dir, batch_format format) {
+    std::filesystem::path path(input);
+    path.replace_extension(batch_format_extension(format));
+    if (!out_dir.empty()) {
+        path = std::filesystem::path(out_dir) / path.filename();
+    }
+    return path.string();
+}
+
+std::vector<audio_chunk> plan_chunks(const std::vector<float> & pcm, size_t max_samples, size_t search_samples) {
+    static constexpr size_t k_frame = 320;   // 20 ms at 16 kHz
+
+    std::vector<audio_chunk> chunks;
+    const size_t n = pcm.size();
+    size_t begin = 0;
+    while (begin < n) {
+        size_t end = begin + max_samples;
+        if (end >= n) {
+            chunks.push_back({begin, n});
+            break;
+        }
+
+        // Quietest frame in [end - search, end); ties keep the latest one.
+        const size_t search_begin = end - std::min(search_samples, max_samples / 2);
+        float best_energy = -1.0f;
+        size_t best_end = end;
+        for (size_t f = search_begin; f + k_frame <= end; f += k_frame) {
+            float energy = 0.0f;
+            for (size_t i = f; i < f + k_frame; ++i) {
+                energy += pcm[i] < 0 ? -pcm[i] : pcm[i];
+            }
+            if (best_energy < 0.0f || energy <= best_energy) {
+                best_energy = energy;
+                best_end = f + k_frame / 2;
+            }
+        }
+        chunks.push_back({begin, best_end});
+        begin = best_end;
+    }
+    return chunks;
+}
+
+size_t filter_batch_segments(std::vector<batch_segment> & segments) {
+    std::vector<batch_segment> kept;
+    kept.reserve(segments.size());
+    std::string prev_text;
+    std::string prev_norm;
+    for (batch_segment & seg : segments) {
+        seg.text = trim_whitespace(seg.text);
+        if (seg.text.empty()) continue;
+
+        const std::string norm = normalize_for_dedup(seg.text);
+        if (!prev_norm.empty() && norm == prev_norm) continue;
+
+        std::string reason;
+        if (should_drop_repetitive_text(seg.text, prev_text, reason)) continue;
+
+        prev_text = seg.text;
+        prev_norm = norm;
+        kept.push_back(std::move(seg));
+    }
+    const size_t dropped = segments.size() - kept.size();
+    segments.swap(kept);
+    return dropped;
+}
+
+bool write_batch_transcript(const std::string & path, batch_format format,
+                            const std::vector<batch_segment> & segments, std::string & error) {
+    const std::string tmp_path = path + ".tmp";
+    FILE * f = fopen(tmp_path.c_str(), "w");
+    if (!f) {
+        error = strerror(errno);
+        return false;
+    }
+
+    if (format == batch_format::vtt) {
+        fputs("WEBVTT\n\n", f);
+    }
+    size_t index = 0;
+    for (const batch_segment & seg : segments) {
+        if (format == batch_format::jsonl) {
+            const std::string line = "{\"start_ms\":" + std::to_string(seg.start_ms) +
+                                     ",\"end_ms\":" + std::to_string(seg.end_ms) +
+                                     "," + json_str("language", seg.language) +
+                                     "," + json_str("text", seg.text) + "}\n";
+            fputs(line.c_str(), f);
+            continue;
+        }
+        const bool vtt = format == batch_format::vtt;
+        if (!vtt) {
+            fprintf(f, "%zu\n", ++index);
+        }
+        fprintf(f, "%s --> %s\n%s\n\n",
+                format_cue_time(seg.start_ms, vtt).c_str(), format_cue_time(seg.end_ms, vtt).c_str(),
+                seg.text.c_str());
+    }
+
+    const bool write_failed = ferror(f) != 0;
+    if (fclose(f) != 0 || write_failed) {
+        error = "write failed";
+        remove(tmp_path.c_str());
+        return false;
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        error = strerror(errno);
+        remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+// Offline transcription of recorded files (--batch): inputs, chunking and
+// SRT/WebVTT/JSONL output. The inference side lives in main.cpp.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class batch_format {
+    srt,
+    vtt,
+    jsonl,
+};
+
+bool parse_batch_format(const std::string & s, batch_format & out);
+const char * batch_format_extension(batch_format format);
+
+// --batch entries: audio paths, or "@FILE" for a list with one path per
+// line (blank lines and lines starting with '#' are skipped).
+bool expand_batch_inputs(const std::vector<std::string> & entries, std::vector<std::string> & out,
+                         std::string & error);
+
+// <stem>.<ext> in out_dir, or next to the input when out_dir is empty.
+std::string batch_output_path(const std::string & input, const std::string & out_dir, batch_format format);
+
+struct audio_chunk {
+    size_t begin = 0;   // samples
+    size_t end   = 0;
+};
+
+// Splits pcm into chunks of at most max_samples. Each chunk ends at the
+// quietest 20 ms frame within its last search_samples, so cuts land in
+// pauses rather than mid-word when there is one.
+std::vector<audio_chunk> plan_chunks(const std::vector<float> & pcm, size_t max_samples, size_t search_samples);
+
+struct batch_segment {
+    int64_t     start_ms = 0;
+    int64_t     end_ms   = 0;
+    std::string text;
+    std::string language;
+};
+
+// Applies the live pipeline's text filters in time order: empty segments,
+// repeats of the previous segment (normalize_for_dedup) and decoder loops
+// (should_drop_repetitive_text) are removed. Returns the number dropped.
+size_t filter_batch_segments(std::vector<batch_segment> & segments);
+
+// Written to a temporary file and renamed into place, so an interrupted
+// run never leaves a truncated transcript under the final name.
+bool write_batch_transcript(const std::string & path, batch_format format,
+                            const std::vector<batch_segment> & segments, std::string & error);
@@ -0,0 +1,82 @@
+#include "confidence_gate.h"
+
+#include <cmath>
+#include <cstdio>
+
+const char * gate_verdict_name(gate_verdict verdict) {
+    switch (verdict) {
+        case gate_verdict::emit:           return "emit";
+        case gate_verdict::no_speech:      return "no-speech";
+        case gate_verdict::low_confidence: return "low-confidence";
+    }
+    return "?";
+}
+
+float no_speech_prob_from_logits(const float * logits, int n_vocab, int nosp_token) {
+    if (!logits || n_vocab <= 0 || nosp_token < 0 || nosp_token >= n_vocab) return -1.0f;
+
+    float max_logit = -INFINITY;
+    for (int i = 0; i < n_vocab; ++i) {
+        if (logits[i] > max_logit) max_logit = logits[i];
+    }
+    if (!std::isfinite(max_logit)) return -1.0f;
+
+    double sum = 0.0;
+    for (int i = 0; i < n_vocab; ++i) {
+        sum += std::exp((double)(logits[i] - max_logit));
+    }
+    return (float)(std::exp((double)(logits[nosp_token] - max_logit)) / sum);
+}
+
+bool confidence_gate::should_stop_early(float no_speech_prob) const {
+    return no_speech_thold_ > 0.0f && no_speech_prob >= no_speech_thold_;
+}
+
+void confidence_gate::on_early_stop() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++steps_;
+    ++no_speech_;
+    ++early_stops_;
+}
+
+gate_verdict confidence_gate::judge(float no_speech_prob, float confidence) {
+    gate_verdict verdict = gate_verdict::emit;
+    if (no_speech_thold_ > 0.0f && no_speech_prob >= no_speech_thold_) {
+        verdict = gate_verdict::no_speech;
+    } else if (min_confidence_ > 0.0f && confidence >= 0.0f && confidence < min_confidence_) {
+        verdict = gate_verdict::low_confidence;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++steps_;
+    switch (verdict) {
+        case gate_verdict::emit:           ++emitted_;        break;
+        case gate_verdict::no_speech:      ++no_speech_;      break;
+        case gate_verdict::low_confidence: ++low_confidence_; break;
+    }
+    return verdict;
+}
+
+bool confidence_gate::allows_translation(float confidence) {
+    if (translate_min_confidence_ <= 0.0f || confidence < 0.0f || confidence >= translate_min_confidence_) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++translations_skipped_;
+    return false;
+}
+
+std::string confidence_gate::to_json() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+             "{\"no_speech_thold\":%.3f,\"min_confidence\":%.3f,\"translate_min_confidence\":%.3f",
+             no_speech_thold_, min_confidence_, translate_min_confidence_);
+    return std::string(buf) +
+           ",\"steps\":" + std::to_string(steps_) +
+           ",\"emitted\":" + std::to_string(emitted_) +
+           ",\"no_speech\":" + std::to_string(no_speech_) +
+           ",\"low_confidence\":" + std::to_string(low_confidence_) +
+           ",\"early_stops\":" + std::to_string(early_stops_) +
+           ",\"translations_skipped\":" + std::to_string(translations_skipped_) + "}";
+}
@@ -0,0 +1,77 @@
+// Confidence gating of decoded steps (--no-speech-thold, --min-confidence,
+// --translate-min-confidence).
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class gate_verdict {
+    emit,             // publish the text
+    no_speech,        // the model is confident the window holds no speech
+    low_confidence,   // mean token probability below --min-confidence
+};
+
+const char * gate_verdict_name(gate_verdict verdict);
+
+// Probability of the no-speech token under a softmax over one row of raw
+// decoder logits. -1 if the row or token is unusable.
+float no_speech_prob_from_logits(const float * logits, int n_vocab, int nosp_token);
+
+// Decides whether a decoded step is published and translated.
+//
+// The no-speech probability is known after the first decoder pass, before
+// any token is sampled, so a window the model already classifies as silence
+// can be aborted there (should_stop_early) instead of decoding up to
+// --max-tokens of hallucinated text. Whisper's own no_speech_thold only
+// drops such a segment once decoding has finished, and only together with a
+// low average log-probability; since the early stop sees no tokens yet, it
+// uses the probability alone with a stricter default threshold.
+//
+// Mean token probability (whisper_full_get_token_p over the text tokens)
+// serves as the step's confidence. Below --min-confidence the step is
+// dropped; below --translate-min-confidence it is published untranslated,
+// so garbled recognitions do not also cost a translation round trip.
+//
+// A threshold of 0 disables that check. Driven by the inference thread;
+// to_json() may be called from any thread.
+class confidence_gate {
+public:
+    confidence_gate(float no_speech_thold, float min_confidence, float translate_min_confidence)
+        : no_speech_thold_(no_speech_thold),
+          min_confidence_(min_confidence),
+          translate_min_confidence_(translate_min_confidence) {}
+
+    bool early_stop_enabled() const { return no_speech_thold_ > 0.0f; }
+
+    // Checked from the logits-filter callback of the first decoder pass.
+    bool should_stop_early(float no_speech_prob) const;
+
+    // A decode was aborted by should_stop_early().
+    void on_early_stop();
+
+    // no_speech_prob / confidence < 0 = unknown (that check passes).
+    gate_verdict judge(float no_speech_prob, float confidence);
+
+    // For an emitted step with a translation target. Counts the skips.
+    bool allows_translation(float confidence);
+
+    // {"no_speech_thold":..,"min_confidence":..,"translate_min_confidence":..,
+    //  "steps":..,"emitted":..,"no_speech":..,"low_confidence":..,
+    //  "early_stops":..,"translations_skipped":..}
+    std::string to_json() const;
+
+private:
+    const float no_speech_thold_;
+    const float min_confidence_;
+    const float translate_min_confidence_;
+
+    mutable std::mutex mtx_;
+    uint64_t steps_                = 0;
+    uint64_t emitted_              = 0;
+    uint64_t no_speech_            = 0;
+    uint64_t low_confidence_       = 0;
+    uint64_t early_stops_          = 0;
+    uint64_t translations_skipped_ = 0;
+};
@@ -0,0 +1,119 @@
+#include "cpu_affinity.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#else
+#include <sys/syscall.h>
+#endif
+
+bool parse_cpu_list(const char * raw, std::vector<int> & out) {
+    out.clear();
+    const std::string s = raw;
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        const size_t comma = std::min(s.find(',', pos), s.size());
+        const std::string item = s.substr(pos, comma - pos);
+        const size_t dash = item.find('-');
+
+        char * end = nullptr;
+        errno = 0;
+        const long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (errno != 0 || end == item.c_str() || first < 0) return false;
+        if (dash != std::string::npos) {
+            if (end != item.c_str() + dash) return false;
+            const char * second = item.c_str() + dash + 1;
+            last = std::strtol(second, &end, 10);
+            if (errno != 0 || end == second || last < first) return false;
+        }
+        if (*end != '\0' || last >= 1024) return false;
+
+        for (long cpu = first; cpu <= last; ++cpu) out.push_back((int)cpu);
+        pos = comma + 1;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return !out.empty();
+}
+
+std::string format_cpu_list(const std::vector<int> & cpus) {
+    std::string out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!out.empty()) out += ",";
+        out += std::to_string(cpus[i]);
+        if (j > i) out += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+bool pin_current_thread(const std::vector<int> & cpus, std::string & error) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        error = strerror(rc);
+        return false;
+    }
+    return true;
+#else
+    (void)cpus;
+    error = "thread affinity is not supported on this platform";
+    return false;
+#endif
+}
+
+bool raise_current_thread_priority(std::string & detail) {
+#if defined(__APPLE__)
+    const int rc = pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+    if (rc != 0) {
+        detail = strerror(rc);
+        return false;
+    }
+    detail = "QoS user-interactive";
+    return true;
+#elif defined(__linux__)
+    // Per-thread nice value on Linux; lowering it needs CAP_SYS_NICE or an
+    // RLIMIT_NICE allowance.
+    const int tid = (int)syscall(SYS_gettid);
+    if (setpriority(PRIO_PROCESS, (id_t)tid, -5) != 0) {
+        detail = strerror(errno);
+        return false;
+    }
+    detail = "nice -5";
+    return true;
+#else
+    detail = "not supported on this platform";
+    return false;
+#endif
+}
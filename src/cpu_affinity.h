@@ -0,0 +1,22 @@
+// CPU affinity and scheduling (--infer-cpus, --http-cpus, --capture-priority).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Parses "0-7,16,18-19" into sorted, unique CPU ids.
+bool parse_cpu_list(const char * raw, std::vector<int> & out);
+
+std::string format_cpu_list(const std::vector<int> & cpus);
+
+// CPUs this process may run on (empty where affinity is unsupported).
+std::vector<int> allowed_cpus();
+
+// Pins the calling thread. Threads it creates afterwards (httplib workers,
+// ggml compute threads, SDL's audio thread) inherit the mask on Linux.
+bool pin_current_thread(const std::vector<int> & cpus, std::string & error);
+
+// Raises the calling thread (and the threads it spawns later) above the
+// HTTP/service threads where the OS lets an unprivileged process do so.
+bool raise_current_thread_priority(std::string & detail);
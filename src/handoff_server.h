@@ -0,0 +1,66 @@
+// httplib::Server whose handlers can take over the connection socket
+// (/events handoff to sse_broadcaster).
+
+#pragma once
+
+#include "httplib.h"
+
+// httplib::Server that lets a request handler take ownership of the
+// connection socket. The /events route uses this to move the stream onto
+// the broadcaster thread once the response headers are out, so SSE viewers
+// don't hold thread-pool workers.
+class handoff_server : public httplib::Server {
+public:
+    // Only valid inside a handler/content provider. After this call the
+    // socket is neither shut down nor closed when the request completes.
+    static socket_t take_current_socket() {
+        t_socket_taken() = true;
+        return t_current_socket();
+    }
+
+private:
+    static socket_t & t_current_socket() {
+        static thread_local socket_t sock = INVALID_SOCKET;
+        return sock;
+    }
+
+    static bool & t_socket_taken() {
+        static thread_local bool taken = false;
+        return taken;
+    }
+
+    // Mirrors httplib::Server::process_and_close_socket, except for sockets
+    // taken by a handler.
+    bool process_and_close_socket(socket_t sock) override {
+        std::string remote_addr;
+        int remote_port = 0;
+        httplib::detail::get_remote_ip_and_port(sock, remote_addr, remote_port);
+
+        std::string local_addr;
+        int local_port = 0;
+        httplib::detail::get_local_ip_and_port(sock, local_addr, local_port);
+
+        t_current_socket() = sock;
+        t_socket_taken() = false;
+
+        const bool ret = httplib::detail::process_server_socket(
+            svr_sock_, sock, keep_alive_max_count_, keep_alive_timeout_sec_,
+            read_timeout_sec_, read_timeout_usec_, write_timeout_sec_,
+            write_timeout_usec_,
+            [&](httplib::Stream & strm, bool close_connection, bool & connection_closed) {
+                return process_request(strm, remote_addr, remote_port, local_addr,
+                                       local_port, close_connection, connection_closed,
+                                       nullptr);
+            });
+
+        const bool taken = t_socket_taken();
+        t_current_socket() = INVALID_SOCKET;
+        t_socket_taken() = false;
+
+        if (!taken) {
+            httplib::detail::shutdown_socket(sock);
+            httplib::detail::close_socket(sock);
+        }
+        return ret;
+    }
+};
@@ -0,0 +1,414 @@
+#include "json.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+std::string escape_json(const std::string & s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string json_str(const char * key, const std::string & value) {
+    return std::string("\"") + key + "\":\"" + escape_json(value) + "\"";
+}
+
+std::string json_bool(const char * key, bool value) {
+    return std::string("\"") + key + "\":" + (value ? "true" : "false");
+}
+
+static void json_skip_ws(const std::string & s, size_t & pos) {
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) {
+        ++pos;
+    }
+}
+
+static int hex_to_int(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void append_utf8(std::string & out, uint32_t cp) {
+    if (cp <= 0x7F) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp <= 0x7FF) {
+        out.push_back(static_cast<char>(0xC0 | ((cp >> 6) & 0x1F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp <= 0xFFFF) {
+        out.push_back(static_cast<char>(0xE0 | ((cp >> 12) & 0x0F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | ((cp >> 18) & 0x07)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+static bool parse_hex4(const std::string & s, size_t & pos, uint16_t & out) {
+    if (pos + 4 > s.size()) return false;
+    uint16_t val = 0;
+    for (int i = 0; i < 4; ++i) {
+        int x = hex_to_int(s[pos + i]);
+        if (x < 0) return false;
+        val = static_cast<uint16_t>((val << 4) | x);
+    }
+    pos += 4;
+    out = val;
+    return true;
+}
+
+bool parse_json_string_token(const std::string & s, size_t & pos, std::string & out) {
+    if (pos >= s.size() || s[pos] != '"') return false;
+
+    ++pos;
+    out.clear();
+
+    while (pos < s.size()) {
+        const char c = s[pos++];
+        if (c == '"') {
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+
+        if (pos >= s.size()) return false;
+        const char esc = s[pos++];
+        switch (esc) {
+            case '"':  out.push_back('"');  break;
+            case '\\': out.push_back('\\'); break;
+            case '/':  out.push_back('/');  break;
+            case 'b':  out.push_back('\b'); break;
+            case 'f':  out.push_back('\f'); break;
+            case 'n':  out.push_back('\n'); break;
+            case 'r':  out.push_back('\r'); break;
+            case 't':  out.push_back('\t'); break;
+            case 'u': {
+                uint16_t cu1 = 0;
+                if (!parse_hex4(s, pos, cu1)) return false;
+
+                uint32_t cp = cu1;
+                if (cu1 >= 0xD800 && cu1 <= 0xDBFF) {
+                    if (pos + 2 > s.size() || s[pos] != '\\' || s[pos + 1] != 'u') {
+                        return false;
+                    }
+                    pos += 2;
+                    uint16_t cu2 = 0;
+                    if (!parse_hex4(s, pos, cu2) || cu2 < 0xDC00 || cu2 > 0xDFFF) {
+                        return false;
+                    }
+                    cp = 0x10000 + (((uint32_t)cu1 - 0xD800) << 10) + ((uint32_t)cu2 - 0xDC00);
+                } else if (cu1 >= 0xDC00 && cu1 <= 0xDFFF) {
+                    return false;
+                }
+
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+static bool json_skip_value(const std::string & s, size_t & pos);
+
+static bool json_skip_object(const std::string & s, size_t & pos) {
+    if (pos >= s.size() || s[pos] != '{') return false;
+    ++pos;
+    json_skip_ws(s, pos);
+
+    if (pos < s.size() && s[pos] == '}') {
+        ++pos;
+        return true;
+    }
+
+    while (pos < s.size()) {
+        std::string ignored_key;
+        if (!parse_json_string_token(s, pos, ignored_key)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size() || s[pos] != ':') return false;
+        ++pos;
+        if (!json_skip_value(s, pos)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size()) return false;
+        if (s[pos] == ',') {
+            ++pos;
+            json_skip_ws(s, pos);
+            continue;
+        }
+        if (s[pos] == '}') {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    return false;
+}
+
+static bool json_skip_array(const std::string & s, size_t & pos) {
+    if (pos >= s.size() || s[pos] != '[') return false;
+    ++pos;
+    json_skip_ws(s, pos);
+
+    if (pos < s.size() && s[pos] == ']') {
+        ++pos;
+        return true;
+    }
+
+    while (pos < s.size()) {
+        if (!json_skip_value(s, pos)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size()) return false;
+        if (s[pos] == ',') {
+            ++pos;
+            json_skip_ws(s, pos);
+            continue;
+        }
+        if (s[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    return false;
+}
+
+static bool json_skip_primitive(const std::string & s, size_t & pos) {
+    const size_t start = pos;
+    while (pos < s.size()) {
+        const char c = s[pos];
+        if (c == ',' || c == '}' || c == ']' || std::isspace(static_cast<unsigned char>(c))) {
+            break;
+        }
+        ++pos;
+    }
+    return pos > start;
+}
+
+static bool json_skip_value(const std::string & s, size_t & pos) {
+    json_skip_ws(s, pos);
+    if (pos >= s.size()) return false;
+
+    if (s[pos] == '"') {
+        std::string ignored;
+        return parse_json_string_token(s, pos, ignored);
+    }
+    if (s[pos] == '{') return json_skip_object(s, pos);
+    if (s[pos] == '[') return json_skip_array(s, pos);
+
+    return json_skip_primitive(s, pos);
+}
+
+bool json_get_string_field(const std::string & s, const std::string & key, std::string & out) {
+    size_t pos = 0;
+    json_skip_ws(s, pos);
+    if (pos >= s.size() || s[pos] != '{') return false;
+    ++pos;
+    json_skip_ws(s, pos);
+
+    if (pos < s.size() && s[pos] == '}') return false;
+
+    bool found = false;
+    std::string found_value;
+
+    while (pos < s.size()) {
+        std::string name;
+        if (!parse_json_string_token(s, pos, name)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size() || s[pos] != ':') return false;
+        ++pos;
+        json_skip_ws(s, pos);
+
+        if (name == key) {
+            std::string value;
+            if (!parse_json_string_token(s, pos, value)) return false;
+            if (!found) {
+                found = true;
+                found_value = value;
+            }
+        } else {
+            if (!json_skip_value(s, pos)) return false;
+        }
+        json_skip_ws(s, pos);
+        if (pos >= s.size()) return false;
+
+        if (s[pos] == ',') {
+            ++pos;
+            json_skip_ws(s, pos);
+            continue;
+        }
+        if (s[pos] == '}') {
+            ++pos;
+            break;
+        }
+        return false;
+    }
+
+    if (!found) return false;
+
+    json_skip_ws(s, pos);
+    if (pos != s.size()) return false;
+
+    out = found_value;
+
+    return true;
+}
+
+bool parse_json_number_token(const std::string & s, size_t & pos, double & out) {
+    const size_t start = pos;
+    if (pos < s.size() && s[pos] == '-') ++pos;
+    if (pos >= s.size() || !std::isdigit(static_cast<unsigned char>(s[pos]))) return false;
+    if (s[pos] == '0') {
+        ++pos;
+    } else {
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+    if (pos < s.size() && s[pos] == '.') {
+        ++pos;
+        if (pos >= s.size() || !std::isdigit(static_cast<unsigned char>(s[pos]))) return false;
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+    if (pos < s.size() && (s[pos] == 'e' || s[pos] == 'E')) {
+        ++pos;
+        if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) ++pos;
+        if (pos >= s.size() || !std::isdigit(static_cast<unsigned char>(s[pos]))) return false;
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+
+    out = std::strtod(s.substr(start, pos - start).c_str(), nullptr);
+    return std::isfinite(out);
+}
+
+bool parse_config_update_payload(const std::string & s, config_update_payload & out) {
+    size_t pos = 0;
+    json_skip_ws(s, pos);
+    if (pos >= s.size() || s[pos] != '{') return false;
+    ++pos;
+    json_skip_ws(s, pos);
+
+    if (pos < s.size() && s[pos] == '}') return false;
+
+    while (pos < s.size()) {
+        std::string name;
+        if (!parse_json_string_token(s, pos, name)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size() || s[pos] != ':') return false;
+        ++pos;
+        json_skip_ws(s, pos);
+
+        if (name == "target_lang") {
+            if (!parse_json_string_token(s, pos, out.target_lang)) return false;
+            out.has_target_lang = true;
+        } else if (name == "source_lang") {
+            if (!parse_json_string_token(s, pos, out.source_lang)) return false;
+            out.has_source_lang = true;
+        } else if (config_update_payload::number_field * field = out.find_number_field(name)) {
+            if (!parse_json_number_token(s, pos, field->value)) return false;
+            field->has = true;
+        } else {
+            if (!json_skip_value(s, pos)) return false;
+        }
+
+        json_skip_ws(s, pos);
+        if (pos >= s.size()) return false;
+        if (s[pos] == ',') {
+            ++pos;
+            json_skip_ws(s, pos);
+            continue;
+        }
+        if (s[pos] == '}') {
+            ++pos;
+            break;
+        }
+        return false;
+    }
+
+    json_skip_ws(s, pos);
+    if (pos != s.size()) return false;
+
+    return out.has_target_lang || out.has_source_lang || out.has_number_field();
+}
+
+bool parse_latency_beacon_payload(const std::string & s, latency_beacon_payload & out) {
+    size_t pos = 0;
+    json_skip_ws(s, pos);
+    if (pos >= s.size() || s[pos] != '{') return false;
+    ++pos;
+    json_skip_ws(s, pos);
+
+    bool has_version = false;
+    bool has_receive = false;
+
+    while (pos < s.size()) {
+        std::string name;
+        if (!parse_json_string_token(s, pos, name)) return false;
+        json_skip_ws(s, pos);
+        if (pos >= s.size() || s[pos] != ':') return false;
+        ++pos;
+        json_skip_ws(s, pos);
+
+        if (name == "v" || name == "t") {
+            double value = 0.0;
+            if (!parse_json_number_token(s, pos, value) || value < 0.0) return false;
+            if (name == "v") {
+                out.version = (uint64_t)value;
+                has_version = true;
+            } else {
+                out.receive_ms = (int64_t)value;
+                has_receive = true;
+            }
+        } else {
+            if (!json_skip_value(s, pos)) return false;
+        }
+
+        json_skip_ws(s, pos);
+        if (pos >= s.size()) return false;
+        if (s[pos] == ',') {
+            ++pos;
+            json_skip_ws(s, pos);
+            continue;
+        }
+        if (s[pos] == '}') {
+            ++pos;
+            break;
+        }
+        return false;
+    }
+
+    json_skip_ws(s, pos);
+    if (pos != s.size()) return false;
+
+    return has_version && has_receive;
+}
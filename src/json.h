@@ -0,0 +1,69 @@
+// Minimal JSON building and parsing for the HTTP API: string escaping,
+// field builders and strict parsers for the few request bodies we accept.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+std::string escape_json(const std::string & s);
+
+// Build a JSON string field: "key":"escaped_value"
+std::string json_str(const char * key, const std::string & value);
+
+// Build a JSON bool field: "key":true/false
+std::string json_bool(const char * key, bool value);
+
+bool parse_json_string_token(const std::string & s, size_t & pos, std::string & out);
+
+bool json_get_string_field(const std::string & s, const std::string & key, std::string & out);
+
+// Parses a JSON number (RFC 8259 grammar) at pos.
+bool parse_json_number_token(const std::string & s, size_t & pos, double & out);
+
+struct config_update_payload {
+    bool has_target_lang = false;
+    bool has_source_lang = false;
+    std::string target_lang;
+    std::string source_lang;
+
+    // Runtime-tunable inference settings (range-checked by the handler).
+    struct number_field {
+        bool   has   = false;
+        double value = 0.0;
+    };
+    number_field step_ms;
+    number_field length_ms;
+    number_field threads;
+    number_field beam_size;
+    number_field max_tokens;
+    number_field temperature_inc;
+    number_field vad_thold;
+
+    number_field * find_number_field(const std::string & name) {
+        if (name == "step_ms")         return &step_ms;
+        if (name == "length_ms")       return &length_ms;
+        if (name == "threads")         return &threads;
+        if (name == "beam_size")       return &beam_size;
+        if (name == "max_tokens")      return &max_tokens;
+        if (name == "temperature_inc") return &temperature_inc;
+        if (name == "vad_thold")       return &vad_thold;
+        return nullptr;
+    }
+
+    bool has_number_field() const {
+        return step_ms.has || length_ms.has || threads.has || beam_size.has ||
+               max_tokens.has || temperature_inc.has || vad_thold.has;
+    }
+};
+
+bool parse_config_update_payload(const std::string & s, config_update_payload & out);
+
+struct latency_beacon_payload {
+    uint64_t version    = 0;
+    int64_t  receive_ms = 0;  // browser clock (Date.now())
+};
+
+// {"v":<frame version>,"t":<receive time in unix ms>}
+bool parse_latency_beacon_payload(const std::string & s, latency_beacon_payload & out);
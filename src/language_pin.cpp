@@ -0,0 +1,129 @@
+#include "language_pin.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool parse_lang_detect_mode(const std::string & s, lang_detect_mode & out) {
+    if (s == "step") {
+        out = lang_detect_mode::step;
+    } else if (s == "utterance") {
+        out = lang_detect_mode::utterance;
+    } else if (s == "pin") {
+        out = lang_detect_mode::pin;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char * lang_detect_mode_name(lang_detect_mode mode) {
+    switch (mode) {
+        case lang_detect_mode::step:      return "step";
+        case lang_detect_mode::utterance: return "utterance";
+        case lang_detect_mode::pin:       return "pin";
+    }
+    return "?";
+}
+
+const char * lang_redetect_reason_name(lang_redetect_reason reason) {
+    switch (reason) {
+        case lang_redetect_reason::initial:    return "initial";
+        case lang_redetect_reason::utterance:  return "utterance";
+        case lang_redetect_reason::interval:   return "interval";
+        case lang_redetect_reason::confidence: return "confidence";
+        case lang_redetect_reason::uncertain:  return "uncertain";
+    }
+    return "?";
+}
+
+lang_step language_pin::next_step(int64_t now_ms, lang_redetect_reason & reason) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!pending_ && redetect_ms_ > 0 && now_ms - pinned_at_ms_ >= redetect_ms_) {
+        pending_        = true;
+        pending_reason_ = lang_redetect_reason::interval;
+    }
+    if (!pending_) {
+        ++pinned_steps_;
+        return lang_step::pinned;
+    }
+    if (pending_reason_ == lang_redetect_reason::uncertain && now_ms < retry_at_ms_) {
+        ++uncertain_steps_;
+        return lang_step::automatic;
+    }
+    reason = pending_reason_;
+    return lang_step::identify;
+}
+
+bool language_pin::on_detected(const std::string & lang, float prob, lang_redetect_reason reason, int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++detections_;
+    ++redetects_[(size_t)reason];
+    if (lang.empty() || prob < min_prob_) {
+        if (reason == lang_redetect_reason::uncertain) {
+            backoff_ms_ = std::min(backoff_ms_ * 2, k_max_uncertain_backoff_ms);
+        } else {
+            backoff_ms_ = k_uncertain_backoff_ms;
+        }
+        pending_        = true;
+        pending_reason_ = lang_redetect_reason::uncertain;
+        retry_at_ms_    = now_ms + backoff_ms_;
+        return false;
+    }
+    pinned_            = lang;
+    pinned_prob_       = prob;
+    pinned_at_ms_      = now_ms;
+    decoded_since_pin_ = false;
+    pending_           = false;
+    return true;
+}
+
+void language_pin::on_decoded(float mean_token_p) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (pending_) return;
+    decoded_since_pin_ = true;
+    if (mean_token_p >= 0.0f && mean_token_p < k_drop_token_p) {
+        pending_        = true;
+        pending_reason_ = lang_redetect_reason::confidence;
+    }
+}
+
+void language_pin::on_silence() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    // Only after speech: the quiet steps between utterances don't queue
+    // another identification each.
+    if (mode_ == lang_detect_mode::utterance && !pending_ && decoded_since_pin_) {
+        pending_        = true;
+        pending_reason_ = lang_redetect_reason::utterance;
+    }
+}
+
+void language_pin::reset() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pinned_.clear();
+    pinned_prob_       = -1.0f;
+    decoded_since_pin_ = false;
+    pending_           = true;
+    pending_reason_    = lang_redetect_reason::initial;
+    retry_at_ms_       = 0;
+    backoff_ms_        = k_uncertain_backoff_ms;
+}
+
+std::string language_pin::to_json() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    char prob[32];
+    snprintf(prob, sizeof(prob), "%.3f", pinned_prob_);
+    std::string json = "{" + json_str("mode", lang_detect_mode_name(mode_)) +
+                       "," + json_str("pinned", pinned_) +
+                       ",\"prob\":" + prob +
+                       ",\"detections\":" + std::to_string(detections_) +
+                       ",\"pinned_steps\":" + std::to_string(pinned_steps_) +
+                       ",\"uncertain_steps\":" + std::to_string(uncertain_steps_) +
+                       ",\"redetects\":{";
+    for (size_t i = 0; i < redetects_.size(); ++i) {
+        if (i > 0) json += ",";
+        json += "\"" + std::string(lang_redetect_reason_name((lang_redetect_reason)i)) + "\":" +
+                std::to_string(redetects_[i]);
+    }
+    return json + "}}";
+}
@@ -0,0 +1,105 @@
+// Cached language identification for --language auto (--lang-detect).
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class lang_detect_mode {
+    step,        // whisper_full identifies the language on every step
+    utterance,   // identify at the start of each utterance, then pin
+    pin,         // identify once, re-identify only on interval or confidence drop
+};
+
+bool parse_lang_detect_mode(const std::string & s, lang_detect_mode & out);
+const char * lang_detect_mode_name(lang_detect_mode mode);
+
+// Why the language is (re-)identified.
+enum class lang_redetect_reason {
+    initial,      // nothing pinned yet (start, source or session change)
+    utterance,    // the VAD saw the previous utterance end
+    interval,     // the pin is older than --lang-redetect
+    confidence,   // decoding with the pinned language went badly
+    uncertain,    // the last identification was below --lang-min-prob
+};
+
+const char * lang_redetect_reason_name(lang_redetect_reason reason);
+
+// What the next step does with the source language.
+enum class lang_step {
+    pinned,     // decode with pinned()
+    identify,   // identify the language first
+    automatic,  // decode with "auto": whisper_full identifies it, as in step mode
+};
+
+// Decides when the main loop identifies the language and which language
+// the remaining steps decode with. Identification costs an extra encoder
+// pass plus a decoder pass over every candidate language, so outside the
+// step mode it runs once and the result is pinned until the utterance
+// ends, the interval runs out, or the mean token probability of a step
+// decoded with the pinned language drops below k_drop_token_p.
+//
+// An identification below --lang-min-prob pins nothing. Identifying again
+// on every step would cost more than the step mode, so the steps that
+// follow decode with "auto" (one whisper_full, identifying as it goes) and
+// identification is retried after a back-off that doubles on every
+// uncertain result, from k_uncertain_backoff_ms up to
+// k_max_uncertain_backoff_ms.
+//
+// Driven by the inference thread; to_json() may be called from any thread.
+class language_pin {
+public:
+    static constexpr float   k_drop_token_p             = 0.4f;
+    static constexpr int64_t k_uncertain_backoff_ms     = 2000;
+    static constexpr int64_t k_max_uncertain_backoff_ms = 30000;
+
+    language_pin(lang_detect_mode mode, int64_t redetect_ms, float min_prob)
+        : mode_(mode), redetect_ms_(redetect_ms), min_prob_(min_prob) {}
+
+    bool enabled() const { return mode_ != lang_detect_mode::step; }
+
+    // What the next step does; with lang_step::identify, `reason` says why.
+    lang_step next_step(int64_t now_ms, lang_redetect_reason & reason);
+
+    const std::string & pinned() const { return pinned_; }
+    float pinned_prob() const { return pinned_prob_; }
+
+    // Result of an identification. Returns false when prob was too low to
+    // pin (steps decode with "auto" until the back-off ends).
+    bool on_detected(const std::string & lang, float prob, lang_redetect_reason reason, int64_t now_ms);
+
+    // A step decoded with the pinned language; mean_token_p < 0 = no tokens.
+    void on_decoded(float mean_token_p);
+
+    // The VAD dropped a step.
+    void on_silence();
+
+    // Source language or session changed.
+    void reset();
+
+    // {"mode":..,"pinned":..,"prob":..,"detections":..,"pinned_steps":..,
+    //  "uncertain_steps":..,"redetects":{..}}
+    std::string to_json() const;
+
+private:
+    const lang_detect_mode mode_;
+    const int64_t          redetect_ms_;
+    const float            min_prob_;
+
+    mutable std::mutex mtx_;
+    std::string        pinned_;
+    float              pinned_prob_    = -1.0f;
+    int64_t            pinned_at_ms_   = 0;
+    bool               decoded_since_pin_ = false;
+    bool               pending_        = true;
+    lang_redetect_reason pending_reason_ = lang_redetect_reason::initial;
+    int64_t            retry_at_ms_    = 0;   // uncertain: identify again from here on
+    int64_t            backoff_ms_     = k_uncertain_backoff_ms;
+
+    uint64_t                detections_      = 0;
+    uint64_t                pinned_steps_    = 0;
+    uint64_t                uncertain_steps_ = 0;
+    std::array<uint64_t, 5> redetects_    = {};
+};
@@ -0,0 +1,62 @@
+#include "latency_metrics.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+
+void latency_window::add(double ms) {
+    if (samples_.size() < k_capacity) {
+        samples_.push_back(ms);
+    } else {
+        samples_[next_] = ms;
+    }
+    next_ = (next_ + 1) % k_capacity;
+    ++count_;
+}
+
+std::string latency_window::to_json() const {
+    if (samples_.empty()) {
+        return "{\"count\":0}";
+    }
+    std::vector<double> sorted = samples_;
+    std::sort(sorted.begin(), sorted.end());
+    auto pct = [&](double p) {
+        const size_t idx = std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5));
+        return sorted[idx];
+    };
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"count\":%llu,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f}",
+             (unsigned long long)count_, pct(0.50), pct(0.90), pct(0.99), sorted.back());
+    return buf;
+}
+
+void latency_tracker::record_published(uint64_t version, const segment_timing & t) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capture_to_infer_.add((double)(t.infer_start_ms - t.capture_ms));
+    infer_.add((double)(t.infer_end_ms - t.infer_start_ms));
+    translate_.add((double)(t.translated_ms - t.infer_end_ms));
+    capture_to_publish_.add((double)(t.publish_ms - t.capture_ms));
+    recent_[version % recent_.size()] = {version, t};
+}
+
+bool latency_tracker::record_beacon(uint64_t version, int64_t client_receive_ms) {
+    const int64_t arrival_ms = unix_time_ms();
+    std::lock_guard<std::mutex> lock(mtx_);
+    const auto & slot = recent_[version % recent_.size()];
+    if (slot.first != version || version == 0) {
+        return false;
+    }
+    capture_to_receive_.add((double)(client_receive_ms - slot.second.capture_ms));
+    capture_to_beacon_.add((double)(arrival_ms - slot.second.capture_ms));
+    return true;
+}
+
+std::string latency_tracker::to_json() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return "{\"capture_to_infer_ms\":"   + capture_to_infer_.to_json() +
+           ",\"infer_ms\":"              + infer_.to_json() +
+           ",\"translate_ms\":"          + translate_.to_json() +
+           ",\"capture_to_publish_ms\":" + capture_to_publish_.to_json() +
+           ",\"capture_to_receive_ms\":" + capture_to_receive_.to_json() +
+           ",\"capture_to_beacon_ms\":"  + capture_to_beacon_.to_json() + "}";
+}
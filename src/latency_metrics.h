@@ -0,0 +1,56 @@
+// Rolling latency percentiles per pipeline stage (/api/latency).
+
+#pragma once
+
+#include "subtitle_events.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Rolling window of the most recent samples of one latency (ms).
+class latency_window {
+public:
+    static constexpr size_t k_capacity = 2048;
+
+    void add(double ms);
+
+    // {"count":N,"p50":..,"p90":..,"p99":..,"max":..}
+    std::string to_json() const;
+
+private:
+    std::vector<double> samples_;
+    size_t              next_  = 0;
+    uint64_t            count_ = 0;
+};
+
+// Per-stage latency percentiles. Stage latencies are recorded when a frame
+// is published; delivery latencies come from viewer beacons, matched to
+// the frame's timing through a small ring of recently published versions.
+//
+// capture_to_receive uses the browser clock and is only meaningful when
+// viewer and server clocks agree (same host or NTP-synced);
+// capture_to_beacon uses the server clock and includes the beacon's uplink.
+class latency_tracker {
+public:
+    void record_published(uint64_t version, const segment_timing & t);
+
+    // Returns false for versions that are unknown or too old.
+    bool record_beacon(uint64_t version, int64_t client_receive_ms);
+
+    std::string to_json() const;
+
+private:
+    mutable std::mutex mtx_;
+    latency_window capture_to_infer_;
+    latency_window infer_;
+    latency_window translate_;
+    latency_window capture_to_publish_;
+    latency_window capture_to_receive_;
+    latency_window capture_to_beacon_;
+    std::array<std::pair<uint64_t, segment_timing>, 256> recent_ = {};
+};
@@ -0,0 +1,280 @@
+#include "logger.h"
+#include "json.h"
+#include "spsc_ring.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+std::atomic<int> g_log_min_level{(int)log_level::info};
+
+namespace {
+
+// A step logs a handful of lines, so a ring this size only fills when the
+// writer has been blocked on stderr for many seconds.
+constexpr size_t  k_ring_records      = 1024;
+constexpr int64_t k_drain_interval_ms = 20;
+constexpr size_t  k_max_message       = 2048;
+
+struct log_record {
+    int64_t      ts_ms      = 0;
+    log_level    level      = log_level::info;
+    const char * src        = nullptr;
+    uint32_t     suppressed = 0;
+    std::string  msg;
+};
+
+struct thread_buffer {
+    thread_buffer() : ring(k_ring_records) {}
+
+    spsc_ring<log_record> ring;   // owning thread -> writer
+};
+
+std::atomic<int>      g_format{(int)log_format::text};
+std::atomic<bool>     g_async{false};
+std::atomic<uint64_t> g_written{0};
+std::atomic<uint64_t> g_dropped{0};
+std::atomic<uint64_t> g_suppressed{0};
+
+// Buffers live until exit: a thread may still hold its pointer after
+// log_stop().
+std::mutex                                  g_registry_mtx;
+std::vector<std::unique_ptr<thread_buffer>> g_buffers;
+
+// Writer state.
+std::thread             g_writer;
+std::atomic<bool>       g_writer_running{false};
+std::mutex              g_wait_mtx;
+std::condition_variable g_cv;
+uint64_t                g_reported_dropped = 0;
+
+// Synchronous writes (before log_start, after log_stop) from several
+// threads must not interleave within a line.
+std::mutex g_sync_mtx;
+
+thread_local thread_buffer * t_buffer = nullptr;
+
+thread_buffer * buffer_for_this_thread() {
+    if (!t_buffer) {
+        std::lock_guard<std::mutex> lock(g_registry_mtx);
+        g_buffers.push_back(std::make_unique<thread_buffer>());
+        t_buffer = g_buffers.back().get();
+    }
+    return t_buffer;
+}
+
+std::string format_record(const log_record & r) {
+    if ((log_format)g_format.load(std::memory_order_relaxed) == log_format::json) {
+        std::string line = "{\"ts\":" + std::to_string(r.ts_ms) +
+                           ",\"level\":\"" + log_level_name(r.level) + "\"";
+        if (r.src) line += "," + json_str("src", r.src);
+        line += "," + json_str("msg", r.msg);
+        if (r.suppressed > 0) line += ",\"suppressed\":" + std::to_string(r.suppressed);
+        line += "}\n";
+        return line;
+    }
+
+    std::string line;
+    if (r.level == log_level::warn)  line += "warning: ";
+    if (r.level == log_level::error) line += "error: ";
+    if (r.src) {
+        line += r.src;
+        line += ": ";
+    }
+    line += r.msg;
+    if (r.suppressed > 0) line += " (" + std::to_string(r.suppressed) + " similar suppressed)";
+    line += '\n';
+    return line;
+}
+
+void write_record(const log_record & r) {
+    const std::string line = format_record(r);
+    fwrite(line.data(), 1, line.size(), stderr);
+    g_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void drain_all() {
+    std::vector<thread_buffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mtx);
+        for (const auto & b : g_buffers) buffers.push_back(b.get());
+    }
+    // Records from different threads are written ring by ring; within a
+    // drain interval cross-thread order is approximate, which the
+    // timestamps in JSON output make up for.
+    log_record r;
+    for (thread_buffer * b : buffers) {
+        while (b->ring.try_pop(r)) {
+            write_record(r);
+        }
+    }
+
+    const uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+    if (dropped != g_reported_dropped) {
+        log_record note;
+        note.ts_ms = unix_time_ms();
+        note.level = log_level::warn;
+        note.src   = "log";
+        note.msg   = std::to_string(dropped - g_reported_dropped) + " messages dropped (queue full)";
+        g_reported_dropped = dropped;
+        write_record(note);
+    }
+}
+
+void run_writer() {
+    while (true) {
+        const bool keep_running = g_writer_running.load();
+        drain_all();
+        fflush(stderr);
+        if (!keep_running) break;
+
+        std::unique_lock<std::mutex> lock(g_wait_mtx);
+        g_cv.wait_for(lock, std::chrono::milliseconds(k_drain_interval_ms));
+    }
+}
+
+void submit(log_level level, const char * src, uint32_t suppressed, const char * fmt, va_list args) {
+    log_record r;
+    r.ts_ms      = unix_time_ms();
+    r.level      = level;
+    r.src        = src;
+    r.suppressed = suppressed;
+
+    char buf[k_max_message];
+    const int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    if (n < 0) return;
+    r.msg.assign(buf, std::min((size_t)n, sizeof(buf) - 1));
+
+    if (g_async.load(std::memory_order_acquire)) {
+        if (!buffer_for_this_thread()->ring.try_push(std::move(r))) {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_sync_mtx);
+    write_record(r);
+}
+
+} // namespace
+
+const char * log_level_name(log_level level) {
+    switch (level) {
+        case log_level::debug: return "debug";
+        case log_level::info:  return "info";
+        case log_level::warn:  return "warn";
+        case log_level::error: return "error";
+    }
+    return "info";
+}
+
+bool parse_log_level(const std::string & s, log_level & out) {
+    if (s == "debug") {
+        out = log_level::debug;
+    } else if (s == "info") {
+        out = log_level::info;
+    } else if (s == "warn") {
+        out = log_level::warn;
+    } else if (s == "error") {
+        out = log_level::error;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse_log_format(const std::string & s, log_format & out) {
+    if (s == "text") {
+        out = log_format::text;
+    } else if (s == "json") {
+        out = log_format::json;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void log_configure(log_level min_level, log_format format) {
+    g_log_min_level.store((int)min_level, std::memory_order_relaxed);
+    g_format.store((int)format, std::memory_order_relaxed);
+}
+
+void log_start() {
+    if (g_writer_running.exchange(true)) return;
+    {
+        // Anything written synchronously so far reaches stderr first.
+        std::lock_guard<std::mutex> lock(g_sync_mtx);
+        fflush(stderr);
+    }
+    g_writer = std::thread(run_writer);
+    g_async.store(true, std::memory_order_release);
+}
+
+void log_stop() {
+    if (!g_async.exchange(false)) return;
+
+    // A thread that saw g_async just before the exchange may push after the
+    // final drain; such a message is lost, as on a full ring.
+    g_writer_running = false;
+    g_cv.notify_one();
+    if (g_writer.joinable()) g_writer.join();
+}
+
+void log_write(log_level level, const char * src, const char * fmt, ...) {
+    if (!log_enabled(level)) return;
+    va_list args;
+    va_start(args, fmt);
+    submit(level, src, 0, fmt, args);
+    va_end(args);
+}
+
+bool log_limiter::allow(uint32_t & suppressed) {
+    const int64_t now   = unix_time_ms();
+    int64_t       start = window_start_ms_.load(std::memory_order_relaxed);
+    if (start < 0 || now - start >= interval_ms_) {
+        if (window_start_ms_.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            in_window_.store(0, std::memory_order_relaxed);
+        }
+    }
+    if (in_window_.fetch_add(1, std::memory_order_relaxed) >= burst_) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        g_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+void log_write_limited(log_limiter & limiter, log_level level, const char * src, const char * fmt, ...) {
+    if (!log_enabled(level)) return;
+    uint32_t suppressed = 0;
+    if (!limiter.allow(suppressed)) return;
+    va_list args;
+    va_start(args, fmt);
+    submit(level, src, suppressed, fmt, args);
+    va_end(args);
+}
+
+uint64_t log_written_count() {
+    return g_written.load(std::memory_order_relaxed);
+}
+
+uint64_t log_dropped_count() {
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t log_suppressed_count() {
+    return g_suppressed.load(std::memory_order_relaxed);
+}
+
+std::string log_stats_json() {
+    return "{\"written\":" + std::to_string(log_written_count()) +
+           ",\"dropped\":" + std::to_string(log_dropped_count()) +
+           ",\"suppressed\":" + std::to_string(log_suppressed_count()) + "}";
+}
@@ -0,0 +1,93 @@
+// Asynchronous structured logging of runtime events (--log-level, --log-format).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// The main loop logs every emitted segment, filter drop and VAD decision.
+// When stderr is a pipe or journald a synchronous write can block for
+// milliseconds, so once log_start() has run a message is formatted on the
+// calling thread and pushed into that thread's lock-free ring; a writer
+// thread drains the rings to stderr. A full ring drops the message and
+// counts it instead of blocking. Before log_start() and after log_stop()
+// messages are written synchronously, so startup errors and offline modes
+// need no writer.
+//
+// Text output is "source: message" (warnings and errors prefixed as
+// before); JSON output is one object per line:
+//   {"ts":<unix ms>,"level":"info","src":"filter","msg":"...","suppressed":N}
+
+enum class log_level {
+    debug = 0,
+    info,
+    warn,
+    error,
+};
+
+enum class log_format {
+    text,
+    json,
+};
+
+const char * log_level_name(log_level level);
+
+bool parse_log_level(const std::string & s, log_level & out);
+bool parse_log_format(const std::string & s, log_format & out);
+
+extern std::atomic<int> g_log_min_level;
+
+inline bool log_enabled(log_level level) {
+    return (int)level >= g_log_min_level.load(std::memory_order_relaxed);
+}
+
+// Sets the level and format; messages below `min_level` are discarded at
+// the call site. May be called before log_start().
+void log_configure(log_level min_level, log_format format);
+
+// Starts the writer. Call once the threads that log are about to start.
+void log_start();
+
+// Drains every ring and stops the writer; later messages are synchronous.
+void log_stop();
+
+// `src` is a static string naming the subsystem ("vad", "filter", ...);
+// nullptr writes the message alone (subtitle lines).
+void log_write(log_level level, const char * src, const char * fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+// At most `burst` messages per `interval_ms` from one call site; the rest
+// are counted and reported with the next message that gets through. Used
+// for sources that repeat every step, such as VAD skips.
+class log_limiter {
+public:
+    log_limiter(int burst, int64_t interval_ms) : burst_(burst), interval_ms_(interval_ms) {}
+
+    // True when a message may be written now; `suppressed` is the number
+    // dropped since the previous one.
+    bool allow(uint32_t & suppressed);
+
+private:
+    const int             burst_;
+    const int64_t         interval_ms_;
+    std::atomic<int64_t>  window_start_ms_{-1};
+    std::atomic<int>      in_window_{0};
+    std::atomic<uint32_t> suppressed_{0};
+};
+
+void log_write_limited(log_limiter & limiter, log_level level, const char * src, const char * fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 4, 5)))
+#endif
+    ;
+
+uint64_t log_written_count();
+uint64_t log_dropped_count();
+uint64_t log_suppressed_count();
+
+// {"written":..,"dropped":..,"suppressed":..}
+std::string log_stats_json();
@@ -7,18 +7,47 @@
 #include "whisper.h"
 #include "ggml-backend.h"
 #include "httplib.h"
+#include "adaptive_beam.h"
+#include "audio_filter.h"
+#include "audio_recorder.h"
+#include "audio_source.h"
+#include "batch_transcript.h"
+#include "confidence_gate.h"
+#include "cpu_affinity.h"
+#include "handoff_server.h"
+#include "json.h"
+#include "language_pin.h"
+#include "latency_metrics.h"
+#include "logger.h"
+#include "model_file.h"
+#include "params.h"
+#include "sse_broadcaster.h"
+#include "subtitle_events.h"
+#include "text_filter.h"
+#include "trace.h"
+#include "transcript_log.h"
+#include "transcript_stitcher.h"
+#include "translator.h"
+#include "util.h"
+#include "vad_gate.h"
+#include "web_assets.h"
+#include "work_stealing_queue.h"
+#include "worker_channel.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
+#include <condition_variable>
 #include <cctype>
 #include <cstdint>
 #include <cmath>
-#include <condition_variable>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -28,656 +57,24 @@
 #include <unordered_set>
 #include <vector>
 
-// ---------------------------------------------------------------------------
-// Embedded HTML (web/index.html)
-// ---------------------------------------------------------------------------
-
-static const char * const INDEX_HTML = R"html(<!DOCTYPE html>
-<html lang="ko">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>Live Subtitle</title>
-    <style>
-        * { margin: 0; padding: 0; box-sizing: border-box; }
-        body {
-            background: #00ff00;
-            color: #fff;
-            font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', system-ui, sans-serif;
-            height: 100vh;
-            display: flex;
-            flex-direction: column;
-            justify-content: flex-end;
-            align-items: center;
-            padding: 2rem;
-            overflow: hidden;
-        }
-        #subtitle-container {
-            text-align: center;
-            max-width: 92%;
-            transition: opacity 0.35s ease;
-        }
-        #subtitle {
-            font-size: 2.7rem;
-            font-weight: 700;
-            line-height: 1.35;
-            word-wrap: break-word;
-            white-space: pre-wrap;
-            text-shadow:
-                -2px -2px 0 rgba(0, 0, 0, 0.95),
-                 2px -2px 0 rgba(0, 0, 0, 0.95),
-                -2px  2px 0 rgba(0, 0, 0, 0.95),
-                 2px  2px 0 rgba(0, 0, 0, 0.95),
-                 0    0   8px rgba(0, 0, 0, 0.9);
-        }
-        #original {
-            display: none;
-            margin-top: 0.45rem;
-            font-size: 1.1rem;
-            line-height: 1.35;
-            opacity: 0.82;
-            word-wrap: break-word;
-            text-shadow: 0 0 6px rgba(0, 0, 0, 0.9);
-        }
-        #original.show-original {
-            display: block;
-        }
-        #language-badge {
-            display: none;
-            margin-bottom: 0.55rem;
-            padding: 0.2rem 0.55rem;
-            border-radius: 6px;
-            font-size: 0.78rem;
-            background: rgba(0, 0, 0, 0.55);
-            border: 1px solid rgba(255, 255, 255, 0.35);
-        }
-        #status {
-            display: none;
-            position: fixed;
-            top: 1rem;
-            right: 1rem;
-            font-size: 0.82rem;
-            text-shadow: 0 0 6px rgba(0, 0, 0, 0.9);
-        }
-        #settings-panel {
-            display: none;
-            position: fixed;
-            top: 1rem;
-            left: 1rem;
-            min-width: 235px;
-            padding: 0.75rem;
-            border-radius: 9px;
-            background: rgba(0, 0, 0, 0.55);
-            border: 1px solid rgba(255, 255, 255, 0.35);
-            backdrop-filter: blur(4px);
-            gap: 0.6rem;
-            flex-direction: column;
-        }
-        .settings-row {
-            display: flex;
-            flex-direction: column;
-            gap: 0.22rem;
-        }
-        .settings-row label {
-            font-size: 0.78rem;
-            opacity: 0.9;
-        }
-        .settings-row select {
-            background: rgba(20, 20, 20, 0.8);
-            color: #fff;
-            border: 1px solid rgba(255, 255, 255, 0.35);
-            border-radius: 6px;
-            padding: 0.4rem 0.48rem;
-            font-size: 0.86rem;
-            outline: none;
-        }
-        .settings-row select option {
-            background: #111;
-            color: #fff;
-        }
-        body.settings-mode #status { display: block; }
-        body.settings-mode #settings-panel { display: flex; }
-        body.settings-mode #language-badge { display: inline-block; }
-        .connected { color: #4ade80; }
-        .disconnected { color: #f87171; }
-        .fade { opacity: 0.26; }
-        @media (max-width: 920px) {
-            body { padding: 1rem; }
-            #subtitle { font-size: 1.95rem; }
-            #settings-panel { min-width: 190px; padding: 0.55rem; }
-        }
-    </style>
-</head>
-<body>
-    <div id="status" class="disconnected">&#9679; Disconnected</div>
-    <div id="settings-panel">
-        <div class="settings-row">
-            <label for="source-lang-select">Source language</label>
-            <select id="source-lang-select"><option value="ko">Loading...</option></select>
-        </div>
-        <div class="settings-row" id="target-lang-row">
-            <label for="target-lang-select">Translate to</label>
-            <select id="target-lang-select"><option value="">Translate off</option></select>
-        </div>
-    </div>
-    <div id="subtitle-container">
-        <div id="language-badge"></div>
-        <div id="subtitle"></div>
-        <div id="original"></div>
-    </div>
-    <script>
-        const subtitle = document.getElementById('subtitle');
-        const original = document.getElementById('original');
-        const langBadge = document.getElementById('language-badge');
-        const container = document.getElementById('subtitle-container');
-        const status = document.getElementById('status');
-        const sourceLangSelect = document.getElementById('source-lang-select');
-        const targetLangSelect = document.getElementById('target-lang-select');
-        const targetLangRow = document.getElementById('target-lang-row');
-        const settingsMode = new URLSearchParams(window.location.search).get('settings') === '1';
-        if (settingsMode) {
-            document.body.classList.add('settings-mode');
-        }
-        let fadeTimer = null;
-        let translateEnabled = false;
-
-        function clearSelectOptions(select) {
-            while (select.firstChild) select.removeChild(select.firstChild);
-        }
-
-        function addOption(select, value, text) {
-            const opt = document.createElement('option');
-            opt.value = value;
-            opt.textContent = text;
-            select.appendChild(opt);
-        }
-
-        async function postConfig(patch) {
-            await fetch('/api/config', {
-                method: 'POST',
-                headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify(patch)
-            });
-        }
-
-        async function loadSourceLanguages(selected) {
-            const res = await fetch('/api/source-languages');
-            const languages = await res.json();
-            clearSelectOptions(sourceLangSelect);
-            if (!Array.isArray(languages) || !languages.length) {
-                addOption(sourceLangSelect, 'ko', 'Korean');
-            } else {
-                for (const lang of languages) {
-                    addOption(sourceLangSelect, lang.code, lang.name);
-                }
-            }
-            sourceLangSelect.value = selected || sourceLangSelect.value || 'ko';
-        }
-
-        async function loadTargetLanguages(selected) {
-            if (!translateEnabled) {
-                targetLangRow.style.display = 'none';
-                return;
-            }
-
-            targetLangRow.style.display = 'flex';
-            const langRes = await fetch('/api/languages');
-            const languages = await langRes.json();
-
-            clearSelectOptions(targetLangSelect);
-            addOption(targetLangSelect, '', 'Translate off');
-            if (Array.isArray(languages)) {
-                for (const lang of languages) {
-                    addOption(targetLangSelect, lang.code, lang.name);
-                }
-            }
-            targetLangSelect.value = selected || '';
-        }
-
-        async function loadSettings() {
-            if (!settingsMode) return;
-
-            try {
-                const res = await fetch('/api/config');
-                const cfg = await res.json();
-                translateEnabled = !!cfg.translate_enabled;
-                await loadSourceLanguages(cfg.source_lang || 'ko');
-                await loadTargetLanguages(cfg.target_lang || '');
-            } catch (e) {
-                targetLangRow.style.display = 'none';
-            }
-        }
-
-        sourceLangSelect.addEventListener('change', async () => {
-            try {
-                await postConfig({source_lang: sourceLangSelect.value});
-            } catch (e) { /* ignore */ }
-        });
-
-        targetLangSelect.addEventListener('change', async () => {
-            try {
-                await postConfig({target_lang: targetLangSelect.value});
-            } catch (e) { /* ignore */ }
-        });
-
-        function connect() {
-            const es = new EventSource('/events');
-
-            es.onopen = () => {
-                status.textContent = '\u25CF Connected';
-                status.className = 'connected';
-            };
-
-            es.onmessage = (event) => {
-                try {
-                    const data = JSON.parse(event.data);
-                    if (data.text) {
-                        if (data.translated) {
-                            subtitle.textContent = data.translated;
-                            original.textContent = data.text || '';
-                            if (settingsMode && original.textContent) {
-                                original.classList.add('show-original');
-                            }
-                        } else {
-                            subtitle.textContent = data.text;
-                            original.textContent = '';
-                            original.classList.remove('show-original');
-                        }
-
-                        if (data.language) {
-                            langBadge.textContent = data.language.toUpperCase();
-                        }
-
-                        container.classList.remove('fade');
-                        if (fadeTimer) clearTimeout(fadeTimer);
-                        fadeTimer = setTimeout(() => {
-                            container.classList.add('fade');
-                        }, 5000);
-                    }
-                } catch (e) { /* ignore parse errors */ }
-            };
+#include <signal.h>
+#include <sys/wait.h>
 
-            es.onerror = () => {
-                status.textContent = '\u25CF Disconnected';
-                status.className = 'disconnected';
-                es.close();
-                setTimeout(connect, 2000);
-            };
-        }
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
 
-        loadSettings();
-        connect();
-    </script>
-</body>
-</html>)html";
+static_assert(WHISPER_SAMPLE_RATE == k_sample_rate, "pipeline components assume whisper's sample rate");
 
 // ---------------------------------------------------------------------------
 // Utilities
 // ---------------------------------------------------------------------------
 
-static std::string escape_json(const std::string & s) {
-    std::string out;
-    out.reserve(s.size());
-    for (char c : s) {
-        switch (c) {
-            case '"':  out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\n': out += "\\n";  break;
-            case '\r': out += "\\r";  break;
-            case '\t': out += "\\t";  break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    char buf[8];
-                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
-                    out += buf;
-                } else {
-                    out += c;
-                }
-        }
-    }
-    return out;
-}
-
-// Build a JSON string field: "key":"escaped_value"
-static std::string json_str(const char * key, const std::string & value) {
-    return std::string("\"") + key + "\":\"" + escape_json(value) + "\"";
-}
-
-// Build a JSON bool field: "key":true/false
-static std::string json_bool(const char * key, bool value) {
-    return std::string("\"") + key + "\":" + (value ? "true" : "false");
-}
-
-static void json_skip_ws(const std::string & s, size_t & pos) {
-    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) {
-        ++pos;
-    }
-}
-
-static int hex_to_int(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return -1;
-}
-
-static void append_utf8(std::string & out, uint32_t cp) {
-    if (cp <= 0x7F) {
-        out.push_back(static_cast<char>(cp));
-    } else if (cp <= 0x7FF) {
-        out.push_back(static_cast<char>(0xC0 | ((cp >> 6) & 0x1F)));
-        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
-    } else if (cp <= 0xFFFF) {
-        out.push_back(static_cast<char>(0xE0 | ((cp >> 12) & 0x0F)));
-        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
-        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
-    } else {
-        out.push_back(static_cast<char>(0xF0 | ((cp >> 18) & 0x07)));
-        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
-        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
-        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
-    }
-}
-
-static bool parse_hex4(const std::string & s, size_t & pos, uint16_t & out) {
-    if (pos + 4 > s.size()) return false;
-    uint16_t val = 0;
-    for (int i = 0; i < 4; ++i) {
-        int x = hex_to_int(s[pos + i]);
-        if (x < 0) return false;
-        val = static_cast<uint16_t>((val << 4) | x);
-    }
-    pos += 4;
-    out = val;
-    return true;
-}
-
-static bool parse_json_string_token(const std::string & s, size_t & pos, std::string & out) {
-    if (pos >= s.size() || s[pos] != '"') return false;
-
-    ++pos;
-    out.clear();
-
-    while (pos < s.size()) {
-        const char c = s[pos++];
-        if (c == '"') {
-            return true;
-        }
-        if (static_cast<unsigned char>(c) < 0x20) {
-            return false;
-        }
-        if (c != '\\') {
-            out.push_back(c);
-            continue;
-        }
-
-        if (pos >= s.size()) return false;
-        const char esc = s[pos++];
-        switch (esc) {
-            case '"':  out.push_back('"');  break;
-            case '\\': out.push_back('\\'); break;
-            case '/':  out.push_back('/');  break;
-            case 'b':  out.push_back('\b'); break;
-            case 'f':  out.push_back('\f'); break;
-            case 'n':  out.push_back('\n'); break;
-            case 'r':  out.push_back('\r'); break;
-            case 't':  out.push_back('\t'); break;
-            case 'u': {
-                uint16_t cu1 = 0;
-                if (!parse_hex4(s, pos, cu1)) return false;
-
-                uint32_t cp = cu1;
-                if (cu1 >= 0xD800 && cu1 <= 0xDBFF) {
-                    if (pos + 2 > s.size() || s[pos] != '\\' || s[pos + 1] != 'u') {
-                        return false;
-                    }
-                    pos += 2;
-                    uint16_t cu2 = 0;
-                    if (!parse_hex4(s, pos, cu2) || cu2 < 0xDC00 || cu2 > 0xDFFF) {
-                        return false;
-                    }
-                    cp = 0x10000 + (((uint32_t)cu1 - 0xD800) << 10) + ((uint32_t)cu2 - 0xDC00);
-                } else if (cu1 >= 0xDC00 && cu1 <= 0xDFFF) {
-                    return false;
-                }
-
-                append_utf8(out, cp);
-                break;
-            }
-            default:
-                return false;
-        }
-    }
-
-    return false;
-}
-
-static bool json_skip_value(const std::string & s, size_t & pos);
-
-static bool json_skip_object(const std::string & s, size_t & pos) {
-    if (pos >= s.size() || s[pos] != '{') return false;
-    ++pos;
-    json_skip_ws(s, pos);
-
-    if (pos < s.size() && s[pos] == '}') {
-        ++pos;
-        return true;
-    }
-
-    while (pos < s.size()) {
-        std::string ignored_key;
-        if (!parse_json_string_token(s, pos, ignored_key)) return false;
-        json_skip_ws(s, pos);
-        if (pos >= s.size() || s[pos] != ':') return false;
-        ++pos;
-        if (!json_skip_value(s, pos)) return false;
-        json_skip_ws(s, pos);
-        if (pos >= s.size()) return false;
-        if (s[pos] == ',') {
-            ++pos;
-            json_skip_ws(s, pos);
-            continue;
-        }
-        if (s[pos] == '}') {
-            ++pos;
-            return true;
-        }
-        return false;
-    }
-
-    return false;
-}
-
-static bool json_skip_array(const std::string & s, size_t & pos) {
-    if (pos >= s.size() || s[pos] != '[') return false;
-    ++pos;
-    json_skip_ws(s, pos);
-
-    if (pos < s.size() && s[pos] == ']') {
-        ++pos;
-        return true;
-    }
-
-    while (pos < s.size()) {
-        if (!json_skip_value(s, pos)) return false;
-        json_skip_ws(s, pos);
-        if (pos >= s.size()) return false;
-        if (s[pos] == ',') {
-            ++pos;
-            json_skip_ws(s, pos);
-            continue;
-        }
-        if (s[pos] == ']') {
-            ++pos;
-            return true;
-        }
-        return false;
-    }
-
-    return false;
-}
-
-static bool json_skip_primitive(const std::string & s, size_t & pos) {
-    const size_t start = pos;
-    while (pos < s.size()) {
-        const char c = s[pos];
-        if (c == ',' || c == '}' || c == ']' || std::isspace(static_cast<unsigned char>(c))) {
-            break;
-        }
-        ++pos;
-    }
-    return pos > start;
-}
-
-static bool json_skip_value(const std::string & s, size_t & pos) {
-    json_skip_ws(s, pos);
-    if (pos >= s.size()) return false;
-
-    if (s[pos] == '"') {
-        std::string ignored;
-        return parse_json_string_token(s, pos, ignored);
-    }
-    if (s[pos] == '{') return json_skip_object(s, pos);
-    if (s[pos] == '[') return json_skip_array(s, pos);
-
-    return json_skip_primitive(s, pos);
-}
-
-static bool json_get_string_field(const std::string & s, const std::string & key, std::string & out) {
-    size_t pos = 0;
-    json_skip_ws(s, pos);
-    if (pos >= s.size() || s[pos] != '{') return false;
-    ++pos;
-    json_skip_ws(s, pos);
-
-    if (pos < s.size() && s[pos] == '}') return false;
-
-    bool found = false;
-    std::string found_value;
-
-    while (pos < s.size()) {
-        std::string name;
-        if (!parse_json_string_token(s, pos, name)) return false;
-        json_skip_ws(s, pos);
-        if (pos >= s.size() || s[pos] != ':') return false;
-        ++pos;
-        json_skip_ws(s, pos);
-
-        if (name == key) {
-            std::string value;
-            if (!parse_json_string_token(s, pos, value)) return false;
-            if (!found) {
-                found = true;
-                found_value = value;
-            }
-        } else {
-            if (!json_skip_value(s, pos)) return false;
-        }
-        json_skip_ws(s, pos);
-        if (pos >= s.size()) return false;
-
-        if (s[pos] == ',') {
-            ++pos;
-            json_skip_ws(s, pos);
-            continue;
-        }
-        if (s[pos] == '}') {
-            ++pos;
-            break;
-        }
-        return false;
-    }
-
-    if (!found) return false;
-
-    json_skip_ws(s, pos);
-    if (pos != s.size()) return false;
-
-    out = found_value;
-
-    return true;
-}
-
-struct config_update_payload {
-    bool has_target_lang = false;
-    bool has_source_lang = false;
-    std::string target_lang;
-    std::string source_lang;
-};
-
-static bool parse_config_update_payload(const std::string & s, config_update_payload & out) {
-    size_t pos = 0;
-    json_skip_ws(s, pos);
-    if (pos >= s.size() || s[pos] != '{') return false;
-    ++pos;
-    json_skip_ws(s, pos);
-
-    if (pos < s.size() && s[pos] == '}') return false;
-
-    while (pos < s.size()) {
-        std::string name;
-        if (!parse_json_string_token(s, pos, name)) return false;
-        json_skip_ws(s, pos);
-        if (pos >= s.size() || s[pos] != ':') return false;
-        ++pos;
-        json_skip_ws(s, pos);
-
-        if (name == "target_lang") {
-            if (!parse_json_string_token(s, pos, out.target_lang)) return false;
-            out.has_target_lang = true;
-        } else if (name == "source_lang") {
-            if (!parse_json_string_token(s, pos, out.source_lang)) return false;
-            out.has_source_lang = true;
-        } else {
-            if (!json_skip_value(s, pos)) return false;
-        }
-
-        json_skip_ws(s, pos);
-        if (pos >= s.size()) return false;
-        if (s[pos] == ',') {
-            ++pos;
-            json_skip_ws(s, pos);
-            continue;
-        }
-        if (s[pos] == '}') {
-            ++pos;
-            break;
-        }
-        return false;
-    }
-
-    json_skip_ws(s, pos);
-    if (pos != s.size()) return false;
-
-    return out.has_target_lang || out.has_source_lang;
-}
-
 static bool is_valid_source_lang(const std::string & lang) {
     return lang == "auto" || whisper_lang_id(lang.c_str()) >= 0;
 }
 
-static std::string to_title_case_ascii(std::string s) {
-    bool capitalize = true;
-    for (char & c : s) {
-        const unsigned char uc = static_cast<unsigned char>(c);
-        if (std::isspace(uc) || c == '-' || c == '_') {
-            capitalize = true;
-            continue;
-        }
-        if (capitalize && std::isalpha(uc)) {
-            c = static_cast<char>(std::toupper(uc));
-            capitalize = false;
-            continue;
-        }
-        if (std::isalpha(uc)) {
-            c = static_cast<char>(std::tolower(uc));
-        }
-        capitalize = false;
-    }
-    return s;
-}
-
-static std::string build_source_languages_json(struct whisper_context * ctx) {
+static std::string build_source_languages_json(bool multilingual) {
     bool first = true;
     std::string json = "[";
 
@@ -689,7 +86,7 @@ static std::string build_source_languages_json(struct whisper_context * ctx) {
 
     append("auto", "Auto");
 
-    if (!whisper_is_multilingual(ctx)) {
+    if (!multilingual) {
         append("en", "English");
     } else {
         const int lang_max = whisper_lang_max_id();
@@ -706,143 +103,299 @@ static std::string build_source_languages_json(struct whisper_context * ctx) {
 }
 
 // ---------------------------------------------------------------------------
-// Translation via LibreTranslate
+// Embedded web assets (content negotiation + conditional requests)
 // ---------------------------------------------------------------------------
 
-static std::string translate_text(httplib::Client & client,
-                                  const std::string & text,
-                                  const std::string & source_lang,
-                                  const std::string & target_lang) {
-    std::string body = "{" + json_str("q", text) +
-                       "," + json_str("source", source_lang) +
-                       "," + json_str("target", target_lang) + "}";
+// q-value the client assigned to `coding` in an Accept-Encoding header.
+// Codings that are not listed fall back to "*", and to 0 when that is absent.
+static float accept_encoding_q(const std::string & header, const std::string & coding) {
+    float star_q = 0.0f;
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) end = header.size();
+        const std::string item = trim(header.substr(pos, end - pos));
+        pos = end + 1;
+
+        const size_t semi = item.find(';');
+        const std::string name = to_lower_ascii(trim(item.substr(0, semi)));
+        float q = 1.0f;
+        if (semi != std::string::npos) {
+            const size_t q_pos = item.find("q=", semi);
+            if (q_pos != std::string::npos) {
+                q = std::strtof(item.c_str() + q_pos + 2, nullptr);
+            }
+        }
 
-    auto res = client.Post("/translate", body, "application/json");
-    if (!res || res->status != 200) {
-        return "";
+        if (name == coding) return q;
+        if (name == "*") star_q = q;
     }
+    return star_q;
+}
 
-    std::string translated;
-    if (!json_get_string_field(res->body, "translatedText", translated)) {
-        return "";
+// If-None-Match uses weak comparison (RFC 9110 13.1.2), so W/ prefixes are ignored.
+static bool etag_list_matches(const std::string & header, const std::string & etag) {
+    auto strip_weak = [](std::string tag) {
+        tag = trim(tag);
+        if (tag.rfind("W/", 0) == 0) tag.erase(0, 2);
+        return tag;
+    };
+
+    const std::string want = strip_weak(etag);
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) end = header.size();
+        const std::string tag = strip_weak(header.substr(pos, end - pos));
+        pos = end + 1;
+        if (tag == "*" || tag == want) return true;
+    }
+    return false;
+}
+
+static void serve_web_asset(const web_asset & asset,
+                            const httplib::Request & req,
+                            httplib::Response & res) {
+    res.set_header("ETag", asset.etag);
+    res.set_header("Cache-Control", asset.cache_control);
+    res.set_header("Vary", "Accept-Encoding");
+
+    if (etag_list_matches(req.get_header_value("If-None-Match"), asset.etag)) {
+        res.status = 304;
+        return;
+    }
+
+    // Pick the best precompressed variant; ties favour the smaller encoding.
+    const std::string accept = req.get_header_value("Accept-Encoding");
+    const web_asset_blob * blob = &asset.identity;
+    const char * encoding = nullptr;
+    float best_q = 0.0f;
+    if (asset.brotli.size > 0) {
+        const float q = accept_encoding_q(accept, "br");
+        if (q > best_q) { best_q = q; blob = &asset.brotli; encoding = "br"; }
+    }
+    if (asset.gzip.size > 0) {
+        const float q = accept_encoding_q(accept, "gzip");
+        if (q > best_q) { best_q = q; blob = &asset.gzip; encoding = "gzip"; }
+    }
+    if (encoding) {
+        res.set_header("Content-Encoding", encoding);
+    }
+
+    // Serve straight from the embedded table; no per-request copy.
+    const web_asset_blob data = *blob;
+    res.set_content_provider(data.size, asset.content_type,
+        [data](size_t offset, size_t length, httplib::DataSink & sink) {
+            return sink.write(reinterpret_cast<const char *>(data.data) + offset, length);
+        });
+}
+
+static std::string route_pattern_for_path(const char * path) {
+    std::string pattern;
+    for (const char * c = path; *c; ++c) {
+        if (std::strchr(".+*?^$()[]{}|\\", *c)) pattern.push_back('\\');
+        pattern.push_back(*c);
     }
-    return translated;
+    return pattern;
 }
 
 // ---------------------------------------------------------------------------
-// Shared state between main loop and SSE clients
+// Translation via LibreTranslate
 // ---------------------------------------------------------------------------
 
-struct subtitle_state {
-    std::mutex              mtx;
-    std::condition_variable cv;
-    std::string             text;
-    std::string             translated;
-    std::string             language;
-    std::string             source_lang = "ko";
-    std::string             target_lang;
-    uint64_t                version = 0;
-    bool                    running = true;
-};
+// GET /api/languages: the LibreTranslate target list, or [] without one.
+static void serve_translate_languages(const std::string & translate_url, httplib::Response & res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(translate_url.empty() ? "[]" : fetch_translate_languages(translate_url), "application/json");
+}
 
 // ---------------------------------------------------------------------------
-// Parameters
+// Transcript history export (/api/history)
 // ---------------------------------------------------------------------------
 
-struct params {
-    int32_t n_threads  = std::max(1, std::min(4, (int32_t)std::thread::hardware_concurrency()));
-    int32_t step_ms    = 1000;
-    int32_t length_ms  = 4000;
-    int32_t keep_ms    = 200;
-    int32_t capture_id = -1;
-    int32_t port       = 8080;
-    int32_t beam_size  = 1;
-    int32_t max_tokens = 32;
-
-    float vad_thold = 0.6f;
-    float temperature_inc = 0.0f;
-
-    bool use_gpu   = true;
-    bool flash_attn = true;
-    bool use_vad = true;
-
-    std::string language      = "ko";
-    std::string model         = "models/ggml-large-v3-turbo.bin";
-    std::string capture_name;
-    std::string translate_url;
-};
-
-static constexpr int k_max_beam_size = 8;
-
-static void print_usage(const char * prog) {
-    const int default_threads = std::max(1, std::min(4, (int)std::thread::hardware_concurrency()));
-    fprintf(stderr, "\nUsage: %s [options]\n\n", prog);
-    fprintf(stderr, "Options:\n");
-    fprintf(stderr, "  --model PATH       Whisper model path      (default: models/ggml-large-v3-turbo.bin)\n");
-    fprintf(stderr, "  --port N           HTTP server port        (default: 8080)\n");
-    fprintf(stderr, "  --step N           Audio step size in ms   (default: 1000)\n");
-    fprintf(stderr, "  --length N         Audio length in ms      (default: 4000)\n");
-    fprintf(stderr, "  --keep N           Audio keep in ms        (default: 200)\n");
-    fprintf(stderr, "  --threads N        Inference threads       (default: %d)\n",
-            default_threads);
-    fprintf(stderr, "  --capture N        Audio device ID         (default: -1 = auto)\n");
-    fprintf(stderr, "  --capture-name STR Capture device name (exact/partial)\n");
-    fprintf(stderr, "  --language LANG    Language or 'auto'      (default: ko)\n");
-    fprintf(stderr, "  --vad-thold F      VAD energy threshold    (0.0..1.0, default: 0.6)\n");
-    fprintf(stderr, "  --beam-size N      Beam search size (1..%d) (default: 1 = greedy)\n", k_max_beam_size);
-    fprintf(stderr, "  --max-tokens N     Max tokens per segment  (default: 32, 0 = unlimited)\n");
-    fprintf(stderr, "  --temperature-inc F Temperature fallback step (default: 0.0)\n");
-    fprintf(stderr, "  --no-vad           Disable VAD gating\n");
-    fprintf(stderr, "  --translate-url URL LibreTranslate server   (default: disabled)\n");
-    fprintf(stderr, "  --no-gpu           Disable GPU\n");
-    fprintf(stderr, "  --no-flash-attn    Disable flash attention\n");
-    fprintf(stderr, "  -h, --help         Show this help\n\n");
+// Parses ?from=/&to= (unix ms). Negative values are relative to now, so
+// "from=-300000" means "the last five minutes".
+static bool parse_history_range(const httplib::Request & req, int64_t & from_ms, int64_t & to_ms) {
+    const int64_t now = unix_time_ms();
+    auto parse = [&](const char * key, int64_t fallback, int64_t & out) {
+        if (!req.has_param(key)) {
+            out = fallback;
+            return true;
+        }
+        const std::string raw = req.get_param_value(key);
+        char * end = nullptr;
+        errno = 0;
+        const long long v = std::strtoll(raw.c_str(), &end, 10);
+        if (errno != 0 || end == raw.c_str() || *end != '\0') return false;
+        out = v < 0 ? now + v : v;
+        return true;
+    };
+    return parse("from", 0, from_ms) && parse("to", now, to_ms) && from_ms <= to_ms;
 }
 
-enum class parse_result {
-    ok = 0,
-    help,
-    error,
+enum class history_format {
+    json,
+    srt,
+    vtt,
 };
 
-static bool parse_int_arg(const char * name, const char * raw,
-                          int32_t & out, int32_t min_v, int32_t max_v) {
-    char * end = nullptr;
-    errno = 0;
-    const long parsed = std::strtol(raw, &end, 10);
-    if (errno != 0 || end == raw || *end != '\0' ||
-        parsed < min_v || parsed > max_v) {
-        fprintf(stderr, "error: invalid value for %s: '%s' (expected %d..%d)\n",
-                name, raw, min_v, max_v);
-        return false;
+// Streams a history range in batches so large exports are never
+// materialized in memory at once.
+static void serve_history(const transcript_log & log, history_format format,
+                          const httplib::Request & req, httplib::Response & res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+
+    int64_t from_ms = 0;
+    int64_t to_ms = 0;
+    if (!parse_history_range(req, from_ms, to_ms)) {
+        res.status = 400;
+        res.set_content("{\"ok\":false,\"error\":\"invalid range\"}", "application/json");
+        return;
     }
 
-    out = static_cast<int32_t>(parsed);
-    return true;
-}
+    const char * content_type = "application/json";
+    if (format == history_format::srt) content_type = "application/x-subrip; charset=utf-8";
+    if (format == history_format::vtt) content_type = "text/vtt; charset=utf-8";
+
+    struct cursor {
+        int64_t          next_from;
+        size_t           skip_at_from = 0;   // records at next_from a previous batch emitted
+        int64_t          to;
+        int64_t          origin = -1;
+        size_t           n_out = 0;
+        bool             started = false;
+        bool             have_pending = false;
+        transcript_entry pending;  // SRT/VTT cues end when the next one starts
+    };
+    auto cur = std::make_shared<cursor>();
+    cur->next_from = from_ms;
+    cur->to = to_ms;
+
+    res.set_chunked_content_provider(content_type,
+        [&log, format, cur](size_t /*offset*/, httplib::DataSink & sink) {
+            static constexpr size_t k_batch = 256;
+
+            std::string out;
+            if (!cur->started) {
+                cur->started = true;
+                if (format == history_format::json) out += "[";
+                if (format == history_format::vtt) out += "WEBVTT\n\n";
+            }
 
-static bool parse_float_arg(const char * name, const char * raw,
-                            float & out, float min_v, float max_v) {
-    char * end = nullptr;
-    errno = 0;
-    const float parsed = std::strtof(raw, &end);
-    if (errno != 0 || end == raw || *end != '\0' || !std::isfinite(parsed) ||
-        parsed < min_v || parsed > max_v) {
-        fprintf(stderr, "error: invalid value for %s: '%s' (expected %.2f..%.2f)\n",
-                name, raw, min_v, max_v);
-        return false;
-    }
+            auto emit_cue = [&](const transcript_entry & e, int64_t end_ms) {
+                if (cur->origin < 0) cur->origin = e.timestamp_ms;
+                const bool vtt = format == history_format::vtt;
+                if (!vtt) out += std::to_string(cur->n_out + 1) + "\n";
+                out += format_cue_time(e.timestamp_ms - cur->origin, vtt) + " --> " +
+                       format_cue_time(end_ms - cur->origin, vtt) + "\n";
+                out += (e.translated.empty() ? e.text : e.translated) + "\n\n";
+            };
 
-    out = parsed;
-    return true;
+            // A batch resumes at a timestamp, which the records emitted last
+            // may share; those are counted and skipped on the next call.
+            size_t  n_batch   = 0;
+            bool    more      = false;
+            int64_t last_ts   = -1;
+            size_t  n_last_ts = 0;   // records at last_ts, earlier batches included
+            size_t  skip      = cur->skip_at_from;
+            log.for_each(cur->next_from, cur->to, [&](const transcript_entry & e) {
+                if (n_batch == k_batch) {
+                    // Resume from the first record not emitted yet.
+                    more = true;
+                    cur->next_from    = e.timestamp_ms;
+                    cur->skip_at_from = e.timestamp_ms == last_ts ? n_last_ts : 0;
+                    return false;
+                }
+                if (e.timestamp_ms != last_ts) {
+                    last_ts   = e.timestamp_ms;
+                    n_last_ts = 0;
+                }
+                ++n_last_ts;
+                if (skip > 0) {
+                    --skip;
+                    return true;
+                }
+                ++n_batch;
+
+                if (format == history_format::json) {
+                    if (cur->n_out > 0) out += ",";
+                    out += "{\"t\":" + std::to_string(e.timestamp_ms) +
+                           ",\"v\":" + std::to_string(e.version) +
+                           "," + json_str("language", e.language) +
+                           "," + json_str("text", e.text) +
+                           "," + json_str("translated", e.translated);
+                    if (e.revises > 0) out += ",\"revises\":" + std::to_string(e.revises);
+                    out += "}";
+                    ++cur->n_out;
+                } else {
+                    if (cur->have_pending) {
+                        emit_cue(cur->pending, std::min(e.timestamp_ms, cur->pending.timestamp_ms + k_max_cue_ms));
+                        ++cur->n_out;
+                    }
+                    cur->pending = e;
+                    cur->have_pending = true;
+                }
+                return true;
+            });
+
+            if (!more) {
+                if (format == history_format::json) {
+                    out += "]";
+                } else if (cur->have_pending) {
+                    emit_cue(cur->pending, cur->pending.timestamp_ms + k_max_cue_ms);
+                }
+            }
+
+            if (!out.empty() && !sink.write(out.data(), out.size())) return false;
+            if (!more) sink.done();
+            return true;
+        });
 }
 
-static std::string to_lower_ascii(std::string s) {
-    for (char & c : s) {
-        const unsigned char uc = static_cast<unsigned char>(c);
-        c = static_cast<char>(std::tolower(uc));
+// ---------------------------------------------------------------------------
+// Startup phases
+// ---------------------------------------------------------------------------
+
+// Wall time of each startup phase in ms (-1 = not reached yet). The HTTP
+// server comes up first, the model and the audio device are brought up in
+// parallel, and a silent warmup inference runs before the pipeline is ready.
+struct startup_report {
+    std::atomic<int64_t> listen_ms{-1};
+    std::atomic<int64_t> model_ms{-1};
+    std::atomic<int64_t> audio_ms{-1};
+    std::atomic<int64_t> warmup_ms{-1};
+    std::atomic<int64_t> autotune_ms{-1};
+    std::atomic<int64_t> ready_ms{-1};   // process start -> ready
+
+    // Primary model load (--model-loader).
+    std::atomic<const char *> model_loader{""};
+    std::atomic<int64_t> model_bytes{-1};
+    std::atomic<int>     model_cached_pct{-1};
+    std::atomic<int64_t> rss_bytes{-1};    // after the model load
+
+    // Published once ready; endpoints that need the model answer 503 before.
+    std::atomic<whisper_context *> ctx{nullptr};
+
+    std::string to_json() const {
+        return std::string("{\"state\":\"") + (ctx.load() ? "ready" : "loading") + "\"" +
+               ",\"listen_ms\":" + std::to_string(listen_ms.load()) +
+               ",\"model_ms\":"  + std::to_string(model_ms.load()) +
+               ",\"audio_ms\":"  + std::to_string(audio_ms.load()) +
+               ",\"warmup_ms\":" + std::to_string(warmup_ms.load()) +
+               ",\"autotune_ms\":" + std::to_string(autotune_ms.load()) +
+               ",\"ready_ms\":"  + std::to_string(ready_ms.load()) +
+               "," + json_str("model_loader", model_loader.load()) +
+               ",\"model_bytes\":" + std::to_string(model_bytes.load()) +
+               ",\"model_cached_pct\":" + std::to_string(model_cached_pct.load()) +
+               ",\"rss_bytes\":" + std::to_string(rss_bytes.load()) + "}";
     }
-    return s;
+};
+
+// Payload of the `event: status` SSE message.
+static std::string build_status_event(const char * state, const char * phase) {
+    std::string json = "{" + json_str("state", state);
+    if (phase) json += "," + json_str("phase", phase);
+    return json + "}";
 }
 
 static bool resolve_capture_id_by_name(const std::string & capture_name, int32_t & out_id) {
@@ -916,266 +469,1560 @@ static bool resolve_capture_id_by_name(const std::string & capture_name, int32_t
     return out_id >= 0;
 }
 
-static bool take_option_value(int argc, char ** argv, int & i, const char * opt, const char * & out) {
-    if (i + 1 >= argc) {
-        fprintf(stderr, "error: missing value for %s\n", opt);
-        return false;
-    }
+// ---------------------------------------------------------------------------
+// Signal handling
+// ---------------------------------------------------------------------------
 
-    out = argv[++i];
-    return true;
+static std::atomic<bool> g_running{true};
+
+static void signal_handler(int) {
+    g_running = false;
 }
 
-static float average_abs_energy(const std::vector<float> & samples) {
-    if (samples.empty()) {
-        return 0.0f;
-    }
+// ---------------------------------------------------------------------------
+// Audio sources (SDL capture or network ingest)
+// ---------------------------------------------------------------------------
 
-    float energy = 0.0f;
-    for (float sample : samples) {
-        energy += fabsf(sample);
+class sdl_audio_source : public audio_source {
+public:
+    explicit sdl_audio_source(int len_ms) : audio_(len_ms) {}
+
+    bool init(int capture_id) {
+        if (!audio_.init(capture_id, WHISPER_SAMPLE_RATE)) {
+            return false;
+        }
+        audio_.resume();
+        return true;
     }
-    return energy / samples.size();
-}
 
-static bool should_process_audio_chunk(const std::vector<float> & samples,
-                                       float vad_thold,
-                                       float noise_floor,
-                                       bool noise_floor_ready,
-                                       float & energy_out,
-                                       float & gate_out) {
-    energy_out = 0.0f;
-    gate_out = 0.0f;
+    bool poll() override { return sdl_poll_events(); }
+    void get(int ms, std::vector<float> & out) override { audio_.get(ms, out); }
+    void clear() override { audio_.clear(); }
+    void pause() override { audio_.pause(); }
 
-    if (samples.empty()) {
-        return false;
-    }
+private:
+    audio_async audio_;
+};
 
-    energy_out = average_abs_energy(samples);
-    const float vad_unit = std::max(0.0f, std::min(vad_thold, 1.0f));
+// POST /api/ingest?format=s16le|f32le&rate=N&channels=N with a (typically
+// chunked) body of raw interleaved PCM. The request lasts as long as the
+// sender keeps streaming. The sink is a network_audio_source, or in the
+// --workers front the channel of the session's worker; it provides
+// begin_stream()/write()/end_stream().
+template <typename Sink>
+static void handle_ingest(Sink & source,
+                          const httplib::Request & req, httplib::Response & res,
+                          const httplib::ContentReader & content_reader) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+
+    auto bad_request = [&](const char * error) {
+        res.status = 400;
+        res.set_content(std::string("{\"ok\":false,\"error\":\"") + error + "\"}", "application/json");
+    };
 
-    // Base gate for environments where we don't have enough noise history yet.
-    const float base_gate = 0.00008f + 0.00020f * vad_unit;
-    gate_out = base_gate;
+    const std::string format_raw = req.has_param("format") ? req.get_param_value("format") : "s16le";
+    ingest_format format;
+    if (format_raw == "s16le") {
+        format = ingest_format::s16le;
+    } else if (format_raw == "f32le") {
+        format = ingest_format::f32le;
+    } else {
+        bad_request("invalid format");
+        return;
+    }
 
-    // Learn room noise over time and require speech energy above that floor.
-    if (noise_floor_ready) {
-        const float adaptive_gate = noise_floor * (1.6f + 1.2f * vad_unit);
-        gate_out = std::max(base_gate, adaptive_gate);
+    int32_t rate = WHISPER_SAMPLE_RATE;
+    int32_t channels = 1;
+    if ((req.has_param("rate") &&
+         !parse_int_arg("rate", req.get_param_value("rate").c_str(), rate, 8000, 192000)) ||
+        (req.has_param("channels") &&
+         !parse_int_arg("channels", req.get_param_value("channels").c_str(), channels, 1, 8))) {
+        bad_request("invalid rate/channels");
+        return;
     }
 
-    return energy_out >= gate_out;
-}
+    if (!source.begin_stream()) {
+        res.status = 409;
+        res.set_content("{\"ok\":false,\"error\":\"ingest busy\"}", "application/json");
+        return;
+    }
 
-static std::string normalize_for_dedup(const std::string & text) {
-    std::string out;
-    out.reserve(text.size());
+    log_write(log_level::info, "ingest", "stream started (%s, %d Hz, %d ch)", format_raw.c_str(), rate, channels);
+
+    ingest_decoder decoder(format, rate, channels);
+    std::vector<float> samples;
+    uint64_t n_bytes = 0;
+    content_reader([&](const char * data, size_t len) {
+        samples.clear();
+        decoder.decode(data, len, samples);
+        source.write(samples.data(), samples.size());
+        n_bytes += len;
+        return g_running.load();
+    });
 
-    for (char c : text) {
-        const unsigned char uc = static_cast<unsigned char>(c);
-        if (std::isspace(uc) || std::ispunct(uc)) {
-            continue;
-        }
-        if (uc < 0x80) {
-            out.push_back(static_cast<char>(std::tolower(uc)));
-        } else {
-            out.push_back(c);
+    source.end_stream();
+    log_write(log_level::info, "ingest", "stream ended (%llu bytes)", (unsigned long long)n_bytes);
+    res.set_content("{\"ok\":true}", "application/json");
+}
+
+// ---------------------------------------------------------------------------
+// Inference parameters and start-up auto-tuning (--autotune)
+// ---------------------------------------------------------------------------
+
+// Inference parameters shared by the warmup run, auto-tuning and the main loop.
+static whisper_full_params make_whisper_params(const params & par, const char * language) {
+    const whisper_sampling_strategy strategy =
+        par.beam_size > 1 ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY;
+    whisper_full_params wparams = whisper_full_default_params(strategy);
+
+    wparams.print_progress   = false;
+    wparams.print_special    = false;
+    wparams.print_realtime   = false;
+    wparams.print_timestamps = false;
+    wparams.translate        = false;
+    wparams.no_timestamps    = true;
+    wparams.single_segment   = true;
+    wparams.max_tokens       = par.max_tokens;
+    wparams.suppress_nst     = true;
+    wparams.language         = language;
+    wparams.n_threads        = par.n_threads;
+    wparams.audio_ctx        = 0;
+    wparams.temperature_inc  = par.temperature_inc;
+    wparams.beam_search.beam_size = par.beam_size;
+    return wparams;
+}
+
+// --lang-detect utterance|pin: identifies the window's language up front,
+// which yields its probability (whisper_full's own detection discards it).
+// Returns "" if identification failed.
+static std::string identify_language(whisper_context * ctx, const std::vector<float> & pcm,
+                                     int n_threads, float & prob) {
+    prob = -1.0f;
+    if (whisper_pcm_to_mel(ctx, pcm.data(), (int)pcm.size(), n_threads) != 0) {
+        return "";
+    }
+    std::vector<float> probs(whisper_lang_max_id() + 1, 0.0f);
+    const int lang_id = whisper_lang_auto_detect(ctx, 0, n_threads, probs.data());
+    if (lang_id < 0 || lang_id >= (int)probs.size()) {
+        return "";
+    }
+    prob = probs[lang_id];
+    return whisper_lang_str(lang_id);
+}
+
+// Text tokens of the last whisper_full (special tokens excluded).
+struct decoded_tokens {
+    int   n            = 0;
+    float mean_p       = -1.0f;   // -1 if n == 0
+    float mean_logprob = 0.0f;
+};
+
+static decoded_tokens decoded_token_stats(whisper_context * ctx) {
+    const whisper_token eot = whisper_token_eot(ctx);
+    double sum_p = 0.0;
+    double sum_logprob = 0.0;
+    decoded_tokens out;
+    const int n_segments = whisper_full_n_segments(ctx);
+    for (int i = 0; i < n_segments; ++i) {
+        const int n_tokens = whisper_full_n_tokens(ctx, i);
+        for (int j = 0; j < n_tokens; ++j) {
+            const whisper_token_data data = whisper_full_get_token_data(ctx, i, j);
+            if (data.id >= eot) continue;
+            sum_p       += data.p;
+            sum_logprob += data.plog;
+            ++out.n;
         }
     }
+    if (out.n > 0) {
+        out.mean_p       = (float)(sum_p / out.n);
+        out.mean_logprob = (float)(sum_logprob / out.n);
+    }
     return out;
 }
 
-static std::string normalize_repeat_token(const std::string & token) {
-    size_t start = 0;
-    size_t end = token.size();
+static std::string full_segment_text(whisper_context * ctx) {
+    std::string text;
+    const int n_segments = whisper_full_n_segments(ctx);
+    for (int i = 0; i < n_segments; i++) {
+        text += whisper_full_get_segment_text(ctx, i);
+    }
+    return text;
+}
 
-    while (start < end && std::ispunct(static_cast<unsigned char>(token[start]))) {
-        ++start;
+// Callbacks attached to one whisper_full call of the main loop.
+//
+// --trace: splits the call into "encode" and "decode" spans. The
+// encoder-begin callback opens "encode"; the first logits-filter call
+// (first token about to be sampled) closes it and opens "decode", which
+// finish() closes after whisper_full returns. The initial prompt pass
+// therefore counts towards "encode".
+//
+// Confidence gate: the first logits-filter call also reads the no-speech
+// probability from the raw logits of that prompt pass (the row whisper.cpp
+// computes its own no_speech_prob from, before any filtering) and, if the
+// gate says the window is silence, makes the abort callback stop the
+// decode before a single token is sampled.
+struct whisper_decode_hooks {
+    int64_t step            = 0;
+    int64_t encode_start_us = -1;
+    int64_t decode_start_us = -1;
+
+    bool                    trace = false;
+    const confidence_gate * gate  = nullptr;   // null = no early stop
+    bool                    first_pass_seen = false;
+    bool                    stopped_early   = false;
+    float                   no_speech_prob  = -1.0f;
+
+    // Returns false when nothing needs hooking.
+    bool attach(whisper_full_params & wparams, int64_t step_index, bool with_trace,
+                const confidence_gate * early_stop_gate) {
+        step = step_index;
+        encode_start_us = -1;
+        decode_start_us = -1;
+        trace           = with_trace;
+        gate            = early_stop_gate;
+        first_pass_seen = false;
+        stopped_early   = false;
+        no_speech_prob  = -1.0f;
+        if (!trace && !gate) return false;
+
+        if (trace) {
+            wparams.encoder_begin_callback           = on_encoder_begin;
+            wparams.encoder_begin_callback_user_data = this;
+        }
+        wparams.logits_filter_callback           = on_logits_filter;
+        wparams.logits_filter_callback_user_data = this;
+        if (gate) {
+            wparams.abort_callback           = on_abort;
+            wparams.abort_callback_user_data = this;
+        }
+        return true;
     }
-    while (end > start && std::ispunct(static_cast<unsigned char>(token[end - 1]))) {
-        --end;
+
+    void finish() {
+        if (!trace) return;
+        const int64_t now = trace_now_us();
+        if (decode_start_us >= 0) {
+            trace_complete("decode", "infer", decode_start_us, now, "step", step);
+        } else if (encode_start_us >= 0) {
+            trace_complete("encode", "infer", encode_start_us, now, "step", step);
+        }
+        encode_start_us = -1;
+        decode_start_us = -1;
     }
-    if (start >= end) {
-        return "";
+
+private:
+    static bool on_encoder_begin(whisper_context *, whisper_state *, void * user_data) {
+        auto * self = static_cast<whisper_decode_hooks *>(user_data);
+        const int64_t now = trace_now_us();
+        if (self->decode_start_us >= 0) {   // next 30 s window of a long input
+            trace_complete("decode", "infer", self->decode_start_us, now, "step", self->step);
+            self->decode_start_us = -1;
+        }
+        self->encode_start_us = now;
+        return true;
     }
 
-    std::string normalized = token.substr(start, end - start);
-    for (char & c : normalized) {
-        const unsigned char uc = static_cast<unsigned char>(c);
-        if (uc < 0x80) {
-            c = static_cast<char>(std::tolower(uc));
+    static void on_logits_filter(whisper_context * ctx, whisper_state * state, const whisper_token_data *, int,
+                                 float *, void * user_data) {
+        auto * self = static_cast<whisper_decode_hooks *>(user_data);
+        if (self->trace && self->encode_start_us >= 0 && self->decode_start_us < 0) {
+            const int64_t now = trace_now_us();
+            trace_complete("encode", "infer", self->encode_start_us, now, "step", self->step);
+            self->decode_start_us = now;
+        }
+        if (self->first_pass_seen) return;
+        self->first_pass_seen = true;
+        if (self->gate) {
+            self->no_speech_prob = no_speech_prob_from_logits(whisper_get_logits_from_state(state),
+                                                              whisper_n_vocab(ctx), whisper_token_nosp(ctx));
+            self->stopped_early = self->gate->should_stop_early(self->no_speech_prob);
         }
     }
-    return normalized;
-}
 
-static std::vector<std::string> split_repetition_tokens(const std::string & text) {
-    std::vector<std::string> out;
-    std::string current;
+    static bool on_abort(void * user_data) {
+        return static_cast<whisper_decode_hooks *>(user_data)->stopped_early;
+    }
+};
 
-    for (char c : text) {
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            if (!current.empty()) {
-                std::string token = normalize_repeat_token(current);
-                if (!token.empty()) {
-                    out.push_back(token);
+// A setting must finish within this share of --step to count as fitting.
+static constexpr double k_autotune_headroom = 0.7;
+// Each candidate is timed this many times; the fastest run counts.
+static constexpr int    k_autotune_runs     = 2;
+
+struct autotune_result {
+    int32_t n_threads  = 0;
+    int32_t beam_size  = 0;
+    double  latency_ms = std::numeric_limits<double>::infinity();
+};
+
+static std::string cpu_brand_string() {
+#if defined(__APPLE__)
+    char buf[256];
+    size_t len = sizeof(buf);
+    if (sysctlbyname("machdep.cpu.brand_string", buf, &len, nullptr, 0) == 0) {
+        return std::string(buf, strnlen(buf, sizeof(buf)));
+    }
+#else
+    if (FILE * f = fopen("/proc/cpuinfo", "r")) {
+        char line[512];
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "model name", 10) == 0) {
+                if (const char * colon = strchr(line, ':')) {
+                    fclose(f);
+                    return trim(colon + 1);
                 }
-                current.clear();
             }
-            continue;
         }
-        current.push_back(c);
+        fclose(f);
+    }
+#endif
+    return "unknown";
+}
+
+// Cores inference may run on: the --infer-cpus set when one is given.
+static int32_t inference_core_count(const params & par) {
+    if (!par.infer_cpus.empty()) return (int32_t)par.infer_cpus.size();
+    return (int32_t)std::max(1u, std::thread::hardware_concurrency());
+}
+
+static std::string default_autotune_cache_path() {
+    const char * xdg = getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) return std::string(xdg) + "/live-subtitle/autotune.tsv";
+    const char * home = getenv("HOME");
+    if (home && *home) return std::string(home) + "/.cache/live-subtitle/autotune.tsv";
+    return "live-subtitle-autotune.tsv";
+}
+
+// Everything the answer depends on: the model file, the CPU, and the
+// settings that decide the workload and the latency budget.
+static std::string autotune_cache_key(const params & par) {
+    std::error_code ec;
+    const uintmax_t model_size = std::filesystem::file_size(par.model, ec);
+    const auto model_mtime = ec ? 0 : std::filesystem::last_write_time(par.model, ec).time_since_epoch().count();
+
+    std::string cpu = cpu_brand_string();
+    std::replace(cpu.begin(), cpu.end(), '\t', ' ');
+
+    char buf[1024];
+    snprintf(buf, sizeof(buf),
+             "model=%s;size=%llu;mtime=%lld;cpu=%s;cores=%d;cpus=%s;gpu=%d;fa=%d;step=%d;length=%d;beam=%d;clip=%s",
+             par.model.c_str(), (unsigned long long)model_size, (long long)model_mtime, cpu.c_str(),
+             inference_core_count(par), par.infer_cpus.empty() ? "all" : format_cpu_list(par.infer_cpus).c_str(),
+             par.use_gpu ? 1 : 0, par.flash_attn ? 1 : 0,
+             par.step_ms, par.length_ms, par.beam_size, par.autotune_clip.c_str());
+    std::string key = buf;
+    std::replace(key.begin(), key.end(), '\t', ' ');
+    std::replace(key.begin(), key.end(), '\n', ' ');
+    return key;
+}
+
+// Cache file: one "key<TAB>threads<TAB>beam<TAB>latency_ms" line per entry.
+static bool load_autotune_cache(const std::string & path, const std::string & key, autotune_result & out) {
+    FILE * f = fopen(path.c_str(), "r");
+    if (!f) return false;
+
+    bool found = false;
+    char line[2048];
+    while (!found && fgets(line, sizeof(line), f)) {
+        const char * tab = strchr(line, '\t');
+        if (!tab || std::string(line, tab - line) != key) continue;
+        int threads = 0;
+        int beam = 0;
+        double latency = 0.0;
+        if (sscanf(tab + 1, "%d\t%d\t%lf", &threads, &beam, &latency) == 3 &&
+            threads >= k_threads_range.min_v && threads <= k_threads_range.max_v &&
+            beam >= k_beam_size_range.min_v && beam <= k_beam_size_range.max_v) {
+            out.n_threads  = threads;
+            out.beam_size  = beam;
+            out.latency_ms = latency;
+            found = true;
+        }
     }
+    fclose(f);
+    return found;
+}
 
-    if (!current.empty()) {
-        std::string token = normalize_repeat_token(current);
-        if (!token.empty()) {
-            out.push_back(token);
+static void save_autotune_cache(const std::string & path, const std::string & key, const autotune_result & r) {
+    std::vector<std::string> kept;
+    if (FILE * f = fopen(path.c_str(), "r")) {
+        char line[2048];
+        while (fgets(line, sizeof(line), f)) {
+            const char * tab = strchr(line, '\t');
+            if (tab && std::string(line, tab - line) != key) kept.emplace_back(line);
         }
+        fclose(f);
     }
 
-    return out;
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    const std::string tmp = path + ".tmp";
+    FILE * f = fopen(tmp.c_str(), "w");
+    if (!f) {
+        fprintf(stderr, "warning: autotune: cannot write cache '%s'\n", path.c_str());
+        return;
+    }
+    for (const std::string & line : kept) fputs(line.c_str(), f);
+    fprintf(f, "%s\t%d\t%d\t%.1f\n", key.c_str(), r.n_threads, r.beam_size, r.latency_ms);
+    const bool ok = fclose(f) == 0;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        fprintf(stderr, "warning: autotune: cannot write cache '%s'\n", path.c_str());
+        std::remove(tmp.c_str());
+    }
 }
 
-static bool should_drop_repetitive_text(const std::string & text,
-                                        const std::string & prev_text,
-                                        std::string & reason) {
-    const std::vector<std::string> tokens = split_repetition_tokens(text);
-    if (tokens.empty()) {
-        return false;
+// Fastest of k_autotune_runs runs of whisper_full on clip, or a negative
+// value if inference failed.
+static double time_inference(whisper_context * ctx, const params & p, const std::vector<float> & clip) {
+    double best = -1.0;
+    for (int i = 0; i < k_autotune_runs && g_running; ++i) {
+        const whisper_full_params wparams = make_whisper_params(p, p.language.c_str());
+        const auto t0 = std::chrono::steady_clock::now();
+        if (whisper_full(ctx, wparams, clip.data(), (int)clip.size()) != 0) return -1.0;
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (best < 0.0 || ms < best) best = ms;
     }
+    return best;
+}
 
-    if (tokens.size() >= 8) {
-        std::unordered_map<std::string, int> counts;
-        int max_count = 0;
-        for (const std::string & token : tokens) {
-            const int next = ++counts[token];
-            max_count = std::max(max_count, next);
+// Thread counts 1, 2, 4, ... up to (and including) the core count, or
+// the size of the --infer-cpus set. The sweep stops early once more
+// threads make things clearly slower.
+static autotune_result sweep_thread_counts(whisper_context * ctx, params p, int32_t beam_size,
+                                           const std::vector<float> & clip) {
+    const int32_t n_cores = inference_core_count(p);
+    std::vector<int32_t> candidates;
+    for (int32_t n = 1; n < n_cores; n *= 2) candidates.push_back(n);
+    candidates.push_back(n_cores);
+
+    autotune_result best;
+    p.beam_size = beam_size;
+    for (int32_t n : candidates) {
+        if (!g_running) break;
+        p.n_threads = n;
+        const double ms = time_inference(ctx, p, clip);
+        if (ms < 0.0) {
+            fprintf(stderr, "autotune: beam %d, threads %d -> failed\n", beam_size, n);
+            continue;
+        }
+        fprintf(stderr, "autotune: beam %d, threads %d -> %.0f ms\n", beam_size, n, ms);
+        if (ms < best.latency_ms) {
+            best.n_threads  = n;
+            best.beam_size  = beam_size;
+            best.latency_ms = ms;
+        } else if (ms > best.latency_ms * 1.15) {
+            break;
         }
+    }
+    return best;
+}
 
-        const float dominant_ratio = (float)max_count / (float)tokens.size();
-        if (dominant_ratio >= 0.75f) {
-            reason = "dominant-token-ratio";
-            return true;
+// Picks --threads (and greedy vs. --beam-size) for this machine, from the
+// cache when possible. Greedy is always measured; a configured beam size
+// is kept only if it also fits the step budget. Updates par in place.
+static void run_autotune(whisper_context * ctx, params & par) {
+    const std::string cache_path = par.autotune_cache.empty() ? default_autotune_cache_path() : par.autotune_cache;
+    const std::string key = autotune_cache_key(par);
+
+    autotune_result chosen;
+    if (load_autotune_cache(cache_path, key, chosen)) {
+        fprintf(stderr, "autotune: cached: threads %d, beam %d (%.0f ms per step)\n",
+                chosen.n_threads, chosen.beam_size, chosen.latency_ms);
+        par.n_threads = chosen.n_threads;
+        par.beam_size = chosen.beam_size;
+        return;
+    }
+
+    // A silent clip exercises the encoder fully (the window is always
+    // padded to 30 s) but decodes almost nothing; --autotune-clip gives a
+    // realistic decoder load.
+    std::vector<float> clip;
+    if (!par.autotune_clip.empty()) {
+        std::vector<std::vector<float>> clip_stereo;
+        if (!read_audio_data(par.autotune_clip, clip, clip_stereo, false)) {
+            fprintf(stderr, "warning: autotune: cannot read '%s', using silence\n", par.autotune_clip.c_str());
+            clip.clear();
         }
     }
+    const size_t n_window = (size_t)(1e-3 * par.length_ms * WHISPER_SAMPLE_RATE);
+    if (clip.empty()) {
+        clip.assign(n_window, 0.0f);
+    } else if (clip.size() > n_window) {
+        clip.resize(n_window);
+    }
+
+    chosen = sweep_thread_counts(ctx, par, 1, clip);
+    if (!std::isfinite(chosen.latency_ms)) {
+        fprintf(stderr, "warning: autotune: no setting could be measured, keeping --threads %d\n", par.n_threads);
+        return;
+    }
 
-    int max_run = 1;
-    int run = 1;
-    for (size_t i = 1; i < tokens.size(); ++i) {
-        if (tokens[i] == tokens[i - 1]) {
-            ++run;
-            max_run = std::max(max_run, run);
+    const double budget_ms = par.step_ms * k_autotune_headroom;
+    if (par.beam_size > 1) {
+        const autotune_result beam = sweep_thread_counts(ctx, par, par.beam_size, clip);
+        if (beam.latency_ms <= budget_ms) {
+            chosen = beam;
         } else {
-            run = 1;
+            fprintf(stderr, "autotune: beam %d does not fit the step budget, using greedy\n", par.beam_size);
         }
     }
-    if (max_run >= 5) {
-        reason = "consecutive-token-repeat";
-        return true;
+    if (chosen.latency_ms > budget_ms) {
+        fprintf(stderr, "warning: autotune: fastest setting takes %.0f ms, more than %.0f%% of --step %d\n",
+                chosen.latency_ms, k_autotune_headroom * 100.0, par.step_ms);
     }
 
-    if (!prev_text.empty() && text.size() > prev_text.size() && text.rfind(prev_text, 0) == 0) {
-        std::string suffix = trim(text.substr(prev_text.size()));
-        std::vector<std::string> suffix_tokens = split_repetition_tokens(suffix);
-        if (suffix_tokens.size() >= 4) {
-            std::unordered_set<std::string> unique_tokens(suffix_tokens.begin(), suffix_tokens.end());
-            if (unique_tokens.size() == 1) {
-                reason = "suffix-single-token-repeat";
-                return true;
+    fprintf(stderr, "autotune: chose threads %d, beam %d (%.0f ms per step)\n",
+            chosen.n_threads, chosen.beam_size, chosen.latency_ms);
+    if (g_running) {
+        save_autotune_cache(cache_path, key, chosen);
+    }
+    par.n_threads = chosen.n_threads;
+    par.beam_size = chosen.beam_size;
+}
+
+// ---------------------------------------------------------------------------
+// Model loading (--model-loader)
+// ---------------------------------------------------------------------------
+
+// mmap: whisper reads the weights straight out of a shared read-only
+// mapping of the file, so a model another instance already loaded comes
+// from the page cache without disk I/O or a stdio copy, and the mapping is
+// dropped once whisper has copied the tensors into its backend buffers.
+// file: whisper's own fread loader. Either way the file is probed with
+// mincore first so the log tells a cold load from a warm one.
+static whisper_context * load_whisper_model(const std::string & path, const std::string & loader,
+                                            const whisper_context_params & cparams,
+                                            model_load_stats & stats) {
+    const auto t0 = std::chrono::steady_clock::now();
+    stats = model_load_stats();
+    stats.rss_before = current_rss_bytes();
+
+    whisper_context * ctx = nullptr;
+    {
+        mapped_model_file file;
+        std::string error;
+        const bool mapped = file.map(path, error);
+        if (mapped) {
+            stats.file_bytes = (int64_t)file.size();
+            stats.cached_pct = file.resident_pct();
+        }
+        if (loader == "mmap" && mapped) {
+            stats.loader = "mmap";
+            // Read-only: whisper only copies out of the buffer.
+            ctx = whisper_init_from_buffer_with_params(const_cast<void *>(file.data()), file.size(), cparams);
+        } else {
+            if (loader == "mmap") {
+                fprintf(stderr, "warning: cannot map model '%s' (%s), reading it instead\n",
+                        path.c_str(), error.c_str());
             }
+            file.unmap();
+            ctx = whisper_init_from_file_with_params(path.c_str(), cparams);
         }
     }
 
-    return false;
+    stats.rss_after = current_rss_bytes();
+    stats.load_ms = (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    return ctx;
 }
 
-static parse_result parse_params(int argc, char ** argv, params & p) {
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        const char * raw = nullptr;
+// ---------------------------------------------------------------------------
+// Offline batch transcription (--batch)
+// ---------------------------------------------------------------------------
+
+// Recorded files are transcribed by --batch-jobs decoders, each with its
+// own whisper_state over one shared context, so the weights are loaded
+// once. A file starts out as a single task that decodes the audio and
+// splits it into chunks of up to --batch-chunk; the chunks go back into the
+// queue, where idle decoders steal them, so even one long file keeps every
+// decoder busy. Whoever finishes a file's last chunk filters and writes its
+// transcript.
+
+// Cuts are placed at the quietest point of the last stretch of a chunk.
+static constexpr int k_batch_cut_search_ms = 2000;
+
+struct batch_file {
+    std::string                             input;
+    std::string                             output;
+    std::vector<float>                      pcm;       // released once the file is written
+    std::vector<audio_chunk>                chunks;
+    std::vector<std::vector<batch_segment>> results;   // one entry per chunk
+    std::atomic<size_t>                     remaining{0};
+    std::chrono::steady_clock::time_point   t_start;
+};
+
+class batch_runner {
+public:
+    batch_runner(whisper_context * ctx, const params & par, size_t n_jobs)
+        : ctx_(ctx), par_(par), queue_(n_jobs) {}
+
+    ~batch_runner() {
+        for (whisper_state * s : states_) whisper_free_state(s);
+    }
 
-        if      (arg == "--model") {
-            if (!take_option_value(argc, argv, i, "--model", raw)) return parse_result::error;
-            p.model = raw;
+    bool init(const std::vector<std::string> & inputs) {
+        for (size_t j = 0; j < queue_.worker_count(); ++j) {
+            whisper_state * state = whisper_init_state(ctx_);
+            if (!state) {
+                fprintf(stderr, "error: batch: failed to create decoder state %zu\n", j);
+                return false;
+            }
+            states_.push_back(state);
         }
-        else if (arg == "--port") {
-            if (!take_option_value(argc, argv, i, "--port", raw)) return parse_result::error;
-            if (!parse_int_arg("--port", raw, p.port, 1, 65535)) return parse_result::error;
+        for (const std::string & input : inputs) {
+            auto file = std::make_unique<batch_file>();
+            file->input  = input;
+            file->output = batch_output_path(input, par_.batch_out, par_.batch_output_format);
+            files_.push_back(std::move(file));
         }
-        else if (arg == "--step") {
-            if (!take_option_value(argc, argv, i, "--step", raw)) return parse_result::error;
-            if (!parse_int_arg("--step", raw, p.step_ms, 1, 3600000)) return parse_result::error;
+        if (!par_.batch_out.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(par_.batch_out, ec);
         }
-        else if (arg == "--length") {
-            if (!take_option_value(argc, argv, i, "--length", raw)) return parse_result::error;
-            if (!parse_int_arg("--length", raw, p.length_ms, 1, 3600000)) return parse_result::error;
+        return true;
+    }
+
+    // Returns the number of files that failed.
+    size_t run() {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < files_.size(); ++i) {
+            batch_file * file = files_[i].get();
+            queue_.push(i % queue_.worker_count(), [this, file](size_t worker) { load(*file, worker); });
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t j = 0; j < queue_.worker_count(); ++j) {
+            threads.emplace_back([this, j]() { queue_.work(j); });
+        }
+        for (auto & t : threads) t.join();
+
+        const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        const double audio_h = (double)audio_ms_.load() / 3600000.0;
+        const double wall_h  = wall_s / 3600.0;
+        fprintf(stderr, "\nbatch: %zu files (%zu failed), %.2f h audio in %.1f s -> %.1f audio-hours per wall-hour\n",
+                files_.size(), failed_.load(), audio_h, wall_s, wall_h > 0.0 ? audio_h / wall_h : 0.0);
+        fprintf(stderr, "batch: %zu jobs x %d threads, %llu segments (%llu dropped by the text filter), %llu steals\n",
+                queue_.worker_count(), par_.n_threads, (unsigned long long)segments_.load(),
+                (unsigned long long)dropped_.load(), (unsigned long long)queue_.steals());
+        return failed_.load();
+    }
+
+private:
+    void load(batch_file & file, size_t worker) {
+        if (!g_running) return;
+        file.t_start = std::chrono::steady_clock::now();
+
+        std::vector<std::vector<float>> stereo;
+        if (!read_audio_data(file.input, file.pcm, stereo, false)) {
+            fprintf(stderr, "error: batch: cannot read '%s'\n", file.input.c_str());
+            failed_++;
+            return;
         }
-        else if (arg == "--keep") {
-            if (!take_option_value(argc, argv, i, "--keep", raw)) return parse_result::error;
-            if (!parse_int_arg("--keep", raw, p.keep_ms, 0, 3600000)) return parse_result::error;
+
+        const size_t chunk_samples  = (size_t)par_.batch_chunk_ms * WHISPER_SAMPLE_RATE / 1000;
+        const size_t search_samples = (size_t)k_batch_cut_search_ms * WHISPER_SAMPLE_RATE / 1000;
+        file.chunks = plan_chunks(file.pcm, chunk_samples, search_samples);
+        file.results.resize(file.chunks.size());
+        file.remaining = file.chunks.size();
+        if (file.chunks.empty()) {
+            finish(file);
+            return;
         }
-        else if (arg == "--threads") {
-            if (!take_option_value(argc, argv, i, "--threads", raw)) return parse_result::error;
-            if (!parse_int_arg("--threads", raw, p.n_threads, 1, 4096)) return parse_result::error;
+
+        // Pushed last-to-first: this worker continues with chunk 0 while
+        // thieves take the end of the file.
+        for (size_t c = file.chunks.size(); c-- > 0;) {
+            queue_.push(worker, [this, &file, c](size_t w) { transcribe(file, c, w); });
         }
-        else if (arg == "--capture") {
-            if (!take_option_value(argc, argv, i, "--capture", raw)) return parse_result::error;
-            if (!parse_int_arg("--capture", raw, p.capture_id, -1, std::numeric_limits<int32_t>::max())) {
-                return parse_result::error;
+    }
+
+    void transcribe(batch_file & file, size_t chunk_index, size_t worker) {
+        if (g_running) {
+            const audio_chunk & chunk = file.chunks[chunk_index];
+            const int64_t offset_ms = (int64_t)(chunk.begin * 1000 / WHISPER_SAMPLE_RATE);
+            whisper_state * state = states_[worker];
+
+            // Whole recordings rather than live windows: timestamps on,
+            // several segments per chunk, no token cap.
+            whisper_full_params wparams = make_whisper_params(par_, par_.language.c_str());
+            wparams.no_timestamps  = false;
+            wparams.single_segment = false;
+            wparams.max_tokens     = 0;
+
+            if (whisper_full_with_state(ctx_, state, wparams, file.pcm.data() + chunk.begin,
+                                        (int)(chunk.end - chunk.begin)) == 0) {
+                const int lang_id = whisper_full_lang_id_from_state(state);
+                const std::string lang = lang_id >= 0 ? whisper_lang_str(lang_id) : "";
+                std::vector<batch_segment> & out = file.results[chunk_index];
+                const int n_segments = whisper_full_n_segments_from_state(state);
+                for (int i = 0; i < n_segments; ++i) {
+                    batch_segment seg;
+                    seg.start_ms = offset_ms + whisper_full_get_segment_t0_from_state(state, i) * 10;
+                    seg.end_ms   = offset_ms + whisper_full_get_segment_t1_from_state(state, i) * 10;
+                    seg.text     = whisper_full_get_segment_text_from_state(state, i);
+                    seg.language = lang;
+                    out.push_back(std::move(seg));
+                }
+            } else {
+                fprintf(stderr, "warning: batch: %s: whisper_full() failed on chunk %zu\n",
+                        file.input.c_str(), chunk_index);
             }
         }
-        else if (arg == "--capture-name") {
-            if (!take_option_value(argc, argv, i, "--capture-name", raw)) return parse_result::error;
-            p.capture_name = raw;
+        if (file.remaining.fetch_sub(1) == 1) {
+            finish(file);
         }
-        else if (arg == "--language") {
-            if (!take_option_value(argc, argv, i, "--language", raw)) return parse_result::error;
-            p.language = raw;
+    }
+
+    void finish(batch_file & file) {
+        if (!g_running) return;   // interrupted: never write a partial transcript
+
+        std::vector<batch_segment> segments;
+        for (auto & r : file.results) {
+            for (auto & seg : r) segments.push_back(std::move(seg));
         }
-        else if (arg == "--vad-thold") {
-            if (!take_option_value(argc, argv, i, "--vad-thold", raw)) return parse_result::error;
-            if (!parse_float_arg("--vad-thold", raw, p.vad_thold, 0.0f, 1.0f)) return parse_result::error;
+        const size_t dropped = filter_batch_segments(segments);
+        const int64_t audio_ms = (int64_t)(file.pcm.size() * 1000 / WHISPER_SAMPLE_RATE);
+        std::vector<float>().swap(file.pcm);
+        file.results.clear();
+
+        std::string error;
+        if (!write_batch_transcript(file.output, par_.batch_output_format, segments, error)) {
+            fprintf(stderr, "error: batch: cannot write '%s': %s\n", file.output.c_str(), error.c_str());
+            failed_++;
+            return;
         }
-        else if (arg == "--beam-size") {
-            if (!take_option_value(argc, argv, i, "--beam-size", raw)) return parse_result::error;
-            if (!parse_int_arg("--beam-size", raw, p.beam_size, 1, k_max_beam_size)) return parse_result::error;
+        audio_ms_ += audio_ms;
+        segments_ += segments.size();
+        dropped_  += dropped;
+        const double took_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - file.t_start).count();
+        fprintf(stderr, "batch: [%zu/%zu] %s -> %s (%.1f min audio, %zu chunks, %zu segments, %zu dropped, %.1f s)\n",
+                ++done_, files_.size(), file.input.c_str(), file.output.c_str(), audio_ms / 60000.0,
+                file.chunks.size(), segments.size(), dropped, took_s);
+    }
+
+    whisper_context *                        ctx_;
+    const params &                           par_;
+    work_stealing_queue                      queue_;
+    std::vector<whisper_state *>             states_;   // one per worker
+    std::vector<std::unique_ptr<batch_file>> files_;
+
+    std::atomic<int64_t>  audio_ms_{0};
+    std::atomic<size_t>   done_{0};
+    std::atomic<size_t>   failed_{0};
+    std::atomic<uint64_t> segments_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+static int run_batch(const params & par) {
+    std::vector<std::string> inputs;
+    std::string error;
+    if (!expand_batch_inputs(par.batch_inputs, inputs, error)) {
+        fprintf(stderr, "error: --batch: %s\n", error.c_str());
+        return 1;
+    }
+    const size_t n_jobs = par.batch_jobs > 0
+        ? (size_t)par.batch_jobs
+        : (size_t)std::max(1, (int)std::thread::hardware_concurrency() / std::max(1, par.n_threads));
+
+    fprintf(stderr, "\n");
+    fprintf(stderr, "model:    %s\n", par.model.c_str());
+    fprintf(stderr, "batch:    %zu files -> %s (%s)\n", inputs.size(),
+            par.batch_out.empty() ? "next to each input" : par.batch_out.c_str(),
+            batch_format_extension(par.batch_output_format));
+    fprintf(stderr, "jobs:     %zu x %d threads, chunks of %d ms\n", n_jobs, par.n_threads, par.batch_chunk_ms);
+    fprintf(stderr, "language: %s\n", par.language.c_str());
+    fprintf(stderr, "\n");
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    ggml_backend_load_all();
+    struct whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu    = par.use_gpu;
+    cparams.flash_attn = par.flash_attn;
+    model_load_stats stats;
+    whisper_context * ctx = load_whisper_model(par.model, par.model_loader, cparams, stats);
+    if (!ctx) {
+        fprintf(stderr, "error: failed to load model '%s'\n", par.model.c_str());
+        return 1;
+    }
+    fprintf(stderr, "model load: %s\n\n", stats.describe().c_str());
+
+    size_t failed = 0;
+    {
+        batch_runner runner(ctx, par, n_jobs);
+        if (!runner.init(inputs)) {
+            whisper_free(ctx);
+            return 1;
         }
-        else if (arg == "--max-tokens") {
-            if (!take_option_value(argc, argv, i, "--max-tokens", raw)) return parse_result::error;
-            if (!parse_int_arg("--max-tokens", raw, p.max_tokens, 0, 1024)) return parse_result::error;
+        failed = runner.run();
+    }
+    whisper_free(ctx);
+
+    if (!g_running) {
+        fprintf(stderr, "batch: interrupted\n");
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// Model fallback tiers (--fallback-models)
+// ---------------------------------------------------------------------------
+
+// Load shedding across a chain of models, tier 0 being --model and each
+// following tier a cheaper fallback. The main loop reports the real-time
+// factor (whisper_full time / step) of every inference:
+//
+//  - down: when the mean RTF over the last k_rtf_window inferences exceeds
+//    rtf_high, the next tier is used. Lazy tiers are loaded (and warmed up)
+//    on a background thread the first time they are needed and stay
+//    resident afterwards; the current tier keeps running meanwhile.
+//  - up: when the RTF the upper tier would have, estimated from the ratio
+//    of the tiers' warmup times, drops below rtf_low and the current tier
+//    has been used for at least the dwell time. A promotion that is undone
+//    within k_probation_ms doubles the dwell time (flap back-off).
+class model_fallback {
+public:
+    static constexpr int     k_rtf_window    = 8;
+    static constexpr int64_t k_min_dwell_ms  = 10000;
+    static constexpr int64_t k_max_dwell_ms  = 600000;
+    static constexpr int64_t k_probation_ms  = 60000;
+
+    // Construct on the main thread before it moves to --infer-cpus: lazy
+    // loads then run on the mask it has now (the http/service CPUs), not on
+    // the cores the current tier is inferring on.
+    model_fallback(const params & par, whisper_context_params cparams)
+        : cparams_(cparams), loader_(par.model_loader),
+          loader_cpus_(par.infer_cpus.empty() ? std::vector<int>() : allowed_cpus()),
+          rtf_high_(par.fallback_rtf_high), rtf_low_(par.fallback_rtf_low) {
+        tiers_.emplace_back(std::make_unique<tier>());
+        tiers_[0]->path = par.model;
+        for (const std::string & path : par.fallback_models) {
+            tiers_.emplace_back(std::make_unique<tier>());
+            tiers_.back()->path = path;
         }
-        else if (arg == "--temperature-inc") {
-            if (!take_option_value(argc, argv, i, "--temperature-inc", raw)) return parse_result::error;
-            if (!parse_float_arg("--temperature-inc", raw, p.temperature_inc, 0.0f, 2.0f)) return parse_result::error;
+    }
+
+    // The primary context stays owned by main().
+    ~model_fallback() {
+        for (size_t i = 1; i < tiers_.size(); ++i) {
+            if (tiers_[i]->loader.joinable()) tiers_[i]->loader.join();
+            if (whisper_context * ctx = tiers_[i]->ctx.load()) whisper_free(ctx);
         }
-        else if (arg == "--no-vad") {
-            p.use_vad = false;
+    }
+
+    bool enabled() const { return tiers_.size() > 1; }
+
+    // Model thread, once --model is loaded.
+    void set_primary(whisper_context * ctx) { tiers_[0]->ctx = ctx; }
+
+    // --fallback-resident: load every tier up front (model thread).
+    bool load_all() {
+        for (size_t i = 1; i < tiers_.size(); ++i) {
+            model_load_stats stats;
+            whisper_context * ctx = load_whisper_model(tiers_[i]->path, loader_, cparams_, stats);
+            if (!ctx) {
+                fprintf(stderr, "error: failed to load fallback model '%s'\n", tiers_[i]->path.c_str());
+                return false;
+            }
+            fprintf(stderr, "fallback: tier %zu: %s\n", i, stats.describe().c_str());
+            tiers_[i]->ctx = ctx;
         }
-        else if (arg == "--translate-url") {
-            if (!take_option_value(argc, argv, i, "--translate-url", raw)) return parse_result::error;
-            p.translate_url = raw;
+        return true;
+    }
+
+    // Warmup time of a tier, the basis of the cost ratio between tiers.
+    void set_warmup_ms(size_t t, double ms) {
+        if (t < tiers_.size()) tiers_[t]->warmup_ms = ms;
+    }
+
+    size_t tier_count() const { return tiers_.size(); }
+    whisper_context * context(size_t t) const { return tiers_[t]->ctx.load(); }
+
+    // Main loop only.
+    whisper_context * active() const { return tiers_[active_]->ctx.load(); }
+    int active_tier() const { return (int)active_; }
+
+    // Main loop, after every inference.
+    void record(double infer_ms, const params & par) {
+        const double rtf = infer_ms / std::max(1, par.step_ms);
+        window_[n_window_++ % k_rtf_window] = rtf;
+        if (n_window_ < (size_t)k_rtf_window) {
+            rtf_mean_.store(rtf, std::memory_order_relaxed);
+            return;
         }
-        else if (arg == "--no-gpu")         { p.use_gpu    = false; }
-        else if (arg == "--no-flash-attn")  { p.flash_attn = false; }
-        else if (arg == "-h" || arg == "--help") { print_usage(argv[0]); return parse_result::help; }
-        else {
-            fprintf(stderr, "error: unknown option: %s\n", arg.c_str());
-            print_usage(argv[0]);
-            return parse_result::error;
+
+        double mean = 0.0;
+        for (double v : window_) mean += v;
+        mean /= k_rtf_window;
+        rtf_mean_.store(mean, std::memory_order_relaxed);
+
+        const int64_t now = steady_ms();
+        if (mean > rtf_high_) {
+            for (size_t t = active_ + 1; t < tiers_.size(); ++t) {
+                tier & next = *tiers_[t];
+                if (next.failed) continue;
+                if (next.ctx.load()) {
+                    if (now - last_promotion_ms_ < k_probation_ms) {
+                        dwell_ms_ = std::min(dwell_ms_ * 2, k_max_dwell_ms);
+                    } else {
+                        dwell_ms_ = k_min_dwell_ms;
+                    }
+                    switch_to(t, mean, now);
+                } else if (!next.loading) {
+                    start_loading(t, par);
+                }
+                break;
+            }
+        } else if (active_ > 0 && now - last_switch_ms_ >= dwell_ms_) {
+            const double cur_cost = tiers_[active_]->warmup_ms;
+            const double up_cost  = tiers_[active_ - 1]->warmup_ms;
+            const double predicted = cur_cost > 0.0 && up_cost > 0.0 ? mean * up_cost / cur_cost : mean;
+            if (predicted < rtf_low_) {
+                last_promotion_ms_ = now;
+                switch_to(active_ - 1, mean, now);
+            }
         }
     }
-    return parse_result::ok;
-}
+
+    // Any thread (metrics).
+    std::string to_json() const {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "{\"tier\":%d,\"rtf\":%.3f,\"switches\":%llu,\"tiers\":[",
+                 active_tier_.load(), rtf_mean_.load(), (unsigned long long)n_switches_.load());
+        std::string json = buf;
+        for (size_t i = 0; i < tiers_.size(); ++i) {
+            if (i > 0) json += ",";
+            json += "{" + json_str("model", tiers_[i]->path) +
+                    "," + json_bool("loaded", tiers_[i]->ctx.load() != nullptr) +
+                    "," + json_bool("failed", tiers_[i]->failed.load()) + "}";
+        }
+        return json + "]}";
+    }
+
+private:
+    struct tier {
+        std::string                    path;
+        std::atomic<whisper_context *> ctx{nullptr};
+        std::atomic<bool>              loading{false};
+        std::atomic<bool>              failed{false};
+        std::thread                    loader;
+        double                         warmup_ms = 0.0;
+    };
+
+    static int64_t steady_ms() {
+        return (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void switch_to(size_t t, double mean, int64_t now) {
+        log_write(log_level::info, "fallback", "tier %zu -> %zu (%s), rtf %.2f",
+                  active_, t, tiers_[t]->path.c_str(), mean);
+        active_ = t;
+        active_tier_.store((int)t, std::memory_order_relaxed);
+        n_switches_.fetch_add(1, std::memory_order_relaxed);
+        last_switch_ms_ = now;
+        n_window_ = 0;
+    }
+
+    // Loads and warms up a tier next to the running one; the main loop
+    // picks it up on a later record() once ctx is set.
+    void start_loading(size_t t, const params & par) {
+        tier & target = *tiers_[t];
+        if (target.loader.joinable()) target.loader.join();
+        target.loading = true;
+        log_write(log_level::info, "fallback", "loading tier %zu (%s)", t, target.path.c_str());
+
+        target.loader = std::thread([this, &target, t, par]() {
+            if (!loader_cpus_.empty()) {
+                std::string error;
+                if (!pin_current_thread(loader_cpus_, error)) {
+                    log_write(log_level::warn, "fallback", "loader affinity not applied: %s", error.c_str());
+                }
+            }
+            model_load_stats stats;
+            whisper_context * ctx = load_whisper_model(target.path, loader_, cparams_, stats);
+            if (!ctx) {
+                log_write(log_level::warn, "fallback", "failed to load '%s'", target.path.c_str());
+                target.failed = true;
+                target.loading = false;
+                return;
+            }
+            log_write(log_level::info, "fallback", "tier %zu: %s", t, stats.describe().c_str());
+            const std::vector<float> silence(WHISPER_SAMPLE_RATE, 0.0f);
+            const whisper_full_params wparams = make_whisper_params(par, par.language.c_str());
+            const auto t0 = std::chrono::steady_clock::now();
+            whisper_full(ctx, wparams, silence.data(), (int)silence.size());
+            target.warmup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            target.ctx = ctx;
+            target.loading = false;
+        });
+    }
+
+    whisper_context_params                cparams_;
+    std::string                           loader_;
+    std::vector<int>                      loader_cpus_;   // empty: keep the inherited mask
+    float                                 rtf_high_;
+    float                                 rtf_low_;
+    std::vector<std::unique_ptr<tier>>    tiers_;
+
+    // Main loop only.
+    size_t                                active_ = 0;
+    std::array<double, k_rtf_window>      window_{};
+    size_t                                n_window_ = 0;
+    int64_t                               last_switch_ms_ = 0;
+    int64_t                               last_promotion_ms_ = std::numeric_limits<int64_t>::min() / 2;
+    int64_t                               dwell_ms_ = k_min_dwell_ms;
+
+    std::atomic<int>                      active_tier_{0};
+    std::atomic<double>                   rtf_mean_{0.0};
+    std::atomic<uint64_t>                 n_switches_{0};
+};
 
 // ---------------------------------------------------------------------------
-// Signal handling
+// Worker fleet (--workers)
 // ---------------------------------------------------------------------------
 
-static std::atomic<bool> g_running{true};
+// With --workers N this process (the front) runs no inference. It serves
+// HTTP and supervises N worker processes, each this binary again with
+// --worker-shm, and gives every ingest session (?session=ID) a worker of
+// its own. Audio travels to the worker through the slot's shared-memory
+// channel; frames and status come back the same way and are fanned out by
+// the slot's broadcaster. A crashed or hung worker only takes its own
+// session down: the supervisor restarts it with back-off while the other
+// sessions keep running.
+
+static constexpr int64_t k_session_idle_ms        = 60000;   // no viewers, no audio -> slot released
+static constexpr int64_t k_restart_backoff_ms     = 1000;
+static constexpr int64_t k_max_restart_backoff_ms = 30000;
+static constexpr int64_t k_worker_stable_ms       = 60000;   // uptime that resets the back-off
+static constexpr int64_t k_worker_hang_ms         = 30000;   // inference loop silence before a kill
+static constexpr int64_t k_worker_stop_ms         = 5000;    // shutdown grace period
+static constexpr int     k_supervise_interval_ms  = 20;
+
+struct worker_slot {
+    int                             index = 0;
+    std::unique_ptr<worker_channel> channel;
+    sse_broadcaster                 broadcaster;
+    latency_tracker                 latency;
+
+    std::atomic<int>     pid{-1};
+    std::atomic<int>     restarts{0};
+    std::atomic<bool>    streaming{false};      // an /api/ingest request is feeding the slot
+    std::atomic<int64_t> last_active_ms{0};
+
+    // Supervisor thread only.
+    int64_t  started_ms    = 0;
+    int64_t  next_spawn_ms = 0;
+    int64_t  backoff_ms    = k_restart_backoff_ms;
+
+    // Frames reach the broadcaster from the supervisor (worker output) and
+    // from acquire() (the blank frame of a new session).
+    std::mutex publish_mtx;
+    uint64_t   version = 0;   // frame versions as viewers see them, continuous across restarts
+
+    // Guarded by worker_fleet::mtx_.
+    std::string session;
+    std::string source_lang;
+    std::string target_lang;
+};
 
-static void signal_handler(int) {
-    g_running = false;
+// handle_ingest() sink writing into a worker's audio ring.
+struct worker_ingest_sink {
+    worker_slot & slot;
+
+    bool begin_stream() {
+        bool expected = false;
+        return slot.streaming.compare_exchange_strong(expected, true);
+    }
+
+    void write(const float * samples, size_t n) {
+        slot.channel->write_audio(samples, n);
+        slot.last_active_ms = unix_time_ms();
+    }
+
+    void end_stream() {
+        slot.streaming = false;
+        slot.last_active_ms = unix_time_ms();
+    }
+};
+
+static bool is_valid_session_id(const std::string & id) {
+    if (id.empty() || id.size() > 64) return false;
+    for (const char c : id) {
+        if (!std::isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') return false;
+    }
+    return true;
+}
+
+class worker_fleet {
+public:
+    worker_fleet(const params & par, std::vector<std::string> worker_args)
+        : par_(par), worker_args_(std::move(worker_args)) {}
+
+    // Creates the channels and broadcasters; workers are spawned by the
+    // first supervise().
+    bool start() {
+        const std::string prefix = "/live-subtitle-" + std::to_string((int)getpid()) + "-";
+        for (int i = 0; i < par_.workers; ++i) {
+            auto slot = std::make_unique<worker_slot>();
+            slot->index = i;
+            std::string error;
+            slot->channel = worker_channel::create(prefix + std::to_string(i), i, error);
+            if (!slot->channel) {
+                fprintf(stderr, "error: fleet: worker %d channel: %s\n", i, error.c_str());
+                return false;
+            }
+            if (!slot->broadcaster.start()) {
+                fprintf(stderr, "error: failed to start SSE broadcaster\n");
+                return false;
+            }
+            slot->broadcaster.publish_status(build_status_event("loading", "model"));
+            slots_.push_back(std::move(slot));
+        }
+        return true;
+    }
+
+    // The slot serving `session`, assigning an idle one to a new session;
+    // nullptr when every worker is taken.
+    worker_slot * acquire(const std::string & session) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        worker_slot * best = nullptr;
+        for (const auto & slot : slots_) {
+            if (slot->session == session) {
+                slot->last_active_ms = unix_time_ms();
+                return slot.get();
+            }
+            if (!slot->session.empty()) continue;
+            // Prefer a worker that is already warm, then the least loaded.
+            if (!best ||
+                (slot->channel->worker_ready() && !best->channel->worker_ready()) ||
+                (slot->channel->worker_ready() == best->channel->worker_ready() &&
+                 slot->channel->load_permille() < best->channel->load_permille())) {
+                best = slot.get();
+            }
+        }
+        if (!best) return nullptr;
+
+        best->session     = session;
+        best->source_lang = par_.language;
+        best->target_lang.clear();
+        best->channel->set_languages(best->source_lang, best->target_lang);
+        best->channel->begin_session();
+        best->last_active_ms = unix_time_ms();
+        // Until the worker's first step, /events would replay the previous
+        // session's last subtitle to the new session's viewers.
+        publish_frame(*best, subtitle_frame());
+        fprintf(stderr, "fleet: session '%s' -> worker %d\n", session.c_str(), best->index);
+        return best;
+    }
+
+    // The slot already serving `session`; nullptr when it has none.
+    worker_slot * find(const std::string & session) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const auto & slot : slots_) {
+            if (slot->session == session) return slot.get();
+        }
+        return nullptr;
+    }
+
+    bool set_languages(worker_slot & slot, const config_update_payload & payload) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const std::string source = payload.has_source_lang ? payload.source_lang : slot.source_lang;
+        const std::string target = payload.has_target_lang ? payload.target_lang : slot.target_lang;
+        if (!slot.channel->set_languages(source, target)) return false;
+        slot.source_lang = source;
+        slot.target_lang = target;
+        return true;
+    }
+
+    std::string config_json(const worker_slot & slot) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return "{" + json_str("source_lang", slot.source_lang) +
+               "," + json_str("target_lang", slot.target_lang) +
+               "," + json_bool("translate_enabled", !par_.translate_url.empty()) + "}";
+    }
+
+    // 1/0 once any worker has loaded the model, -1 before.
+    int model_multilingual() const {
+        for (const auto & slot : slots_) {
+            const int m = slot->channel->model_multilingual();
+            if (m >= 0) return m;
+        }
+        return -1;
+    }
+
+    std::string to_json() {
+        const int64_t now = unix_time_ms();
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t sessions = 0;
+        std::string json = "{\"workers\":[";
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            const worker_slot & slot = *slots_[i];
+            const worker_channel & ch = *slot.channel;
+            const int64_t heartbeat = ch.heartbeat_ms();
+            if (!slot.session.empty()) ++sessions;
+            if (i > 0) json += ",";
+            json += "{\"index\":" + std::to_string(slot.index) +
+                    ",\"pid\":" + std::to_string(slot.pid.load()) +
+                    "," + json_str("session", slot.session) +
+                    "," + json_bool("ready", ch.worker_ready()) +
+                    ",\"restarts\":" + std::to_string(slot.restarts.load()) +
+                    ",\"load_permille\":" + std::to_string(ch.load_permille()) +
+                    ",\"steps\":" + std::to_string(ch.steps()) +
+                    ",\"backlog_ms\":" + std::to_string(ch.audio_backlog_samples() * 1000 / WHISPER_SAMPLE_RATE) +
+                    ",\"overflow_samples\":" + std::to_string(ch.audio_overflow_samples()) +
+                    ",\"dropped_messages\":" + std::to_string(ch.dropped_messages()) +
+                    ",\"heartbeat_age_ms\":" + std::to_string(heartbeat > 0 ? now - heartbeat : -1) +
+                    ",\"sse\":{\"clients\":" + std::to_string(slot.broadcaster.client_count()) +
+                    ",\"dropped\":" + std::to_string(slot.broadcaster.dropped_count()) + "}" +
+                    ",\"latency\":" + slot.latency.to_json() + "}";
+        }
+        json += "],\"sessions\":" + std::to_string(sessions) +
+                ",\"capacity\":" + std::to_string(slots_.size()) + "}";
+        return json;
+    }
+
+    // One supervisor tick: forward worker output, reap and restart dead
+    // workers, kill hung ones, release idle sessions.
+    void supervise() {
+        const int64_t now = unix_time_ms();
+        for (const auto & slot : slots_) {
+            forward_messages(*slot);
+
+            const int pid = slot->pid.load();
+            if (pid > 0) {
+                int status = 0;
+                if (waitpid(pid, &status, WNOHANG) == pid) {
+                    on_worker_exit(*slot, status, now);
+                } else {
+                    const int64_t heartbeat = slot->channel->heartbeat_ms();
+                    if (heartbeat > 0 && now - heartbeat > k_worker_hang_ms) {
+                        fprintf(stderr, "fleet: worker %d (pid %d) unresponsive for %lld ms, killing\n",
+                                slot->index, pid, (long long)(now - heartbeat));
+                        kill(pid, SIGKILL);
+                        slot->channel->reset_worker_state();   // don't kill it twice
+                    }
+                }
+            } else if (now >= slot->next_spawn_ms) {
+                spawn(*slot, now);
+            }
+
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!slot->session.empty() && slot->broadcaster.client_count() == 0 && !slot->streaming &&
+                now - slot->last_active_ms.load() > k_session_idle_ms) {
+                fprintf(stderr, "fleet: session '%s' idle, worker %d released\n",
+                        slot->session.c_str(), slot->index);
+                slot->session.clear();
+            }
+        }
+    }
+
+    // Asks every worker to exit, then kills the ones that don't.
+    void stop() {
+        for (const auto & slot : slots_) {
+            slot->channel->request_shutdown();
+        }
+        const int64_t deadline = unix_time_ms() + k_worker_stop_ms;
+        while (true) {
+            bool any_alive = false;
+            for (const auto & slot : slots_) {
+                const int pid = slot->pid.load();
+                if (pid <= 0) continue;
+                int status = 0;
+                if (waitpid(pid, &status, WNOHANG) == pid) {
+                    slot->pid = -1;
+                } else {
+                    any_alive = true;
+                }
+            }
+            if (!any_alive) break;
+            if (unix_time_ms() >= deadline) {
+                for (const auto & slot : slots_) {
+                    const int pid = slot->pid.load();
+                    if (pid <= 0) continue;
+                    fprintf(stderr, "fleet: worker %d (pid %d) did not exit, killing\n", slot->index, pid);
+                    kill(pid, SIGKILL);
+                    waitpid(pid, nullptr, 0);
+                    slot->pid = -1;
+                }
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(k_supervise_interval_ms));
+        }
+        for (const auto & slot : slots_) {
+            slot->broadcaster.stop();
+        }
+    }
+
+private:
+    static void publish_frame(worker_slot & slot, subtitle_frame frame) {
+        std::lock_guard<std::mutex> lock(slot.publish_mtx);
+        frame.version = ++slot.version;
+        if (frame.timing.capture_ms > 0) slot.latency.record_published(frame.version, frame.timing);
+        slot.broadcaster.publish(std::move(frame));
+    }
+
+    void forward_messages(worker_slot & slot) {
+        worker_message type;
+        while (slot.channel->read_message(type, payload_)) {
+            if (type == worker_message::frame) {
+                if (!decode_frame(payload_, frame_)) continue;
+                publish_frame(slot, std::move(frame_));
+            } else if (type == worker_message::status) {
+                slot.broadcaster.publish_status(payload_);
+            }
+        }
+    }
+
+    void spawn(worker_slot & slot, int64_t now) {
+        std::vector<std::string> args = worker_args_;
+        args.push_back("--worker-shm");
+        args.push_back(slot.channel->name());
+
+        std::string error;
+        const pid_t pid = spawn_process(current_executable_path(args[0].c_str()), args, error);
+        if (pid < 0) {
+            fprintf(stderr, "fleet: worker %d: spawn failed: %s (retry in %lld ms)\n",
+                    slot.index, error.c_str(), (long long)slot.backoff_ms);
+            schedule_restart(slot, now);
+            return;
+        }
+        slot.pid        = (int)pid;
+        slot.started_ms = now;
+        fprintf(stderr, "fleet: worker %d started (pid %d)\n", slot.index, (int)pid);
+    }
+
+    void on_worker_exit(worker_slot & slot, int status, int64_t now) {
+        const int pid = slot.pid.exchange(-1);
+        if (WIFSIGNALED(status)) {
+            fprintf(stderr, "fleet: worker %d (pid %d) killed by signal %d", slot.index, pid, WTERMSIG(status));
+        } else {
+            fprintf(stderr, "fleet: worker %d (pid %d) exited with status %d", slot.index, pid, WEXITSTATUS(status));
+        }
+        if (now - slot.started_ms >= k_worker_stable_ms) {
+            slot.backoff_ms = k_restart_backoff_ms;
+        }
+        fprintf(stderr, ", restarting in %lld ms\n", (long long)slot.backoff_ms);
+        slot.restarts++;
+
+        // Whatever the dead worker left unread is stale; its session stays
+        // on the slot and its viewers see the restart.
+        slot.channel->reset_worker_state();
+        slot.broadcaster.publish_status(build_status_event("loading", "restart"));
+        schedule_restart(slot, now);
+    }
+
+    void schedule_restart(worker_slot & slot, int64_t now) {
+        slot.next_spawn_ms = now + slot.backoff_ms;
+        slot.backoff_ms    = std::min(2 * slot.backoff_ms, k_max_restart_backoff_ms);
+    }
+
+    const params &                            par_;
+    const std::vector<std::string>            worker_args_;
+    std::vector<std::unique_ptr<worker_slot>> slots_;
+    std::mutex                                mtx_;
+
+    // Supervisor scratch.
+    std::string    payload_;
+    subtitle_frame frame_;
+};
+
+// ?session=ID, "default" when absent; empty if invalid.
+static std::string session_of(const httplib::Request & req) {
+    const std::string id = req.has_param("session") ? req.get_param_value("session") : "default";
+    return is_valid_session_id(id) ? id : std::string();
+}
+
+// Looks up (or assigns) the request's worker; answers 400/503 itself when
+// there is none. Only the routes that start a session (/events,
+// /api/ingest) assign one.
+static worker_slot * slot_for_request(worker_fleet & fleet, const httplib::Request & req,
+                                      httplib::Response & res) {
+    const std::string session = session_of(req);
+    if (session.empty()) {
+        res.status = 400;
+        res.set_content("{\"ok\":false,\"error\":\"invalid session\"}", "application/json");
+        return nullptr;
+    }
+    worker_slot * slot = fleet.acquire(session);
+    if (!slot) {
+        res.status = 503;
+        res.set_header("Retry-After", "5");
+        res.set_content("{\"ok\":false,\"error\":\"no free worker\"}", "application/json");
+    }
+    return slot;
+}
+
+// The worker of an existing session; answers 400/404 itself when there is
+// none, so a request naming an unknown session cannot take a worker.
+static worker_slot * session_slot(worker_fleet & fleet, const httplib::Request & req,
+                                  httplib::Response & res) {
+    const std::string session = session_of(req);
+    if (session.empty()) {
+        res.status = 400;
+        res.set_content("{\"ok\":false,\"error\":\"invalid session\"}", "application/json");
+        return nullptr;
+    }
+    worker_slot * slot = fleet.find(session);
+    if (!slot) {
+        res.status = 404;
+        res.set_content("{\"ok\":false,\"error\":\"unknown session\"}", "application/json");
+    }
+    return slot;
+}
+
+static int run_fleet(const params & par, int argc, char ** argv) {
+    fprintf(stderr, "\n");
+    fprintf(stderr, "model:    %s\n", par.model.c_str());
+    fprintf(stderr, "workers:  %d (one ingest session each)\n", par.workers);
+    fprintf(stderr, "audio:    POST /api/ingest?session=ID (jitter %d ms)\n", par.ingest_jitter_ms);
+    fprintf(stderr, "language: %s\n", par.language.c_str());
+    fprintf(stderr, "\n");
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    worker_fleet fleet(par, std::vector<std::string>(argv, argv + argc));
+    if (!fleet.start()) {
+        fleet.stop();
+        return 1;
+    }
+
+    handoff_server svr;
+
+    for (const web_asset * asset = web_assets_begin(); asset != web_assets_end(); ++asset) {
+        svr.Get(route_pattern_for_path(asset->path),
+                [asset](const httplib::Request & req, httplib::Response & res) {
+            serve_web_asset(*asset, req, res);
+        });
+    }
+
+    svr.Get("/events", [&fleet](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        worker_slot * slot = slot_for_request(fleet, req, res);
+        if (!slot) return;
+
+        const sse_mode mode = req.get_param_value("mode") == "delta" ? sse_mode::delta : sse_mode::full;
+
+        res.set_chunked_content_provider("text/event-stream",
+            [slot, mode](size_t /*offset*/, httplib::DataSink & /*sink*/) {
+                slot->broadcaster.add_client(handoff_server::take_current_socket(), mode);
+                return false;
+            }
+        );
+    });
+
+    svr.Post("/api/ingest", [&fleet](const httplib::Request & req, httplib::Response & res,
+                                     const httplib::ContentReader & content_reader) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        worker_slot * slot = slot_for_request(fleet, req, res);
+        if (!slot) return;
+        worker_ingest_sink sink{*slot};
+        handle_ingest(sink, req, res, content_reader);
+    });
+
+    svr.Get("/api/languages", [&par](const httplib::Request &, httplib::Response & res) {
+        serve_translate_languages(par.translate_url, res);
+    });
+
+    svr.Get("/api/source-languages", [&fleet](const httplib::Request &, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        const int multilingual = fleet.model_multilingual();
+        if (multilingual < 0) {
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content("{\"ok\":false,\"error\":\"loading\"}", "application/json");
+            return;
+        }
+        res.set_content(build_source_languages_json(multilingual != 0), "application/json");
+    });
+
+    svr.Get("/api/config", [&fleet](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        worker_slot * slot = session_slot(fleet, req, res);
+        if (!slot) return;
+        res.set_content(fleet.config_json(*slot), "application/json");
+    });
+
+    // Only the session's languages can change; inference settings are
+    // per process and fixed by the command line in a fleet.
+    svr.Post("/api/config", [&fleet](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        config_update_payload payload;
+        if (!parse_config_update_payload(req.body, payload)) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"invalid config\"}", "application/json");
+            return;
+        }
+        if (payload.has_number_field()) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"inference settings are fixed with --workers\"}",
+                            "application/json");
+            return;
+        }
+        if (payload.has_source_lang && !is_valid_source_lang(payload.source_lang)) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"invalid source_lang\"}", "application/json");
+            return;
+        }
+        worker_slot * slot = session_slot(fleet, req, res);
+        if (!slot) return;
+        if (!fleet.set_languages(*slot, payload)) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"invalid target_lang\"}", "application/json");
+            return;
+        }
+        res.set_content("{\"ok\":true}", "application/json");
+    });
+
+    svr.Post("/api/latency", [&fleet](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        latency_beacon_payload beacon;
+        if (!parse_latency_beacon_payload(req.body, beacon)) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"invalid beacon\"}", "application/json");
+            return;
+        }
+        worker_slot * slot = session_slot(fleet, req, res);
+        if (!slot) return;
+        slot->latency.record_beacon(beacon.version, beacon.receive_ms);
+        res.status = 204;
+    });
+
+    auto serve_workers = [&fleet](const httplib::Request &, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_content(fleet.to_json(), "application/json");
+    };
+    svr.Get("/api/workers", serve_workers);
+    svr.Get("/api/metrics", serve_workers);
+
+    std::thread server_thread([&svr, &par]() {
+        svr.listen("0.0.0.0", par.port);
+    });
+    svr.wait_until_ready();
+    if (!svr.is_running()) {
+        fprintf(stderr, "error: failed to listen on port %d\n", par.port);
+        server_thread.join();
+        fleet.stop();
+        return 1;
+    }
+    fprintf(stderr, "listening on http://localhost:%d (%d workers)\n\n", par.port, par.workers);
+
+    while (g_running) {
+        fleet.supervise();
+        std::this_thread::sleep_for(std::chrono::milliseconds(k_supervise_interval_ms));
+    }
+
+    fprintf(stderr, "\nshutting down...\n");
+    svr.stop();
+    server_thread.join();
+    fleet.stop();
+    return 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -1183,7 +2030,11 @@ static void signal_handler(int) {
 // ---------------------------------------------------------------------------
 
 int main(int argc, char ** argv) {
-    ggml_backend_load_all();
+    const auto t_process_start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [](std::chrono::steady_clock::time_point since) {
+        return (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - since).count();
+    };
 
     params par;
     const parse_result parsed = parse_params(argc, argv, par);
@@ -1193,62 +2044,95 @@ int main(int argc, char ** argv) {
     if (parsed == parse_result::error) {
         return 1;
     }
-    if (!is_valid_source_lang(par.language)) {
-        fprintf(stderr, "error: unknown language '%s'\n", par.language.c_str());
+    log_configure(par.log_min_level, par.log_output);
+    if (!is_valid_source_lang(par.language)) {
+        fprintf(stderr, "error: unknown language '%s'\n", par.language.c_str());
+        return 1;
+    }
+    if (par.capture_id >= 0 && !par.capture_name.empty()) {
+        fprintf(stderr, "error: --capture and --capture-name are mutually exclusive\n");
+        return 1;
+    }
+    if (par.ingest && (par.capture_id >= 0 || !par.capture_name.empty())) {
+        fprintf(stderr, "error: --ingest cannot be combined with --capture/--capture-name\n");
+        return 1;
+    }
+    if (par.fallback_rtf_low >= par.fallback_rtf_high) {
+        fprintf(stderr, "error: --fallback-rtf-low must be below --fallback-rtf-high\n");
         return 1;
     }
-    if (par.capture_id >= 0 && !par.capture_name.empty()) {
-        fprintf(stderr, "error: --capture and --capture-name are mutually exclusive\n");
+    if (!par.batch_inputs.empty()) {
+        if (par.ingest || par.workers > 0) {
+            fprintf(stderr, "error: --batch cannot be combined with --ingest/--workers\n");
+            return 1;
+        }
+        return run_batch(par);
+    }
+    if (par.workers > 0 && (par.capture_id >= 0 || !par.capture_name.empty())) {
+        fprintf(stderr, "error: --workers cannot be combined with --capture/--capture-name\n");
         return 1;
     }
-    if (!par.capture_name.empty()) {
-        int32_t resolved_capture_id = -1;
-        if (!resolve_capture_id_by_name(par.capture_name, resolved_capture_id)) {
+    if (par.workers > 0 && par.worker_shm.empty()) {
+        return run_fleet(par, argc, argv);
+    }
+
+    // A fleet worker (--worker-shm, started by the --workers front) gets its
+    // audio from the channel and keeps its own history/recordings/trace.
+    std::unique_ptr<worker_channel> channel;
+    if (!par.worker_shm.empty()) {
+        std::string error;
+        channel = worker_channel::open(par.worker_shm, error);
+        if (!channel) {
+            fprintf(stderr, "error: worker channel '%s': %s\n", par.worker_shm.c_str(), error.c_str());
             return 1;
         }
-        par.capture_id = resolved_capture_id;
-        fprintf(stderr, "capture-name: '%s' resolved to --capture %d\n",
-                par.capture_name.c_str(), par.capture_id);
+        const std::string worker_name = "worker-" + std::to_string(channel->index());
+        par.ingest = true;
+        if (!par.history_dir.empty()) par.history_dir += "/" + worker_name;
+        if (!par.record_dir.empty())  par.record_dir  += "/" + worker_name;
+        if (!par.trace_path.empty())  par.trace_path  += "." + worker_name;
     }
 
+    // --keep as given; the effective keep is re-clamped when the step changes.
+    const int32_t requested_keep_ms = par.keep_ms;
     par.keep_ms   = std::min(par.keep_ms,   par.step_ms);
     par.length_ms = std::max(par.length_ms,  par.step_ms);
 
-    const int n_samples_step = (int)(1e-3 * par.step_ms    * WHISPER_SAMPLE_RATE);
-    const int n_samples_len  = (int)(1e-3 * par.length_ms  * WHISPER_SAMPLE_RATE);
-    const int n_samples_keep = (int)(1e-3 * par.keep_ms    * WHISPER_SAMPLE_RATE);
-
-    // ── Whisper context ──────────────────────────────────────────────────
-
-    struct whisper_context_params cparams = whisper_context_default_params();
-    cparams.use_gpu    = par.use_gpu;
-    cparams.flash_attn = par.flash_attn;
-
-    struct whisper_context * ctx = whisper_init_from_file_with_params(par.model.c_str(), cparams);
-    if (!ctx) {
-        fprintf(stderr, "error: failed to load model '%s'\n", par.model.c_str());
-        return 1;
-    }
-
-    // ── SDL audio capture ────────────────────────────────────────────────
+    int n_samples_step = (int)(1e-3 * par.step_ms    * WHISPER_SAMPLE_RATE);
+    int n_samples_len  = (int)(1e-3 * par.length_ms  * WHISPER_SAMPLE_RATE);
+    int n_samples_keep = (int)(1e-3 * par.keep_ms    * WHISPER_SAMPLE_RATE);
 
-    audio_async audio(par.length_ms);
-    if (!audio.init(par.capture_id, WHISPER_SAMPLE_RATE)) {
-        fprintf(stderr, "error: audio.init() failed\n");
-        whisper_free(ctx);
-        return 1;
-    }
-    audio.resume();
+    const int32_t audio_buffer_ms = par.ingest ? std::max(k_min_audio_buffer_ms, 4 * par.length_ms)
+                                               : std::max(k_min_audio_buffer_ms, par.length_ms);
 
     fprintf(stderr, "\n");
     fprintf(stderr, "model:    %s\n", par.model.c_str());
+    if (channel) {
+        fprintf(stderr, "audio:    worker %d of the --workers front (jitter %d ms)\n",
+                channel->index(), par.ingest_jitter_ms);
+    } else if (par.ingest) {
+        fprintf(stderr, "audio:    POST /api/ingest (jitter %d ms)\n", par.ingest_jitter_ms);
+    }
     fprintf(stderr, "language: %s\n", par.language.c_str());
+    if (par.lang_detect != lang_detect_mode::step) {
+        fprintf(stderr, "detect:   %s (re-identify after %d ms, min p %.2f)\n",
+                lang_detect_mode_name(par.lang_detect), par.lang_redetect_ms, par.lang_min_prob);
+    }
+    fprintf(stderr, "gate:     no-speech %.2f, min confidence %.2f, translate %.2f\n",
+            par.no_speech_thold, par.min_confidence, par.translate_min_confidence);
     fprintf(stderr, "step:     %d ms\n", par.step_ms);
     fprintf(stderr, "length:   %d ms\n", par.length_ms);
     fprintf(stderr, "threads:  %d\n", par.n_threads);
     fprintf(stderr, "beam:     %d\n", par.beam_size);
+    if (par.adaptive_beam > 1) {
+        fprintf(stderr, "adaptive: beam %d when logprob < %.2f or compression > %.2f\n",
+                par.adaptive_beam, par.beam_logprob_thold, par.beam_compression_thold);
+    }
     fprintf(stderr, "max tok:  %d\n", par.max_tokens);
     fprintf(stderr, "temp inc: %.2f\n", par.temperature_inc);
+    if (par.filter.enabled()) {
+        fprintf(stderr, "filter:   %s\n", describe_audio_filter(par.filter).c_str());
+    }
     fprintf(stderr, "\n");
 
     // ── Shared subtitle state ────────────────────────────────────────────
@@ -1261,60 +2145,191 @@ int main(int argc, char ** argv) {
     std::signal(SIGINT,  signal_handler);
     std::signal(SIGTERM, signal_handler);
 
+    // ── CPU affinity / scheduling ────────────────────────────────────────
+
+    // Every service thread (HTTP workers, broadcaster, writers, SDL audio)
+    // is created by this thread from here on, so it takes the service mask
+    // for them to inherit and switches to --infer-cpus right before the
+    // first whisper_full.
+    std::vector<int> service_cpus = par.http_cpus;
+    if (service_cpus.empty() && !par.infer_cpus.empty()) {
+        for (int cpu : allowed_cpus()) {
+            if (!std::binary_search(par.infer_cpus.begin(), par.infer_cpus.end(), cpu)) {
+                service_cpus.push_back(cpu);
+            }
+        }
+    }
+    if (!service_cpus.empty()) {
+        std::string error;
+        if (pin_current_thread(service_cpus, error)) {
+            fprintf(stderr, "affinity: http/service threads on CPUs %s\n", format_cpu_list(service_cpus).c_str());
+        } else {
+            fprintf(stderr, "warning: affinity: http/service CPUs %s not applied: %s\n",
+                    format_cpu_list(service_cpus).c_str(), error.c_str());
+        }
+    }
+    if (par.capture_priority) {
+        if (par.ingest) {
+            fprintf(stderr, "priority: capture thread: n/a with --ingest\n");
+        } else {
+            // SDL raises its capture thread to SDL_THREAD_PRIORITY_HIGH; under
+            // the round-robin policy that becomes a realtime priority (set
+            // directly or through RealtimeKit) where the system permits it.
+            SDL_SetHint(SDL_HINT_THREAD_PRIORITY_POLICY, "rr");
+            fprintf(stderr, "priority: capture thread: SDL realtime (rr) policy requested\n");
+        }
+    }
+
+    // ── Transcript history ───────────────────────────────────────────────
+
+    std::unique_ptr<transcript_log> transcript;
+    if (!par.history_dir.empty()) {
+        transcript = std::make_unique<transcript_log>();
+        if (!transcript->open_dir(par.history_dir)) {
+            return 1;
+        }
+        fprintf(stderr, "history:  %s\n\n", par.history_dir.c_str());
+    }
+
+    // ── Audio recorder ───────────────────────────────────────────────────
+
+    std::unique_ptr<audio_recorder> recorder;
+    if (!par.record_dir.empty()) {
+        recorder = std::make_unique<audio_recorder>(2 * n_samples_step, par.record_keep);
+        if (!recorder->open_dir(par.record_dir)) {
+            return 1;
+        }
+        fprintf(stderr, "record:   %s\n\n", par.record_dir.c_str());
+    }
+
+    // ── Trace ────────────────────────────────────────────────────────────
+
+    if (!par.trace_path.empty()) {
+        if (!trace_start(par.trace_path)) {
+            return 1;
+        }
+        fprintf(stderr, "trace:    %s\n\n", par.trace_path.c_str());
+    }
+
+    // ── Audio source (SDL capture or network ingest) ─────────────────────
+
+    // The network source is needed by the ingest route, so it exists before
+    // the server starts; the SDL device is opened while the model loads.
+    std::unique_ptr<audio_source> audio;
+    network_audio_source * ingest = nullptr;
+    if (par.ingest) {
+        auto net = std::make_unique<network_audio_source>(audio_buffer_ms, par.ingest_jitter_ms);
+        ingest = net.get();
+        audio = std::move(net);
+    }
+
+    // ── Worker channel pump (--worker-shm) ───────────────────────────────
+
+    // Moves the front's audio into the jitter buffer and applies the
+    // session's languages while the main thread is busy loading or
+    // inferring. Exits the process when the front goes away. The heartbeat
+    // comes from the inference loop instead, so a stuck whisper_full stops
+    // it and the front kills the worker.
+    std::thread pump_thread;
+    if (channel) {
+        pump_thread = std::thread([&]() {
+            trace_set_thread_name("worker-pump");
+            std::vector<float> buf(WHISPER_SAMPLE_RATE / 10);
+            uint64_t lang_seq = 0;
+            std::string source_lang;
+            std::string target_lang;
+            while (g_running) {
+                const size_t n = channel->read_audio(buf.data(), buf.size());
+                if (n > 0) {
+                    ingest->write(buf.data(), n);
+                }
+                if (channel->read_languages(lang_seq, source_lang, target_lang)) {
+                    std::lock_guard<std::mutex> lock(state.mtx);
+                    state.source_lang = source_lang.empty() ? par.language : source_lang;
+                    state.target_lang = target_lang;
+                }
+                if (channel->shutdown_requested() || !channel->front_alive()) {
+                    g_running = false;
+                    break;
+                }
+                if (n == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+            }
+        });
+    }
+
+    // ── Runtime-tunable inference settings ──────────────────────────────
+
+    // Written by POST /api/config, picked up by the main loop at the next
+    // step boundary (tuning_version tells it something changed).
+    std::mutex       tuning_mtx;
+    inference_tuning tuning = tuning_from_params(par);
+    uint64_t         tuning_version = 0;
+
+    struct whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu    = par.use_gpu;
+    cparams.flash_attn = par.flash_attn;
+
+    model_fallback fallback(par, cparams);
+
+    latency_tracker latency;
+    startup_report startup;
+
+    // Used whenever the source language is auto (--language or /api/config).
+    language_pin lang_pin(par.lang_detect, par.lang_redetect_ms, par.lang_min_prob);
+
+    confidence_gate conf_gate(par.no_speech_thold, par.min_confidence, par.translate_min_confidence);
+
+    adaptive_beam adaptive(par.adaptive_beam, par.beam_logprob_thold, par.beam_compression_thold);
+
+    std::unique_ptr<transcript_stitcher> stitcher;
+    stitched_translation                 stitched_translations;   // used with stitcher
+    if (par.stitch) {
+        stitcher = std::make_unique<transcript_stitcher>();
+    }
+
+    sse_broadcaster broadcaster;
+    if (!broadcaster.start()) {
+        fprintf(stderr, "error: failed to start SSE broadcaster\n");
+        g_running = false;
+        if (pump_thread.joinable()) pump_thread.join();
+        return 1;
+    }
+    // Workers report status to the front, which owns the viewers.
+    auto publish_status = [&](const char * state_name, const char * phase) {
+        const std::string json = build_status_event(state_name, phase);
+        broadcaster.publish_status(json);
+        if (channel) {
+            channel->write_message(worker_message::status, json);
+        }
+    };
+    publish_status("loading", "model");
+
     // ── HTTP server ──────────────────────────────────────────────────────
 
-    httplib::Server svr;
+    handoff_server svr;
 
-    svr.Get("/", [](const httplib::Request &, httplib::Response & res) {
-        res.set_content(INDEX_HTML, "text/html; charset=utf-8");
-    });
+    for (const web_asset * asset = web_assets_begin(); asset != web_assets_end(); ++asset) {
+        svr.Get(route_pattern_for_path(asset->path),
+                [asset](const httplib::Request & req, httplib::Response & res) {
+            serve_web_asset(*asset, req, res);
+        });
+    }
 
-    svr.Get("/events", [&state](const httplib::Request &, httplib::Response & res) {
+    // The worker only writes the response headers; the stream itself is
+    // handed to the broadcaster thread so viewers don't occupy the pool.
+    // ?mode=delta selects compact prefix/suffix updates (see build_delta_event).
+    svr.Get("/events", [&broadcaster](const httplib::Request & req, httplib::Response & res) {
         res.set_header("Cache-Control", "no-cache");
         res.set_header("Access-Control-Allow-Origin", "*");
 
-        uint64_t client_version = 0;
+        const sse_mode mode = req.get_param_value("mode") == "delta" ? sse_mode::delta : sse_mode::full;
 
         res.set_chunked_content_provider("text/event-stream",
-            [&state, client_version](size_t /*offset*/, httplib::DataSink & sink) mutable {
-                std::string event;
-                uint64_t next_version = client_version;
-                bool running = true;
-
-                {
-                    std::unique_lock<std::mutex> lock(state.mtx);
-
-                    state.cv.wait_for(lock, std::chrono::seconds(15), [&] {
-                        return state.version > client_version || !state.running;
-                    });
-
-                    running = state.running;
-                    if (running && state.version > client_version) {
-                        next_version = state.version;
-                        std::string json = "{" + json_str("text", state.text) +
-                                           "," + json_str("translated", state.translated) +
-                                           "," + json_str("language", state.language) + "}";
-                        event = "data: " + json + "\n\n";
-                    }
-                }
-
-                if (!running) {
-                    sink.done();
-                    return false;
-                }
-
-                if (!event.empty()) {
-                    if (!sink.write(event.c_str(), event.size())) {
-                        return false;
-                    }
-                    client_version = next_version;
-                } else {
-                    // SSE keepalive comment
-                    if (!sink.write(": keepalive\n\n", 13)) {
-                        return false;
-                    }
-                }
-                return true;
+            [&broadcaster, mode](size_t /*offset*/, httplib::DataSink & /*sink*/) {
+                broadcaster.add_client(handoff_server::take_current_socket(), mode);
+                return false;
             }
         );
     });
@@ -1322,37 +2337,37 @@ int main(int argc, char ** argv) {
     // ── Translation API endpoints ───────────────────────────────────────
 
     svr.Get("/api/languages", [&par](const httplib::Request &, httplib::Response & res) {
-        res.set_header("Access-Control-Allow-Origin", "*");
-        if (par.translate_url.empty()) {
-            res.set_content("[]", "application/json");
-            return;
-        }
-        httplib::Client client(par.translate_url);
-        client.set_connection_timeout(2);
-        client.set_read_timeout(3);
-        auto r = client.Get("/languages");
-        if (r && r->status == 200) {
-            res.set_content(r->body, "application/json");
-        } else {
-            res.set_content("[]", "application/json");
-        }
+        serve_translate_languages(par.translate_url, res);
     });
 
-    svr.Get("/api/source-languages", [ctx](const httplib::Request &, httplib::Response & res) {
+    svr.Get("/api/source-languages", [&startup](const httplib::Request &, httplib::Response & res) {
         res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_content(build_source_languages_json(ctx), "application/json");
+        whisper_context * ready_ctx = startup.ctx.load();
+        if (!ready_ctx) {
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content("{\"ok\":false,\"error\":\"loading\"}", "application/json");
+            return;
+        }
+        res.set_content(build_source_languages_json(whisper_is_multilingual(ready_ctx)), "application/json");
     });
 
-    svr.Get("/api/config", [&state, &par](const httplib::Request &, httplib::Response & res) {
+    svr.Get("/api/config", [&](const httplib::Request &, httplib::Response & res) {
         res.set_header("Access-Control-Allow-Origin", "*");
+        std::string tuning_fields;
+        {
+            std::lock_guard<std::mutex> lock(tuning_mtx);
+            tuning_fields = tuning_json_fields(tuning);
+        }
         std::lock_guard<std::mutex> lock(state.mtx);
         std::string json = "{" + json_str("source_lang", state.source_lang) +
                            "," + json_str("target_lang", state.target_lang) +
-                           "," + json_bool("translate_enabled", !par.translate_url.empty()) + "}";
+                           "," + json_bool("translate_enabled", !par.translate_url.empty()) +
+                           tuning_fields + "}";
         res.set_content(json, "application/json");
     });
 
-    svr.Post("/api/config", [&state](const httplib::Request & req, httplib::Response & res) {
+    svr.Post("/api/config", [&](const httplib::Request & req, httplib::Response & res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         config_update_payload payload;
         if (!parse_config_update_payload(req.body, payload)) {
@@ -1366,6 +2381,17 @@ int main(int argc, char ** argv) {
             return;
         }
 
+        // Everything is validated before anything is applied, so a rejected
+        // update leaves the running configuration untouched.
+        std::lock_guard<std::mutex> tuning_lock(tuning_mtx);
+        inference_tuning next = tuning;
+        if (const char * bad_field = merge_tuning_update(payload, audio_buffer_ms, next)) {
+            res.status = 400;
+            res.set_content(std::string("{\"ok\":false,\"error\":\"invalid ") + bad_field + "\"}",
+                            "application/json");
+            return;
+        }
+
         {
             std::lock_guard<std::mutex> lock(state.mtx);
             if (payload.has_source_lang) {
@@ -1375,61 +2401,394 @@ int main(int argc, char ** argv) {
                 state.target_lang = payload.target_lang;
             }
         }
+        if (payload.has_number_field()) {
+            tuning = next;
+            ++tuning_version;
+        }
         res.set_content("{\"ok\":true}", "application/json");
     });
 
-    std::thread server_thread([&svr, &par]() {
-        fprintf(stderr, "listening on http://localhost:%d\n\n", par.port);
-        svr.listen("0.0.0.0", par.port);
+    // ── Metrics / latency beacons ────────────────────────────────────────
+
+    svr.Post("/api/latency", [&latency](const httplib::Request & req, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        latency_beacon_payload beacon;
+        if (!parse_latency_beacon_payload(req.body, beacon)) {
+            res.status = 400;
+            res.set_content("{\"ok\":false,\"error\":\"invalid beacon\"}", "application/json");
+            return;
+        }
+        latency.record_beacon(beacon.version, beacon.receive_ms);
+        res.status = 204;
+    });
+
+    svr.Get("/api/metrics", [&](const httplib::Request &, httplib::Response & res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        std::string json = "{\"startup\":" + startup.to_json() +
+                           ",\"latency\":" + latency.to_json() +
+                           ",\"sse\":{\"clients\":" + std::to_string(broadcaster.client_count()) +
+                           ",\"dropped\":" + std::to_string(broadcaster.dropped_count()) + "}";
+        if (transcript) {
+            json += ",\"history\":{\"dropped\":" + std::to_string(transcript->dropped_count()) + "}";
+        }
+        if (recorder) {
+            json += ",\"record\":{\"dropped\":" + std::to_string(recorder->dropped_count()) +
+                    ",\"bytes\":" + std::to_string(recorder->bytes_written()) + "}";
+        }
+        if (fallback.enabled()) {
+            json += ",\"fallback\":" + fallback.to_json();
+        }
+        if (lang_pin.enabled()) {
+            json += ",\"language\":" + lang_pin.to_json();
+        }
+        json += ",\"gating\":" + conf_gate.to_json();
+        json += ",\"log\":" + log_stats_json();
+        if (adaptive.enabled()) {
+            json += ",\"adaptive_beam\":" + adaptive.to_json();
+        }
+        if (stitcher) {
+            json += ",\"stitch\":" + stitcher->to_json();
+        }
+        if (ingest) {
+            json += ",\"ingest\":{\"overflow_samples\":" + std::to_string(ingest->overflow_samples()) +
+                    ",\"underruns\":" + std::to_string(ingest->underruns()) +
+                    ",\"catchups\":" + std::to_string(ingest->catchups()) + "}";
+        }
+        json += "}";
+        res.set_content(json, "application/json");
+    });
+
+    // ── Network audio ingest ─────────────────────────────────────────────
+
+    if (ingest) {
+        svr.Post("/api/ingest", [ingest](const httplib::Request & req, httplib::Response & res,
+                                         const httplib::ContentReader & content_reader) {
+            handle_ingest(*ingest, req, res, content_reader);
+        });
+    }
+
+    // ── Transcript history endpoints ────────────────────────────────────
+
+    if (transcript) {
+        const transcript_log & log = *transcript;
+        svr.Get("/api/history", [&log](const httplib::Request & req, httplib::Response & res) {
+            serve_history(log, history_format::json, req, res);
+        });
+        svr.Get(R"(/api/history\.srt)", [&log](const httplib::Request & req, httplib::Response & res) {
+            serve_history(log, history_format::srt, req, res);
+        });
+        svr.Get(R"(/api/history\.vtt)", [&log](const httplib::Request & req, httplib::Response & res) {
+            serve_history(log, history_format::vtt, req, res);
+        });
+    }
+
+    // A fleet worker serves no HTTP; the front does.
+    std::thread server_thread;
+    if (!channel) {
+        server_thread = std::thread([&svr, &par]() {
+            svr.listen("0.0.0.0", par.port);
+        });
+    }
+
+    auto stop_services = [&]() {
+        svr.stop();
+        if (server_thread.joinable()) {
+            server_thread.join();
+        }
+        g_running = false;
+        if (pump_thread.joinable()) {
+            pump_thread.join();
+        }
+        broadcaster.stop();
+        if (transcript) {
+            transcript->stop();
+        }
+        if (recorder) {
+            recorder->stop();
+        }
+        if (audio) {
+            audio->pause();
+        }
+        trace_stop();
+        log_stop();
+    };
+
+    if (!channel) {
+        svr.wait_until_ready();
+        if (!svr.is_running()) {
+            fprintf(stderr, "error: failed to listen on port %d\n", par.port);
+            stop_services();
+            return 1;
+        }
+        fprintf(stderr, "listening on http://localhost:%d (loading model)\n\n", par.port);
+    }
+    startup.listen_ms = elapsed_ms(t_process_start);
+
+    // ── Whisper context (loaded in parallel with audio device setup) ─────
+
+    struct whisper_context * ctx = nullptr;
+    bool fallback_ok = true;
+    std::thread model_thread([&]() {
+        const auto t0 = std::chrono::steady_clock::now();
+        ggml_backend_load_all();
+
+        model_load_stats stats;
+        ctx = load_whisper_model(par.model, par.model_loader, cparams, stats);
+        if (ctx) {
+            fprintf(stderr, "model load: %s\n", stats.describe().c_str());
+            startup.model_loader     = stats.loader;
+            startup.model_bytes      = stats.file_bytes;
+            startup.model_cached_pct = stats.cached_pct;
+            startup.rss_bytes        = stats.rss_after;
+            fallback.set_primary(ctx);
+            if (par.fallback_resident) {
+                fallback_ok = fallback.load_all();
+            }
+        }
+        startup.model_ms = elapsed_ms(t0);
     });
 
+    // SDL stays on the main thread (required on macOS).
+    bool audio_ok = true;
+    if (!par.ingest) {
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!par.capture_name.empty()) {
+            int32_t resolved_capture_id = -1;
+            audio_ok = resolve_capture_id_by_name(par.capture_name, resolved_capture_id);
+            if (audio_ok) {
+                par.capture_id = resolved_capture_id;
+                fprintf(stderr, "capture-name: '%s' resolved to --capture %d\n",
+                        par.capture_name.c_str(), par.capture_id);
+            }
+        }
+        if (audio_ok) {
+            auto sdl = std::make_unique<sdl_audio_source>(audio_buffer_ms);
+            if (sdl->init(par.capture_id)) {
+                audio = std::move(sdl);
+            } else {
+                fprintf(stderr, "error: audio.init() failed\n");
+                audio_ok = false;
+            }
+        }
+        startup.audio_ms = elapsed_ms(t0);
+    } else {
+        startup.audio_ms = 0;
+    }
+
+    model_thread.join();
+    if (!ctx) {
+        fprintf(stderr, "error: failed to load model '%s'\n", par.model.c_str());
+    }
+    if (!ctx || !audio_ok || !fallback_ok) {
+        stop_services();
+        if (ctx) whisper_free(ctx);
+        return 1;
+    }
+
+    if (!par.infer_cpus.empty()) {
+        std::string error;
+        if (pin_current_thread(par.infer_cpus, error)) {
+            fprintf(stderr, "affinity: inference on CPUs %s\n", format_cpu_list(par.infer_cpus).c_str());
+        } else {
+            fprintf(stderr, "warning: affinity: inference CPUs %s not applied: %s\n",
+                    format_cpu_list(par.infer_cpus).c_str(), error.c_str());
+        }
+    }
+    if (par.capture_priority) {
+        std::string detail;
+        if (raise_current_thread_priority(detail)) {
+            fprintf(stderr, "priority: inference thread: %s\n", detail.c_str());
+        } else {
+            fprintf(stderr, "warning: priority: inference thread not raised: %s\n", detail.c_str());
+        }
+    }
+
+    // One silent inference with the live parameters so the first utterance
+    // doesn't pay for buffer allocation and kernel warmup.
+    if (g_running) {
+        publish_status("loading", "warmup");
+        const auto t0 = std::chrono::steady_clock::now();
+        const std::vector<float> silence(WHISPER_SAMPLE_RATE, 0.0f);
+        whisper_full_params wparams = make_whisper_params(par, par.language.c_str());
+        // Resident fallback tiers are warmed up too; their warmup times
+        // give the cost ratio used to decide when to switch back up.
+        for (size_t t = 0; t < fallback.tier_count(); ++t) {
+            whisper_context * tier_ctx = fallback.context(t);
+            if (!tier_ctx) continue;
+            const auto t_tier = std::chrono::steady_clock::now();
+            if (whisper_full(tier_ctx, wparams, silence.data(), (int)silence.size()) != 0) {
+                fprintf(stderr, "warning: warmup whisper_full() failed\n");
+            }
+            fallback.set_warmup_ms(t, std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - t_tier).count());
+        }
+        startup.warmup_ms = elapsed_ms(t0);
+    }
+
+    if (par.autotune && g_running) {
+        publish_status("loading", "autotune");
+        const auto t0 = std::chrono::steady_clock::now();
+        run_autotune(ctx, par);
+        startup.autotune_ms = elapsed_ms(t0);
+
+        std::lock_guard<std::mutex> lock(tuning_mtx);
+        tuning.n_threads = par.n_threads;
+        tuning.beam_size = par.beam_size;
+    }
+
+    // Audio captured while loading is stale.
+    audio->clear();
+    startup.ctx = ctx;
+    startup.ready_ms = elapsed_ms(t_process_start);
+    publish_status("ready", nullptr);
+    if (channel) {
+        channel->set_model_multilingual(whisper_is_multilingual(ctx));
+        channel->set_ready(true);
+    }
+    fprintf(stderr, "startup: listen %lld ms, model %lld ms, audio %lld ms, warmup %lld ms, autotune %lld ms"
+                    " -> ready after %lld ms\n\n",
+            (long long)startup.listen_ms.load(), (long long)startup.model_ms.load(),
+            (long long)startup.audio_ms.load(), (long long)startup.warmup_ms.load(),
+            (long long)startup.autotune_ms.load(), (long long)startup.ready_ms.load());
+
     // ── Main audio processing loop ───────────────────────────────────────
 
+    // From here on, per-step logging goes through the writer thread.
+    log_start();
+
     std::vector<float> pcmf32;
     std::vector<float> pcmf32_old;
     std::vector<float> pcmf32_new;
+    std::vector<float> pcmf32_filtered;
 
     std::string prev_emitted_text;
     std::string prev_emitted_norm;
     bool has_emitted_text = false;
-    float noise_floor = 0.0f;
-    bool noise_floor_ready = false;
-    int vad_drop_count = 0;
-    int vad_warmup_chunks = 2;
-    int vad_stall_chunks = 0;
+    vad_gate gate;
+    // Quiet rooms skip (or stop decoding) every step.
+    log_limiter vad_skip_log(1, 30000);
+    log_limiter no_speech_log(1, 30000);
+    log_limiter overrun_log(1, 5000);
+    uint64_t step_index = 0;
+
+    // Pre-filter (--highpass/--notch/--spectral-gate); its state runs
+    // across steps like the audio itself.
+    std::unique_ptr<audio_filter> filter;
+    if (par.filter.enabled()) {
+        filter = std::make_unique<audio_filter>(par.filter, (float)WHISPER_SAMPLE_RATE);
+    }
 
     // Translation client (created only if --translate-url is set)
-    std::unique_ptr<httplib::Client> translate_client;
+    std::unique_ptr<translator> translate_client;
     if (!par.translate_url.empty()) {
-        translate_client = std::make_unique<httplib::Client>(par.translate_url);
-        translate_client->set_connection_timeout(2);
-        translate_client->set_read_timeout(3);
+        translate_client = std::make_unique<translator>(par.translate_url);
         fprintf(stderr, "translation: %s\n\n", par.translate_url.c_str());
     }
 
-    // 1-entry translation cache
-    std::string cache_key;
-    std::string cache_result;
+    // Every step that ran the encoder counts towards the fallback RTF
+    // window and the worker's reported load, early-stopped ones included.
+    auto record_infer_time = [&](const segment_timing & t) {
+        if (fallback.enabled()) {
+            fallback.record((double)(t.infer_end_ms - t.infer_start_ms), par);
+        }
+        if (channel) {
+            channel->report_step((int)((t.infer_end_ms - t.infer_start_ms) * 1000 / par.step_ms));
+        }
+    };
+
+    uint64_t applied_tuning_version = 0;
+
+    // Source language the pin belongs to; a change drops the pin.
+    std::string pinned_for_source = par.language;
+
+    // Bumped by the front when another session takes over this worker.
+    uint64_t session_generation = channel ? channel->session_generation() : 0;
+
+    trace_set_thread_name("inference");
+    whisper_decode_hooks decode_hooks;
+
+    // A new session must not see the previous one's audio, text, stitcher
+    // or language pin. Checked while waiting for audio too: the idle worker
+    // a session takes over sits in that wait, and the first step must
+    // already belong to the new session.
+    auto begin_new_session = [&]() {
+        if (!channel || channel->session_generation() == session_generation) return;
+        session_generation = channel->session_generation();
+        pcmf32_old.clear();
+        prev_emitted_text.clear();
+        prev_emitted_norm.clear();
+        has_emitted_text = false;
+        gate = vad_gate();
+        if (filter) filter->reset();
+        if (translate_client) translate_client->reset_cache();
+        if (stitcher) stitcher->reset();
+        stitched_translations.reset();
+        lang_pin.reset();
+        audio->clear();
+
+        // Blank the previous session's subtitle.
+        subtitle_frame frame;
+        {
+            std::lock_guard<std::mutex> lock(state.mtx);
+            state.text.clear();
+            state.translated.clear();
+            state.version++;
+            frame.version = state.version;
+        }
+        channel->write_message(worker_message::frame, encode_frame(frame));
+        broadcaster.publish(std::move(frame));
+    };
 
     while (g_running) {
-        // Collect step_ms worth of audio samples
+        begin_new_session();
+
+        // Apply POST /api/config changes here, between steps.
+        bool tuning_changed = false;
+        {
+            std::lock_guard<std::mutex> lock(tuning_mtx);
+            if (tuning_version != applied_tuning_version) {
+                apply_tuning(par, tuning);
+                applied_tuning_version = tuning_version;
+                tuning_changed = true;
+            }
+        }
+        if (tuning_changed) {
+            par.keep_ms    = std::min(requested_keep_ms, par.step_ms);
+            n_samples_step = (int)(1e-3 * par.step_ms   * WHISPER_SAMPLE_RATE);
+            n_samples_len  = (int)(1e-3 * par.length_ms * WHISPER_SAMPLE_RATE);
+            n_samples_keep = (int)(1e-3 * par.keep_ms   * WHISPER_SAMPLE_RATE);
+            log_write(log_level::info, "config", "step %d ms, length %d ms, threads %d, beam %d, max tok %d, "
+                                                 "vad %.2f, temp inc %.2f",
+                      par.step_ms, par.length_ms, par.n_threads, par.beam_size, par.max_tokens,
+                      par.vad_thold, par.temperature_inc);
+        }
+
+        // Collect step_ms worth of audio samples. The audio sources don't
+        // expose callback timestamps, so the capture time is when the step's
+        // newest sample became visible here (polled every 1 ms).
+        segment_timing timing;
         {
+            trace_span span("audio_wait", "audio", "step", (int64_t)step_index);
             bool collected = false;
             while (g_running) {
-                if (!sdl_poll_events()) {
+                if (channel) channel->heartbeat(unix_time_ms());
+                begin_new_session();
+                if (!audio->poll()) {
                     g_running = false;
                     break;
                 }
 
-                audio.get(par.step_ms, pcmf32_new);
+                audio->get(par.step_ms, pcmf32_new);
 
                 if ((int)pcmf32_new.size() > 2 * n_samples_step) {
-                    fprintf(stderr, "warning: cannot process audio fast enough, dropping samples\n");
-                    audio.clear();
+                    log_write_limited(overrun_log, log_level::warn, "audio",
+                                      "cannot process audio fast enough, dropping samples");
+                    audio->clear();
                     continue;
                 }
                 if ((int)pcmf32_new.size() >= n_samples_step) {
-                    audio.clear();
+                    audio->clear();
+                    timing.capture_ms = unix_time_ms();
                     collected = true;
                     break;
                 }
@@ -1438,62 +2797,48 @@ int main(int argc, char ** argv) {
             if (!collected) break;
         }
 
-        const int n_samples_new = (int)pcmf32_new.size();
-
-        // VAD-based silence check (can be disabled for diagnosis).
-        float chunk_energy = 0.0f;
-        float energy_gate = 0.0f;
-        const bool has_voice_energy = should_process_audio_chunk(
-            pcmf32_new, par.vad_thold, noise_floor, noise_floor_ready, chunk_energy, energy_gate);
-
-        if (!noise_floor_ready) {
-            noise_floor = chunk_energy;
-            noise_floor_ready = true;
-        } else if (chunk_energy <= noise_floor) {
-            noise_floor = 0.85f * noise_floor + 0.15f * chunk_energy;
-        } else {
-            const float clipped_rise = std::min(chunk_energy, noise_floor * 1.3f);
-            noise_floor = 0.96f * noise_floor + 0.04f * clipped_rise;
+        // The VAD and whisper see the filtered step; the recorder keeps the
+        // raw capture so recordings can be replayed with other filters.
+        if (filter) {
+            trace_span span("filter", "audio", "step", (int64_t)step_index);
+            filter->process(pcmf32_new, pcmf32_filtered);
         }
+        const std::vector<float> & pcm_step = filter ? pcmf32_filtered : pcmf32_new;
+        const int n_samples_new = (int)pcm_step.size();
 
-        // Always ignore near-silent chunks, even when --no-vad is set.
-        if (chunk_energy < 0.00002f) {
+        // VAD-based silence check (can be disabled for diagnosis).
+        trace_span vad_span("vad", "audio", "step", (int64_t)step_index);
+        const vad_step vad = gate.judge(pcm_step, par.vad_thold, par.use_vad);
+        vad_span.end();
+
+        if (recorder) {
+            recorded_step_info step_info;
+            step_info.step        = step_index;
+            step_info.capture_ms  = timing.capture_ms;
+            step_info.energy      = vad.energy;
+            step_info.gate        = vad.gate;
+            step_info.noise_floor = vad.noise_floor;
+            step_info.outcome     = vad_outcome_name(vad.outcome);
+            step_info.whisper_ran = vad_runs_inference(vad.outcome);
+            recorder->submit(pcmf32_new, step_info);
+        }
+        const int64_t step_id = (int64_t)step_index++;
+
+        if (vad.outcome == vad_outcome::bypass) {
+            log_write(log_level::info, "vad", "bypass after stall (energy=%.6f gate=%.6f floor=%.6f)",
+                      vad.energy, vad.gate, vad.noise_floor);
+        } else if (vad.outcome == vad_outcome::skip) {
+            log_write_limited(vad_skip_log, log_level::info, "vad",
+                              "skipping quiet chunk (energy=%.6f gate=%.6f floor=%.6f)",
+                              vad.energy, vad.gate, vad.noise_floor);
+        }
+        if (!vad_runs_inference(vad.outcome)) {
+            lang_pin.on_silence();
             continue;
         }
 
-        if (par.use_vad && vad_warmup_chunks > 0) {
-            // Allow very strong speech energy even during startup warmup.
-            const bool obvious_voice = chunk_energy >= (energy_gate * 2.2f);
-            if (!obvious_voice) {
-                --vad_warmup_chunks;
-                continue;
-            }
-            vad_warmup_chunks = 0;
-        }
-
-        if (par.use_vad && !has_voice_energy) {
-            ++vad_stall_chunks;
-
-            const float vad_unit = std::max(0.0f, std::min(par.vad_thold, 1.0f));
-            const float stall_bypass_gate = 0.00002f + 0.00008f * vad_unit;
-            const bool bypass_after_stall = vad_stall_chunks >= 6 && chunk_energy >= stall_bypass_gate;
-            if (bypass_after_stall) {
-                fprintf(stderr,
-                        "vad: bypass after stall (energy=%.6f gate=%.6f floor=%.6f)\n",
-                        chunk_energy, energy_gate, noise_floor);
-            } else {
-                if (++vad_drop_count % 40 == 0) {
-                    fprintf(stderr,
-                            "vad: skipping quiet chunk (energy=%.6f gate=%.6f floor=%.6f)\n",
-                            chunk_energy, energy_gate, noise_floor);
-                }
-                continue;
-            }
-        }
-        vad_drop_count = 0;
-        vad_stall_chunks = 0;
-
         // Combine previous (keep) + new audio
+        trace_span window_span("window", "audio", "step", step_id);
         const int n_samples_take = std::min((int)pcmf32_old.size(),
             std::max(0, n_samples_keep + n_samples_len - n_samples_new));
 
@@ -1504,67 +2849,182 @@ int main(int argc, char ** argv) {
                 pcmf32[i] = pcmf32_old[(int)pcmf32_old.size() - n_samples_take + i];
             }
         }
-        std::copy(pcmf32_new.begin(), pcmf32_new.end(),
+        std::copy(pcm_step.begin(), pcm_step.end(),
                  pcmf32.begin() + n_samples_take);
 
         pcmf32_old = pcmf32;
+        window_span.end();
 
         // ── Whisper inference ────────────────────────────────────────────
 
-        const whisper_sampling_strategy strategy =
-            par.beam_size > 1 ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY;
-        whisper_full_params wparams = whisper_full_default_params(strategy);
         std::string source_lang;
         {
             std::lock_guard<std::mutex> lock(state.mtx);
             source_lang = state.source_lang;
         }
+        if (source_lang != pinned_for_source) {
+            lang_pin.reset();
+            pinned_for_source = source_lang;
+        }
+        whisper_context * infer_ctx = fallback.active();
+
+        // With auto and --lang-detect utterance|pin, whisper_full gets a
+        // fixed language and skips its own per-step identification.
+        std::string decode_lang = source_lang;
+        float language_prob = -1.0f;
+        bool decoding_pinned = false;
+        if (source_lang == "auto" && lang_pin.enabled()) {
+            lang_redetect_reason reason;
+            const lang_step next = lang_pin.next_step(unix_time_ms(), reason);
+            if (next == lang_step::identify) {
+                trace_span span("lang_detect", "infer", "step", step_id);
+                const std::string detected = identify_language(infer_ctx, pcmf32, par.n_threads, language_prob);
+                span.end();
+                const bool pinned = lang_pin.on_detected(detected, language_prob, reason, unix_time_ms());
+                if (!detected.empty()) {
+                    decode_lang = detected;
+                }
+                log_write(log_level::info, "lang", "identified %s (p=%.2f, %s)%s",
+                          detected.empty() ? "??" : detected.c_str(), language_prob,
+                          lang_redetect_reason_name(reason), pinned ? "" : ", not pinned");
+            } else if (next == lang_step::automatic) {
+                // Backing off after an uncertain identification: decode as
+                // in step mode instead of identifying on every step.
+                decode_lang = "auto";
+            } else {
+                decode_lang = lang_pin.pinned();
+                language_prob = lang_pin.pinned_prob();
+                decoding_pinned = true;
+            }
+        }
 
-        wparams.print_progress   = false;
-        wparams.print_special    = false;
-        wparams.print_realtime   = false;
-        wparams.print_timestamps = false;
-        wparams.translate        = false;
-        wparams.no_timestamps    = true;
-        wparams.single_segment   = true;
-        wparams.max_tokens       = par.max_tokens;
-        wparams.suppress_nst     = true;
-        wparams.language         = source_lang.c_str();
-        wparams.n_threads        = par.n_threads;
-        wparams.audio_ctx        = 0;
-        wparams.temperature_inc  = par.temperature_inc;
-        wparams.beam_search.beam_size = par.beam_size;
-
-        if (whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size()) != 0) {
-            fprintf(stderr, "warning: whisper_full() failed\n");
+        whisper_full_params wparams = make_whisper_params(par, decode_lang.c_str());
+        decode_hooks.attach(wparams, step_id, trace_enabled(),
+                            conf_gate.early_stop_enabled() ? &conf_gate : nullptr);
+
+        timing.infer_start_ms = unix_time_ms();
+        trace_span infer_span("whisper_full", "infer", "step", step_id);
+        const int infer_ret = whisper_full(infer_ctx, wparams, pcmf32.data(), pcmf32.size());
+        infer_span.end();
+        decode_hooks.finish();
+        if (decode_hooks.stopped_early) {
+            timing.infer_end_ms = unix_time_ms();
+            record_infer_time(timing);
+            conf_gate.on_early_stop();
+            lang_pin.on_silence();
+            log_write_limited(no_speech_log, log_level::info, "gate",
+                              "stopped decoding silent window (no-speech p=%.2f)", decode_hooks.no_speech_prob);
             continue;
         }
+        if (infer_ret != 0) {
+            log_write(log_level::warn, nullptr, "whisper_full() failed");
+            continue;
+        }
+        // The greedy result, kept unless a beam re-decode below improves on it.
+        decoded_tokens tokens = decoded_token_stats(infer_ctx);
+        std::string text = trim(full_segment_text(infer_ctx));
+        int lang_id = whisper_full_lang_id(infer_ctx);
+        float no_speech_prob = decode_hooks.no_speech_prob;
+        if (no_speech_prob < 0.0f && whisper_full_n_segments(infer_ctx) > 0) {
+            no_speech_prob = whisper_full_get_segment_no_speech_prob(infer_ctx, 0);
+        }
+
+        // --adaptive-beam: the greedy pass above was the cheap attempt; a
+        // step it decoded poorly is decoded again with beam search. With
+        // --beam-size > 1 every step already used beam search.
+        if (adaptive.enabled() && par.beam_size == 1) {
+            const double compression = text_compression_ratio(text);
+            const beam_trigger trigger = adaptive.judge(tokens.n, tokens.mean_logprob, compression);
+            if (trigger != beam_trigger::none) {
+                const int64_t greedy_end_ms = unix_time_ms();
+
+                // whisper_full encodes the window again; what it can skip
+                // is language identification, since the greedy pass already
+                // settled the language.
+                const std::string beam_lang = lang_id >= 0 ? whisper_lang_str(lang_id) : decode_lang;
+                params beam_par = par;
+                beam_par.beam_size = adaptive.beam_size();
+                whisper_full_params bparams = make_whisper_params(beam_par, beam_lang.c_str());
+                decode_hooks.attach(bparams, step_id, trace_enabled(), nullptr);
+
+                trace_span beam_span("beam_redecode", "infer", "step", step_id);
+                const int beam_ret = whisper_full(infer_ctx, bparams, pcmf32.data(), pcmf32.size());
+                beam_span.end();
+                decode_hooks.finish();
+                if (beam_ret != 0) {
+                    log_write(log_level::warn, nullptr, "whisper_full() beam re-decode failed, keeping the greedy result");
+                } else {
+                    const decoded_tokens beam_tokens = decoded_token_stats(infer_ctx);
+                    std::string beam_text = trim(full_segment_text(infer_ctx));
+                    const double beam_compression = text_compression_ratio(beam_text);
+                    const bool keep_beam = adaptive.improves(trigger, tokens.mean_logprob, beam_tokens.n,
+                                                             beam_tokens.mean_logprob, beam_compression);
+                    adaptive.on_redecoded((double)(greedy_end_ms - timing.infer_start_ms),
+                                          (double)(unix_time_ms() - greedy_end_ms),
+                                          keep_beam);
+                    log_write(log_level::info, "beam", "re-decoded with beam %d (%s: logprob %.2f -> %.2f, compression %.2f -> %.2f), keeping %s",
+                              adaptive.beam_size(), beam_trigger_name(trigger), tokens.mean_logprob,
+                              beam_tokens.mean_logprob, compression, beam_compression, keep_beam ? "beam" : "greedy");
+                    if (keep_beam) {
+                        tokens  = beam_tokens;
+                        text    = std::move(beam_text);
+                        lang_id = whisper_full_lang_id(infer_ctx);
+                    }
+                }
+            }
+        }
 
-        // ── Collect result ───────────────────────────────────────────────
-
-        std::string text;
-        const int n_segments = whisper_full_n_segments(ctx);
-        for (int i = 0; i < n_segments; i++) {
-            text += whisper_full_get_segment_text(ctx, i);
+        timing.infer_end_ms = unix_time_ms();
+        record_infer_time(timing);
+        const float confidence = tokens.mean_p;
+        if (decoding_pinned) {
+            lang_pin.on_decoded(confidence);
         }
 
-        text = trim(text);
+        // ── Collect result ───────────────────────────────────────────────
+
         if (text.empty()) continue;
 
+        trace_span text_filter_span("text_filter", "filter", "step", step_id);
+        const gate_verdict verdict = conf_gate.judge(no_speech_prob, confidence);
+        if (verdict != gate_verdict::emit) {
+            log_write(log_level::info, "gate", "dropped (%s, p=%.2f, no-speech p=%.2f): %s",
+                      gate_verdict_name(verdict), confidence, no_speech_prob, text.c_str());
+            continue;
+        }
+
         const std::string normalized_text = normalize_for_dedup(text);
         if (has_emitted_text && !normalized_text.empty() && normalized_text == prev_emitted_norm) {
-            fprintf(stderr, "filter: dropped (duplicate-text): %s\n", text.c_str());
+            log_write(log_level::info, "filter", "dropped (duplicate-text): %s", text.c_str());
             continue;
         }
 
         std::string drop_reason;
         if (should_drop_repetitive_text(text, prev_emitted_text, drop_reason)) {
-            fprintf(stderr, "filter: dropped (%s): %s\n", drop_reason.c_str(), text.c_str());
+            log_write(log_level::info, "filter", "dropped (%s): %s", drop_reason.c_str(), text.c_str());
             continue;
         }
 
+        // --stitch: translation and history only get the words this window
+        // adds or corrects; viewers still see the whole window. A correction
+        // cutting into an earlier translated fragment takes that fragment's
+        // surviving words along.
+        stitch_update stitched;
+        size_t        rewound_tokens = 0;
+        std::string   new_text       = text;
+        if (stitcher) {
+            stitched = stitcher->stitch(text);
+            if (stitched.empty()) {
+                log_write(log_level::info, "filter", "dropped (no-new-words): %s", text.c_str());
+                continue;
+            }
+            rewound_tokens = stitched_translations.revise(stitched);
+            new_text       = rewound_tokens > 0 ? stitcher->tail_text(rewound_tokens + stitched.text_tokens)
+                                                : stitched.text;
+        }
+        text_filter_span.end();
+
         // Detected language
-        const int lang_id = whisper_full_lang_id(ctx);
         const std::string lang = (lang_id >= 0) ? whisper_lang_str(lang_id) : "??";
 
         // ── Translation (outside mutex) ──────────────────────────────────
@@ -1578,60 +3038,89 @@ int main(int argc, char ** argv) {
                 target_lang = state.target_lang;
             }
 
-            if (!target_lang.empty() && target_lang != lang) {
-                // Tab separator avoids collision with text/lang content
-                std::string cache_check = text + "\t" + target_lang;
-                if (cache_check == cache_key) {
-                    translated = cache_result;
-                } else {
-                    translated = translate_text(*translate_client, text, lang, target_lang);
-                    cache_key = cache_check;
-                    cache_result = translated;
-                    if (translated.empty()) {
-                        fprintf(stderr, "warning: translation failed\n");
-                    }
+            if (!target_lang.empty() && target_lang != lang && !conf_gate.allows_translation(confidence)) {
+                log_write(log_level::info, "gate", "not translating (p=%.2f): %s", confidence, text.c_str());
+            } else if (!target_lang.empty() && target_lang != lang) {
+                trace_span span("translate", "net", "step", step_id);
+                bool cached = false;
+                translated = translate_client->translate(new_text, lang, target_lang, cached);
+                if (translated.empty() && !cached) {
+                    log_write(log_level::warn, nullptr, "translation failed");
                 }
             }
         }
+        timing.translated_ms = translate_client ? unix_time_ms() : timing.infer_end_ms;
+
+        // What viewers see next to the whole window: with --stitch, the
+        // translations of the fragments the window spans, including the
+        // earlier ones when this step's fragment was gated or failed.
+        std::string window_translated = translated;
+        if (stitcher) {
+            stitched_translations.append(rewound_tokens + stitched.text_tokens, target_lang, translated);
+            if (!target_lang.empty() && target_lang != lang) {
+                window_translated = stitched_translations.window(stitched.window_tokens, target_lang);
+            }
+        }
 
         // ── Update shared state → notify SSE clients ─────────────────────
 
+        trace_span publish_span("publish", "publish", "step", step_id);
+        subtitle_frame frame;
         {
             std::lock_guard<std::mutex> lock(state.mtx);
             state.text       = text;
-            state.translated = translated;
+            state.translated = window_translated;
             state.language   = lang;
             state.version++;
-        }
-        state.cv.notify_all();
+            frame.version = state.version;
+        }
+        frame.text       = text;
+        frame.translated = window_translated;
+        frame.language   = lang;
+        timing.publish_ms = unix_time_ms();
+        frame.timing     = timing;
+        frame.tier       = fallback.enabled() ? fallback.active_tier() : -1;
+        frame.language_prob = language_prob;
+        frame.confidence     = confidence;
+        frame.no_speech_prob = no_speech_prob;
+        if (stitcher) {
+            frame.stitch_remove = (int)stitched.remove_utf16;
+            frame.stitch_append = stitched.append;
+        }
+        latency.record_published(frame.version, timing);
+
+        if (transcript) {
+            transcript_entry entry;
+            entry.timestamp_ms = timing.publish_ms;
+            entry.version      = frame.version;
+            entry.language     = lang;
+            entry.text         = new_text;
+            entry.translated   = translated;
+            entry.revises      = (uint32_t)(stitched.remove_tokens + rewound_tokens);
+            transcript->append(std::move(entry));
+        }
+        if (channel) {
+            channel->write_message(worker_message::frame, encode_frame(frame));
+        }
+        broadcaster.publish(std::move(frame));
+        publish_span.end();
         prev_emitted_text = text;
         prev_emitted_norm = normalized_text;
         has_emitted_text = true;
 
         if (!translated.empty()) {
-            fprintf(stderr, "[%s->%s] %s -> %s\n", lang.c_str(), target_lang.c_str(),
-                    text.c_str(), translated.c_str());
+            log_write(log_level::info, nullptr, "[%s->%s] %s -> %s", lang.c_str(), target_lang.c_str(),
+                      new_text.c_str(), translated.c_str());
         } else {
-            fprintf(stderr, "[%s] %s\n", lang.c_str(), text.c_str());
+            log_write(log_level::info, nullptr, "[%s] %s", lang.c_str(), text.c_str());
         }
     }
 
     // ── Graceful shutdown ────────────────────────────────────────────────
 
-    fprintf(stderr, "\nshutting down...\n");
-
-    {
-        std::lock_guard<std::mutex> lock(state.mtx);
-        state.running = false;
-    }
-    state.cv.notify_all();
-
-    svr.stop();
-    if (server_thread.joinable()) {
-        server_thread.join();
-    }
+    log_write(log_level::info, nullptr, "shutting down...");
 
-    audio.pause();
+    stop_services();
     whisper_free(ctx);
 
     return 0;
@@ -0,0 +1,121 @@
+#include "model_file.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+std::string model_load_stats::describe() const {
+    std::string out = format_bytes(file_bytes) + " via " + loader;
+    if (cached_pct >= 0) {
+        out += ", " + std::to_string(cached_pct) + "% page-cached (" +
+               (cached_pct >= 90 ? "warm" : cached_pct <= 10 ? "cold" : "partly warm") + ")";
+    }
+    out += ", " + std::to_string((long long)load_ms) + " ms";
+    if (rss_before >= 0 && rss_after >= 0) {
+        const int64_t delta = rss_after - rss_before;
+        out += std::string(", rss ") + (delta < 0 ? "-" : "+") + format_bytes(delta < 0 ? -delta : delta);
+    }
+    return out;
+}
+
+bool mapped_model_file::map(const std::string & path, std::string & error) {
+    unmap();
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = strerror(errno);
+        close(fd);
+        return false;
+    }
+    if (st.st_size <= 0) {
+        error = "empty file";
+        close(fd);
+        return false;
+    }
+
+    void * p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    const int map_errno = errno;
+    close(fd);   // the mapping keeps the file referenced
+    if (p == MAP_FAILED) {
+        error = strerror(map_errno);
+        return false;
+    }
+
+    // The loader reads the file front to back exactly once.
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    data_ = p;
+    size_ = (size_t)st.st_size;
+    return true;
+}
+
+void mapped_model_file::unmap() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+int mapped_model_file::resident_pct() const {
+    if (!data_) return -1;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t pages = (size_ + page - 1) / page;
+#if defined(__APPLE__)
+    std::vector<char> vec(pages);
+#else
+    std::vector<unsigned char> vec(pages);
+#endif
+    if (mincore(data_, size_, vec.data()) != 0) return -1;
+
+    size_t resident = 0;
+    for (const auto v : vec) resident += (v & 1);
+    return (int)(resident * 100 / pages);
+}
+
+int64_t current_rss_bytes() {
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return (int64_t)info.resident_size;
+#else
+    FILE * f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    long long total = 0, resident = 0;
+    const int n = fscanf(f, "%lld %lld", &total, &resident);
+    fclose(f);
+    if (n != 2) return -1;
+    return (int64_t)resident * (int64_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+std::string format_bytes(int64_t bytes) {
+    if (bytes < 0) return "?";
+    char buf[32];
+    if (bytes >= (int64_t)1 << 30) {
+        snprintf(buf, sizeof(buf), "%.2f GB", (double)bytes / (1 << 30));
+    } else if (bytes >= (int64_t)1 << 20) {
+        snprintf(buf, sizeof(buf), "%.1f MB", (double)bytes / (1 << 20));
+    } else {
+        snprintf(buf, sizeof(buf), "%lld KB", (long long)(bytes >> 10));
+    }
+    return buf;
+}
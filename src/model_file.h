@@ -0,0 +1,54 @@
+// Read-only memory mapping of model files (--model-loader mmap) and the
+// numbers reported about each model load.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// How a model was loaded and what it cost. -1 = not measured.
+struct model_load_stats {
+    const char * loader     = "file";
+    int64_t      file_bytes = -1;
+    int          cached_pct = -1;   // share of the file in the page cache before loading
+    int64_t      load_ms    = -1;
+    int64_t      rss_before = -1;   // process RSS in bytes
+    int64_t      rss_after  = -1;
+
+    // "1.62 GB via mmap, 100% page-cached (warm), 812 ms, rss +1.61 GB"
+    std::string describe() const;
+};
+
+// Shared read-only mapping of a whole file. The pages belong to the page
+// cache, so every process mapping the same model reads the same physical
+// pages and a warm file costs no disk I/O; nothing is copied until the
+// caller reads from data().
+class mapped_model_file {
+public:
+    mapped_model_file() = default;
+    ~mapped_model_file() { unmap(); }
+
+    mapped_model_file(const mapped_model_file &) = delete;
+    mapped_model_file & operator=(const mapped_model_file &) = delete;
+
+    bool map(const std::string & path, std::string & error);
+    void unmap();
+
+    const void * data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Percentage of the file's pages currently in the page cache (mincore),
+    // -1 if unknown.
+    int resident_pct() const;
+
+private:
+    void * data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Resident set size of this process in bytes, -1 if unavailable.
+int64_t current_rss_bytes();
+
+// "1.62 GB", "74.1 MB", "512 KB".
+std::string format_bytes(int64_t bytes);
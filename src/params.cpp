@@ -0,0 +1,473 @@
+#include "params.h"
+#include "cpu_affinity.h"
+#include "util.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+inference_tuning tuning_from_params(const params & p) {
+    inference_tuning t;
+    t.step_ms         = p.step_ms;
+    t.length_ms       = p.length_ms;
+    t.n_threads       = p.n_threads;
+    t.beam_size       = p.beam_size;
+    t.max_tokens      = p.max_tokens;
+    t.vad_thold       = p.vad_thold;
+    t.temperature_inc = p.temperature_inc;
+    return t;
+}
+
+void apply_tuning(params & p, const inference_tuning & t) {
+    p.step_ms         = t.step_ms;
+    p.length_ms       = t.length_ms;
+    p.n_threads       = t.n_threads;
+    p.beam_size       = t.beam_size;
+    p.max_tokens      = t.max_tokens;
+    p.vad_thold       = t.vad_thold;
+    p.temperature_inc = t.temperature_inc;
+}
+
+std::string tuning_json_fields(const inference_tuning & t) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             ",\"step_ms\":%d,\"length_ms\":%d,\"threads\":%d,\"beam_size\":%d,"
+             "\"max_tokens\":%d,\"vad_thold\":%.3f,\"temperature_inc\":%.3f",
+             t.step_ms, t.length_ms, t.n_threads, t.beam_size, t.max_tokens,
+             t.vad_thold, t.temperature_inc);
+    return buf;
+}
+
+static bool merge_int_field(const config_update_payload::number_field & f, const int_range & r, int32_t & out) {
+    if (!f.has) return true;
+    if (f.value != std::floor(f.value) || f.value < r.min_v || f.value > r.max_v) return false;
+    out = (int32_t)f.value;
+    return true;
+}
+
+static bool merge_float_field(const config_update_payload::number_field & f, const float_range & r, float & out) {
+    if (!f.has) return true;
+    if (f.value < r.min_v || f.value > r.max_v) return false;
+    out = (float)f.value;
+    return true;
+}
+
+const char * merge_tuning_update(const config_update_payload & u, int32_t max_step_ms,
+                                 inference_tuning & t) {
+    if (!merge_int_field(u.step_ms, k_step_range, t.step_ms) || t.step_ms > max_step_ms) {
+        return "step_ms";
+    }
+    if (!merge_int_field(u.length_ms, k_length_range, t.length_ms))        return "length_ms";
+    if (!merge_int_field(u.threads, k_threads_range, t.n_threads))         return "threads";
+    if (!merge_int_field(u.beam_size, k_beam_size_range, t.beam_size))     return "beam_size";
+    if (!merge_int_field(u.max_tokens, k_max_tokens_range, t.max_tokens))  return "max_tokens";
+    if (!merge_float_field(u.vad_thold, k_vad_thold_range, t.vad_thold))   return "vad_thold";
+    if (!merge_float_field(u.temperature_inc, k_temperature_inc_range, t.temperature_inc)) {
+        return "temperature_inc";
+    }
+    // Same rule as the CLI: the window is never shorter than one step.
+    t.length_ms = std::max(t.length_ms, t.step_ms);
+    return nullptr;
+}
+
+bool parse_int_arg(const char * name, const char * raw,
+                   int32_t & out, int32_t min_v, int32_t max_v) {
+    char * end = nullptr;
+    errno = 0;
+    const long parsed = std::strtol(raw, &end, 10);
+    if (errno != 0 || end == raw || *end != '\0' ||
+        parsed < min_v || parsed > max_v) {
+        fprintf(stderr, "error: invalid value for %s: '%s' (expected %d..%d)\n",
+                name, raw, min_v, max_v);
+        return false;
+    }
+
+    out = static_cast<int32_t>(parsed);
+    return true;
+}
+
+bool parse_float_arg(const char * name, const char * raw,
+                     float & out, float min_v, float max_v) {
+    char * end = nullptr;
+    errno = 0;
+    const float parsed = std::strtof(raw, &end);
+    if (errno != 0 || end == raw || *end != '\0' || !std::isfinite(parsed) ||
+        parsed < min_v || parsed > max_v) {
+        fprintf(stderr, "error: invalid value for %s: '%s' (expected %.2f..%.2f)\n",
+                name, raw, min_v, max_v);
+        return false;
+    }
+
+    out = parsed;
+    return true;
+}
+
+void print_usage(const char * prog) {
+    const int default_threads = std::max(1, std::min(4, (int)std::thread::hardware_concurrency()));
+    fprintf(stderr, "\nUsage: %s [options]\n\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --model PATH       Whisper model path      (default: models/ggml-large-v3-turbo.bin)\n");
+    fprintf(stderr, "  --model-loader M   Model loader: mmap or file (default: mmap)\n");
+    fprintf(stderr, "  --port N           HTTP server port        (default: 8080)\n");
+    fprintf(stderr, "  --step N           Audio step size in ms   (default: 1000)\n");
+    fprintf(stderr, "  --length N         Audio length in ms      (default: 4000)\n");
+    fprintf(stderr, "  --keep N           Audio keep in ms        (default: 200)\n");
+    fprintf(stderr, "  --threads N        Inference threads       (default: %d)\n",
+            default_threads);
+    fprintf(stderr, "  --capture N        Audio device ID         (default: -1 = auto)\n");
+    fprintf(stderr, "  --capture-name STR Capture device name (exact/partial)\n");
+    fprintf(stderr, "  --language LANG    Language or 'auto'      (default: ko)\n");
+    fprintf(stderr, "  --lang-detect M    With auto: step, utterance or pin (default: step)\n");
+    fprintf(stderr, "  --lang-redetect N  Re-identify a pinned language after N ms (default: 30000, 0 = never)\n");
+    fprintf(stderr, "  --lang-min-prob F  Pin only identifications this confident (0.0..1.0, default: 0.5)\n");
+    fprintf(stderr, "  --no-speech-thold F Drop/stop decoding windows this likely silent (0.0..1.0, default: 0.8, 0 = off)\n");
+    fprintf(stderr, "  --min-confidence F Drop steps below this mean token probability (0.0..1.0, e.g. 0.3, default: 0 = off)\n");
+    fprintf(stderr, "  --translate-min-confidence F Translate only steps this confident (0.0..1.0, e.g. 0.5, default: 0 = off)\n");
+    fprintf(stderr, "  --vad-thold F      VAD energy threshold    (0.0..1.0, default: 0.6)\n");
+    fprintf(stderr, "  --beam-size N      Beam search size (1..%d) (default: 1 = greedy)\n", k_max_beam_size);
+    fprintf(stderr, "  --adaptive-beam N  Decode greedily, re-decode hard steps with beam N (2..%d, default: 0 = off)\n",
+            k_max_beam_size);
+    fprintf(stderr, "  --beam-logprob-thold F Re-decode below this mean token log-prob (default: -0.8)\n");
+    fprintf(stderr, "  --beam-compression-thold F Re-decode above this compression ratio (default: 2.4, 0 = off)\n");
+    fprintf(stderr, "  --max-tokens N     Max tokens per segment  (default: 32, 0 = unlimited)\n");
+    fprintf(stderr, "  --temperature-inc F Temperature fallback step (default: 0.0)\n");
+    fprintf(stderr, "  --no-vad           Disable VAD gating\n");
+    fprintf(stderr, "  --stitch           Translate/store only the words each window adds (default: whole window)\n");
+    fprintf(stderr, "  --highpass HZ      High-pass captured audio, e.g. 80 (default: off)\n");
+    fprintf(stderr, "  --notch LIST       Notch out hum, e.g. 60,120,180 (default: off)\n");
+    fprintf(stderr, "  --spectral-gate DB Attenuate noise-only frequency bins by DB (default: off)\n");
+    fprintf(stderr, "  --translate-url URL LibreTranslate server   (default: disabled)\n");
+    fprintf(stderr, "  --history-dir DIR  Transcript history dir  (default: disabled)\n");
+    fprintf(stderr, "  --record-dir DIR   Record captured audio + gate decisions (default: disabled)\n");
+    fprintf(stderr, "  --record-keep N    Recorded 5-minute files to keep (0 = all, default: 12)\n");
+    fprintf(stderr, "  --trace FILE       Write per-step pipeline spans as Chrome trace JSON (default: off)\n");
+    fprintf(stderr, "  --log-level L      Runtime log level: debug, info, warn or error (default: info)\n");
+    fprintf(stderr, "  --log-format F     Runtime log format: text or json (JSON lines) (default: text)\n");
+    fprintf(stderr, "  --autotune         Pick --threads (and greedy vs --beam-size) at startup\n");
+    fprintf(stderr, "  --autotune-clip F  Reference WAV for --autotune (default: silence)\n");
+    fprintf(stderr, "  --autotune-cache F Autotune cache file (default: ~/.cache/live-subtitle/autotune.tsv)\n");
+    fprintf(stderr, "  --fallback-models LIST Cheaper models to fall back to, e.g. small.bin,base.bin\n");
+    fprintf(stderr, "  --fallback-resident Load fallback models at startup (default: on first use)\n");
+    fprintf(stderr, "  --fallback-rtf-high F Switch down above this real-time factor (default: 0.9)\n");
+    fprintf(stderr, "  --fallback-rtf-low F Switch back up below this real-time factor (default: 0.6)\n");
+    fprintf(stderr, "  --infer-cpus LIST  Pin inference to CPUs, e.g. 0-7,16 (Linux)\n");
+    fprintf(stderr, "  --http-cpus LIST   Pin HTTP/service threads (default: the other CPUs)\n");
+    fprintf(stderr, "  --capture-priority Raise capture + inference thread priority\n");
+    fprintf(stderr, "  --ingest           Take audio from POST /api/ingest instead of SDL capture\n");
+    fprintf(stderr, "  --ingest-jitter N  Ingest jitter buffer in ms (default: 200)\n");
+    fprintf(stderr, "  --batch LIST       Transcribe audio files (comma-separated, @FILE = list) and exit\n");
+    fprintf(stderr, "  --batch-format F   Batch output: srt, vtt or jsonl (default: srt)\n");
+    fprintf(stderr, "  --batch-out DIR    Batch output dir        (default: next to each input)\n");
+    fprintf(stderr, "  --batch-jobs N     Parallel batch decoders (default: cores / --threads)\n");
+    fprintf(stderr, "  --batch-chunk N    Batch chunk length in ms (5000..30000, default: 30000)\n");
+    fprintf(stderr, "  --workers N        Serve up to N ingest sessions with N worker processes (default: off)\n");
+    fprintf(stderr, "  --no-gpu           Disable GPU\n");
+    fprintf(stderr, "  --no-flash-attn    Disable flash attention\n");
+    fprintf(stderr, "  -h, --help         Show this help\n\n");
+}
+
+static bool take_option_value(int argc, char ** argv, int & i, const char * opt, const char * & out) {
+    if (i + 1 >= argc) {
+        fprintf(stderr, "error: missing value for %s\n", opt);
+        return false;
+    }
+
+    out = argv[++i];
+    return true;
+}
+
+// Comma-separated, non-empty paths.
+static bool parse_path_list(const char * opt, const char * raw, std::vector<std::string> & out) {
+    out.clear();
+    const std::string list = raw;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        const size_t comma = std::min(list.find(',', pos), list.size());
+        const std::string path = trim_whitespace(list.substr(pos, comma - pos));
+        if (path.empty()) {
+            fprintf(stderr, "error: invalid value for %s: '%s'\n", opt, raw);
+            return false;
+        }
+        out.push_back(path);
+        pos = comma + 1;
+    }
+    return true;
+}
+
+parse_result parse_params(int argc, char ** argv, params & p) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char * raw = nullptr;
+
+        if      (arg == "--model") {
+            if (!take_option_value(argc, argv, i, "--model", raw)) return parse_result::error;
+            p.model = raw;
+        }
+        else if (arg == "--model-loader") {
+            if (!take_option_value(argc, argv, i, "--model-loader", raw)) return parse_result::error;
+            if (strcmp(raw, "mmap") != 0 && strcmp(raw, "file") != 0) {
+                fprintf(stderr, "error: invalid value for --model-loader: '%s' (expected mmap or file)\n", raw);
+                return parse_result::error;
+            }
+            p.model_loader = raw;
+        }
+        else if (arg == "--port") {
+            if (!take_option_value(argc, argv, i, "--port", raw)) return parse_result::error;
+            if (!parse_int_arg("--port", raw, p.port, 1, 65535)) return parse_result::error;
+        }
+        else if (arg == "--step") {
+            if (!take_option_value(argc, argv, i, "--step", raw)) return parse_result::error;
+            if (!parse_int_arg("--step", raw, p.step_ms, k_step_range.min_v, k_step_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--length") {
+            if (!take_option_value(argc, argv, i, "--length", raw)) return parse_result::error;
+            if (!parse_int_arg("--length", raw, p.length_ms, k_length_range.min_v, k_length_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--keep") {
+            if (!take_option_value(argc, argv, i, "--keep", raw)) return parse_result::error;
+            if (!parse_int_arg("--keep", raw, p.keep_ms, 0, 3600000)) return parse_result::error;
+        }
+        else if (arg == "--threads") {
+            if (!take_option_value(argc, argv, i, "--threads", raw)) return parse_result::error;
+            if (!parse_int_arg("--threads", raw, p.n_threads, k_threads_range.min_v, k_threads_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--capture") {
+            if (!take_option_value(argc, argv, i, "--capture", raw)) return parse_result::error;
+            if (!parse_int_arg("--capture", raw, p.capture_id, -1, std::numeric_limits<int32_t>::max())) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--capture-name") {
+            if (!take_option_value(argc, argv, i, "--capture-name", raw)) return parse_result::error;
+            p.capture_name = raw;
+        }
+        else if (arg == "--language") {
+            if (!take_option_value(argc, argv, i, "--language", raw)) return parse_result::error;
+            p.language = raw;
+        }
+        else if (arg == "--lang-detect") {
+            if (!take_option_value(argc, argv, i, "--lang-detect", raw)) return parse_result::error;
+            if (!parse_lang_detect_mode(raw, p.lang_detect)) {
+                fprintf(stderr, "error: invalid value for --lang-detect: '%s' (expected step, utterance or pin)\n", raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--lang-redetect") {
+            if (!take_option_value(argc, argv, i, "--lang-redetect", raw)) return parse_result::error;
+            if (!parse_int_arg("--lang-redetect", raw, p.lang_redetect_ms, 0, 3600000)) return parse_result::error;
+        }
+        else if (arg == "--lang-min-prob") {
+            if (!take_option_value(argc, argv, i, "--lang-min-prob", raw)) return parse_result::error;
+            if (!parse_float_arg("--lang-min-prob", raw, p.lang_min_prob, 0.0f, 1.0f)) return parse_result::error;
+        }
+        else if (arg == "--no-speech-thold") {
+            if (!take_option_value(argc, argv, i, "--no-speech-thold", raw)) return parse_result::error;
+            if (!parse_float_arg("--no-speech-thold", raw, p.no_speech_thold, 0.0f, 1.0f)) return parse_result::error;
+        }
+        else if (arg == "--min-confidence") {
+            if (!take_option_value(argc, argv, i, "--min-confidence", raw)) return parse_result::error;
+            if (!parse_float_arg("--min-confidence", raw, p.min_confidence, 0.0f, 1.0f)) return parse_result::error;
+        }
+        else if (arg == "--translate-min-confidence") {
+            if (!take_option_value(argc, argv, i, "--translate-min-confidence", raw)) return parse_result::error;
+            if (!parse_float_arg("--translate-min-confidence", raw, p.translate_min_confidence, 0.0f, 1.0f)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--vad-thold") {
+            if (!take_option_value(argc, argv, i, "--vad-thold", raw)) return parse_result::error;
+            if (!parse_float_arg("--vad-thold", raw, p.vad_thold, k_vad_thold_range.min_v, k_vad_thold_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--beam-size") {
+            if (!take_option_value(argc, argv, i, "--beam-size", raw)) return parse_result::error;
+            if (!parse_int_arg("--beam-size", raw, p.beam_size, k_beam_size_range.min_v, k_beam_size_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--adaptive-beam") {
+            if (!take_option_value(argc, argv, i, "--adaptive-beam", raw)) return parse_result::error;
+            if (!parse_int_arg("--adaptive-beam", raw, p.adaptive_beam, 0, k_max_beam_size)) return parse_result::error;
+            if (p.adaptive_beam == 1) {
+                fprintf(stderr, "error: --adaptive-beam must be 0 (off) or 2..%d\n", k_max_beam_size);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--beam-logprob-thold") {
+            if (!take_option_value(argc, argv, i, "--beam-logprob-thold", raw)) return parse_result::error;
+            if (!parse_float_arg("--beam-logprob-thold", raw, p.beam_logprob_thold, -10.0f, 0.0f)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--beam-compression-thold") {
+            if (!take_option_value(argc, argv, i, "--beam-compression-thold", raw)) return parse_result::error;
+            if (!parse_float_arg("--beam-compression-thold", raw, p.beam_compression_thold, 0.0f, 10.0f)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--max-tokens") {
+            if (!take_option_value(argc, argv, i, "--max-tokens", raw)) return parse_result::error;
+            if (!parse_int_arg("--max-tokens", raw, p.max_tokens, k_max_tokens_range.min_v, k_max_tokens_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--temperature-inc") {
+            if (!take_option_value(argc, argv, i, "--temperature-inc", raw)) return parse_result::error;
+            if (!parse_float_arg("--temperature-inc", raw, p.temperature_inc,
+                                 k_temperature_inc_range.min_v, k_temperature_inc_range.max_v)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--no-vad") {
+            p.use_vad = false;
+        }
+        else if (arg == "--stitch") {
+            p.stitch = true;
+        }
+        else if (arg == "--highpass") {
+            if (!take_option_value(argc, argv, i, "--highpass", raw)) return parse_result::error;
+            if (!parse_float_arg("--highpass", raw, p.filter.highpass_hz, 0.0f, 1000.0f)) return parse_result::error;
+        }
+        else if (arg == "--notch") {
+            if (!take_option_value(argc, argv, i, "--notch", raw)) return parse_result::error;
+            if (!parse_frequency_list(raw, 20.0f, 4000.0f, p.filter.notch_hz)) {
+                fprintf(stderr, "error: invalid value for --notch: '%s' (expected Hz list like 60,120,180)\n", raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--spectral-gate") {
+            if (!take_option_value(argc, argv, i, "--spectral-gate", raw)) return parse_result::error;
+            if (!parse_float_arg("--spectral-gate", raw, p.filter.spectral_gate_db, 0.0f, 60.0f)) {
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--translate-url") {
+            if (!take_option_value(argc, argv, i, "--translate-url", raw)) return parse_result::error;
+            p.translate_url = raw;
+        }
+        else if (arg == "--history-dir") {
+            if (!take_option_value(argc, argv, i, "--history-dir", raw)) return parse_result::error;
+            p.history_dir = raw;
+        }
+        else if (arg == "--record-dir") {
+            if (!take_option_value(argc, argv, i, "--record-dir", raw)) return parse_result::error;
+            p.record_dir = raw;
+        }
+        else if (arg == "--record-keep") {
+            if (!take_option_value(argc, argv, i, "--record-keep", raw)) return parse_result::error;
+            if (!parse_int_arg("--record-keep", raw, p.record_keep, 0, 100000)) return parse_result::error;
+        }
+        else if (arg == "--trace") {
+            if (!take_option_value(argc, argv, i, "--trace", raw)) return parse_result::error;
+            p.trace_path = raw;
+        }
+        else if (arg == "--log-level") {
+            if (!take_option_value(argc, argv, i, "--log-level", raw)) return parse_result::error;
+            if (!parse_log_level(raw, p.log_min_level)) {
+                fprintf(stderr, "error: invalid value for --log-level: '%s' (expected debug, info, warn or error)\n", raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--log-format") {
+            if (!take_option_value(argc, argv, i, "--log-format", raw)) return parse_result::error;
+            if (!parse_log_format(raw, p.log_output)) {
+                fprintf(stderr, "error: invalid value for --log-format: '%s' (expected text or json)\n", raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--autotune") {
+            p.autotune = true;
+        }
+        else if (arg == "--autotune-clip") {
+            if (!take_option_value(argc, argv, i, "--autotune-clip", raw)) return parse_result::error;
+            p.autotune_clip = raw;
+        }
+        else if (arg == "--autotune-cache") {
+            if (!take_option_value(argc, argv, i, "--autotune-cache", raw)) return parse_result::error;
+            p.autotune_cache = raw;
+        }
+        else if (arg == "--fallback-models") {
+            if (!take_option_value(argc, argv, i, "--fallback-models", raw)) return parse_result::error;
+            if (!parse_path_list("--fallback-models", raw, p.fallback_models)) return parse_result::error;
+        }
+        else if (arg == "--fallback-resident") {
+            p.fallback_resident = true;
+        }
+        else if (arg == "--fallback-rtf-high") {
+            if (!take_option_value(argc, argv, i, "--fallback-rtf-high", raw)) return parse_result::error;
+            if (!parse_float_arg("--fallback-rtf-high", raw, p.fallback_rtf_high, 0.1f, 10.0f)) return parse_result::error;
+        }
+        else if (arg == "--fallback-rtf-low") {
+            if (!take_option_value(argc, argv, i, "--fallback-rtf-low", raw)) return parse_result::error;
+            if (!parse_float_arg("--fallback-rtf-low", raw, p.fallback_rtf_low, 0.0f, 10.0f)) return parse_result::error;
+        }
+        else if (arg == "--infer-cpus" || arg == "--http-cpus") {
+            if (!take_option_value(argc, argv, i, arg.c_str(), raw)) return parse_result::error;
+            std::vector<int> & cpus = arg == "--infer-cpus" ? p.infer_cpus : p.http_cpus;
+            if (!parse_cpu_list(raw, cpus)) {
+                fprintf(stderr, "error: invalid value for %s: '%s' (expected a CPU list like 0-7,16)\n",
+                        arg.c_str(), raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--capture-priority") {
+            p.capture_priority = true;
+        }
+        else if (arg == "--ingest") {
+            p.ingest = true;
+        }
+        else if (arg == "--batch") {
+            if (!take_option_value(argc, argv, i, "--batch", raw)) return parse_result::error;
+            if (!parse_path_list("--batch", raw, p.batch_inputs)) return parse_result::error;
+        }
+        else if (arg == "--batch-format") {
+            if (!take_option_value(argc, argv, i, "--batch-format", raw)) return parse_result::error;
+            if (!parse_batch_format(raw, p.batch_output_format)) {
+                fprintf(stderr, "error: invalid value for --batch-format: '%s' (expected srt, vtt or jsonl)\n", raw);
+                return parse_result::error;
+            }
+        }
+        else if (arg == "--batch-out") {
+            if (!take_option_value(argc, argv, i, "--batch-out", raw)) return parse_result::error;
+            p.batch_out = raw;
+        }
+        else if (arg == "--batch-jobs") {
+            if (!take_option_value(argc, argv, i, "--batch-jobs", raw)) return parse_result::error;
+            if (!parse_int_arg("--batch-jobs", raw, p.batch_jobs, 1, 256)) return parse_result::error;
+        }
+        else if (arg == "--batch-chunk") {
+            if (!take_option_value(argc, argv, i, "--batch-chunk", raw)) return parse_result::error;
+            if (!parse_int_arg("--batch-chunk", raw, p.batch_chunk_ms, 5000, 30000)) return parse_result::error;
+        }
+        else if (arg == "--workers") {
+            if (!take_option_value(argc, argv, i, "--workers", raw)) return parse_result::error;
+            if (!parse_int_arg("--workers", raw, p.workers, 1, 256)) return parse_result::error;
+        }
+        else if (arg == "--worker-shm") {
+            if (!take_option_value(argc, argv, i, "--worker-shm", raw)) return parse_result::error;
+            p.worker_shm = raw;
+        }
+        else if (arg == "--ingest-jitter") {
+            if (!take_option_value(argc, argv, i, "--ingest-jitter", raw)) return parse_result::error;
+            if (!parse_int_arg("--ingest-jitter", raw, p.ingest_jitter_ms, 0, 5000)) return parse_result::error;
+        }
+        else if (arg == "--no-gpu")         { p.use_gpu    = false; }
+        else if (arg == "--no-flash-attn")  { p.flash_attn = false; }
+        else if (arg == "-h" || arg == "--help") { print_usage(argv[0]); return parse_result::help; }
+        else {
+            fprintf(stderr, "error: unknown option: %s\n", arg.c_str());
+            print_usage(argv[0]);
+            return parse_result::error;
+        }
+    }
+    return parse_result::ok;
+}
@@ -0,0 +1,142 @@
+// Command-line parameters and the runtime-tunable inference settings.
+
+#pragma once
+
+#include "audio_filter.h"
+#include "batch_transcript.h"
+#include "json.h"
+#include "language_pin.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct params {
+    int32_t n_threads  = std::max(1, std::min(4, (int32_t)std::thread::hardware_concurrency()));
+    int32_t step_ms    = 1000;
+    int32_t length_ms  = 4000;
+    int32_t keep_ms    = 200;
+    int32_t capture_id = -1;
+    int32_t port       = 8080;
+    int32_t beam_size  = 1;
+    int32_t max_tokens = 32;
+
+    float vad_thold = 0.6f;
+    float temperature_inc = 0.0f;
+    float fallback_rtf_high = 0.9f;
+    float fallback_rtf_low  = 0.6f;
+
+    bool use_gpu   = true;
+    bool flash_attn = true;
+    bool use_vad = true;
+    bool ingest = false;
+    bool autotune = false;
+    bool fallback_resident = false;
+    bool capture_priority = false;
+    bool stitch = false;
+
+    int32_t ingest_jitter_ms = 200;
+
+    lang_detect_mode lang_detect = lang_detect_mode::step;
+    int32_t lang_redetect_ms = 30000;
+    float   lang_min_prob    = 0.5f;
+
+    float no_speech_thold          = 0.8f;   // 0 = off
+    float min_confidence           = 0.0f;   // 0 = off
+    float translate_min_confidence = 0.0f;   // 0 = off
+
+    int32_t adaptive_beam          = 0;       // --adaptive-beam: beam size of the re-decode, 0 = off
+    float   beam_logprob_thold     = -0.8f;
+    float   beam_compression_thold = 2.4f;    // 0 = off
+
+    std::vector<std::string> batch_inputs;   // --batch: transcribe these files and exit
+    batch_format batch_output_format = batch_format::srt;
+    std::string  batch_out;
+    int32_t      batch_jobs      = 0;       // 0 = cores / n_threads
+    int32_t      batch_chunk_ms  = 30000;
+
+    int32_t workers = 0;           // --workers: front process with N inference workers
+    std::string worker_shm;        // set by the front on each worker it spawns
+
+    std::string language      = "ko";
+    std::string model         = "models/ggml-large-v3-turbo.bin";
+    std::string model_loader  = "mmap";
+    std::string capture_name;
+    std::string translate_url;
+    std::string history_dir;
+    std::string record_dir;
+    std::string trace_path;
+    log_level  log_min_level = log_level::info;
+    log_format log_output    = log_format::text;
+    int32_t record_keep = 12;
+    std::string autotune_cache;
+    std::string autotune_clip;
+    std::vector<std::string> fallback_models;
+    std::vector<int> infer_cpus;
+    std::vector<int> http_cpus;
+
+    audio_filter_config filter;
+};
+
+static constexpr int k_max_beam_size = 8;
+
+// Inclusive ranges shared by the CLI options and POST /api/config.
+struct int_range   { int32_t min_v; int32_t max_v; };
+struct float_range { float   min_v; float   max_v; };
+
+static constexpr int_range   k_step_range            = {1, 3600000};
+static constexpr int_range   k_length_range          = {1, 3600000};
+static constexpr int_range   k_threads_range         = {1, 4096};
+static constexpr int_range   k_beam_size_range       = {1, k_max_beam_size};
+static constexpr int_range   k_max_tokens_range      = {0, 1024};
+static constexpr float_range k_vad_thold_range       = {0.0f, 1.0f};
+static constexpr float_range k_temperature_inc_range = {0.0f, 2.0f};
+
+// Audio sources buffer at least this much; a runtime step change is
+// limited to what the capture buffer holds.
+static constexpr int32_t k_min_audio_buffer_ms = 30000;
+
+// Inference settings that POST /api/config can change while running. The
+// main loop snapshots them at a step boundary, so an update is applied
+// all at once or not at all.
+struct inference_tuning {
+    int32_t step_ms         = 0;
+    int32_t length_ms       = 0;
+    int32_t n_threads       = 0;
+    int32_t beam_size       = 0;
+    int32_t max_tokens      = 0;
+    float   vad_thold       = 0.0f;
+    float   temperature_inc = 0.0f;
+};
+
+enum class parse_result {
+    ok = 0,
+    help,
+    error,
+};
+
+inference_tuning tuning_from_params(const params & p);
+
+void apply_tuning(params & p, const inference_tuning & t);
+
+// ,"step_ms":1000,... for GET /api/config.
+std::string tuning_json_fields(const inference_tuning & t);
+
+// Validates every numeric field of `u` and merges them into `t`. Returns
+// the name of the first invalid field (t is then partially written and
+// must be discarded), or nullptr.
+const char * merge_tuning_update(const config_update_payload & u, int32_t max_step_ms,
+                                 inference_tuning & t);
+
+void print_usage(const char * prog);
+
+bool parse_int_arg(const char * name, const char * raw,
+                   int32_t & out, int32_t min_v, int32_t max_v);
+
+bool parse_float_arg(const char * name, const char * raw,
+                     float & out, float min_v, float max_v);
+
+parse_result parse_params(int argc, char ** argv, params & p);
@@ -0,0 +1,55 @@
+// Lock-free single-producer / single-consumer ring.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded queue between exactly one producer thread and one consumer thread.
+// Neither side ever blocks: try_push fails when full, try_pop when empty.
+template <typename T>
+class spsc_ring {
+public:
+    explicit spsc_ring(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    bool try_push(T && value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ > mask_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ > mask_) return false;
+        }
+        slots_[head & mask_] = std::move(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T & out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail == head_cache_) return false;
+        }
+        out = std::move(slots_[tail & mask_]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size_approx() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t         mask_ = 0;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t                          tail_cache_ = 0;  // producer's view of tail_
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t                          head_cache_ = 0;  // consumer's view of head_
+};
@@ -0,0 +1,416 @@
+#include "sse_broadcaster.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+// A viewer that disconnects mid-send must fail the send with EPIPE, not
+// raise SIGPIPE: nothing guarantees the process ignores it. Linux takes a
+// per-call flag; macOS/BSD set SO_NOSIGPIPE on the socket (prepare_client).
+#if defined(MSG_NOSIGNAL)
+static constexpr int k_send_flags = MSG_NOSIGNAL;
+#else
+static constexpr int k_send_flags = 0;
+#endif
+
+event_poller::event_poller() {
+#if defined(__linux__)
+    fd_ = epoll_create1(EPOLL_CLOEXEC);
+#else
+    fd_ = kqueue();
+#endif
+}
+
+event_poller::~event_poller() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool event_poller::add(int fd, bool want_write) {
+#if defined(__linux__)
+    struct epoll_event ev = {};
+    ev.events  = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0u);
+    ev.data.fd = fd;
+    return epoll_ctl(fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#else
+    struct kevent changes[2];
+    EV_SET(&changes[0], fd, EVFILT_READ,  EV_ADD, 0, 0, nullptr);
+    EV_SET(&changes[1], fd, EVFILT_WRITE, EV_ADD | (want_write ? EV_ENABLE : EV_DISABLE), 0, 0, nullptr);
+    return kevent(fd_, changes, 2, nullptr, 0, nullptr) == 0;
+#endif
+}
+
+bool event_poller::set_want_write(int fd, bool want_write) {
+#if defined(__linux__)
+    struct epoll_event ev = {};
+    ev.events  = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0u);
+    ev.data.fd = fd;
+    return epoll_ctl(fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+#else
+    struct kevent change;
+    EV_SET(&change, fd, EVFILT_WRITE, want_write ? EV_ENABLE : EV_DISABLE, 0, 0, nullptr);
+    return kevent(fd_, &change, 1, nullptr, 0, nullptr) == 0;
+#endif
+}
+
+void event_poller::remove(int fd) {
+#if defined(__linux__)
+    epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    struct kevent changes[2];
+    EV_SET(&changes[0], fd, EVFILT_READ,  EV_DELETE, 0, 0, nullptr);
+    EV_SET(&changes[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    kevent(fd_, changes, 2, nullptr, 0, nullptr);
+#endif
+}
+
+int event_poller::wait(std::vector<event> & out, int timeout_ms) {
+    out.clear();
+#if defined(__linux__)
+    struct epoll_event evs[256];
+    const int n = epoll_wait(fd_, evs, 256, timeout_ms);
+    for (int i = 0; i < n; ++i) {
+        uint32_t flags = 0;
+        if (evs[i].events & EPOLLIN)  flags |= ev_readable;
+        if (evs[i].events & EPOLLOUT) flags |= ev_writable;
+        if (evs[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) flags |= ev_hangup;
+        out.push_back({evs[i].data.fd, flags});
+    }
+#else
+    struct kevent evs[256];
+    struct timespec ts;
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    const int n = kevent(fd_, nullptr, 0, evs, 256, timeout_ms < 0 ? nullptr : &ts);
+    for (int i = 0; i < n; ++i) {
+        uint32_t flags = 0;
+        if (evs[i].filter == EVFILT_READ)  flags |= ev_readable;
+        if (evs[i].filter == EVFILT_WRITE) flags |= ev_writable;
+        if (evs[i].flags & (EV_EOF | EV_ERROR)) flags |= ev_hangup;
+        out.push_back({(int)evs[i].ident, flags});
+    }
+#endif
+    return n;
+}
+
+sse_broadcaster::~sse_broadcaster() {
+    stop();
+}
+
+bool sse_broadcaster::start() {
+    if (!poller_.valid() || pipe(wake_fds_) != 0) {
+        return false;
+    }
+    set_nonblocking(wake_fds_[0]);
+    set_nonblocking(wake_fds_[1]);
+    if (!poller_.add(wake_fds_[0], false)) {
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void sse_broadcaster::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+}
+
+void sse_broadcaster::add_client(int sock, sse_mode mode) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pending_clients_.push_back({sock, mode});
+    }
+    wake();
+}
+
+void sse_broadcaster::publish_status(const std::string & json) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pending_status_ = encode_chunk("event: status\ndata: " + json + "\n\n");
+    }
+    wake();
+}
+
+void sse_broadcaster::publish(subtitle_frame frame) {
+    auto shared = std::make_shared<const subtitle_frame>(std::move(frame));
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pending_frame_ = std::move(shared);
+    }
+    wake();
+}
+
+size_t sse_broadcaster::client_count() const {
+    return n_clients_.load(std::memory_order_relaxed);
+}
+
+uint64_t sse_broadcaster::dropped_count() const {
+    return n_dropped_.load(std::memory_order_relaxed);
+}
+
+void sse_broadcaster::set_nonblocking(int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void sse_broadcaster::prepare_client(int fd) {
+    set_nonblocking(fd);
+#if defined(SO_NOSIGPIPE)
+    const int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+std::string sse_broadcaster::encode_chunk(const std::string & payload) {
+    char size_hex[16];
+    snprintf(size_hex, sizeof(size_hex), "%zx\r\n", payload.size());
+    return size_hex + payload + "\r\n";
+}
+
+void sse_broadcaster::wake() {
+    const char b = 1;
+    (void)!write(wake_fds_[1], &b, 1);
+}
+
+bool sse_broadcaster::flush_client(int fd, client & c) {
+    while (c.backlog_off < c.backlog.size()) {
+        const ssize_t n = send(fd, c.backlog.data() + c.backlog_off,
+                               c.backlog.size() - c.backlog_off, k_send_flags);
+        if (n > 0) {
+            c.backlog_off += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+
+    if (c.backlog_off == c.backlog.size()) {
+        c.backlog.clear();
+        c.backlog_off = 0;
+    }
+    return poller_.set_want_write(fd, !c.backlog.empty());
+}
+
+bool sse_broadcaster::send_to_client(int fd, client & c, const std::string & data) {
+    size_t sent = 0;
+    if (c.backlog.empty()) {
+        // Fast path: straight from the shared frame, nothing copied.
+        while (sent < data.size()) {
+            const ssize_t n = send(fd, data.data() + sent, data.size() - sent, k_send_flags);
+            if (n > 0) {
+                sent += (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        if (sent == data.size()) {
+            return true;
+        }
+    }
+
+    if (c.backlog.size() - c.backlog_off + (data.size() - sent) > k_max_client_backlog) {
+        n_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (c.backlog_off > 0) {
+        c.backlog.erase(0, c.backlog_off);
+        c.backlog_off = 0;
+    }
+    c.backlog.append(data, sent, std::string::npos);
+    return poller_.set_want_write(fd, true);
+}
+
+void sse_broadcaster::drop_client(int fd) {
+    poller_.remove(fd);
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+    clients_.erase(fd);
+}
+
+const std::string & sse_broadcaster::message_for(client & c,
+                                                 const std::shared_ptr<const subtitle_frame> & frame,
+                                                 const std::string & meta,
+                                                 std::string & full_chunk,
+                                                 std::string & key_chunk,
+                                                 std::unordered_map<const subtitle_frame *, std::string> & delta_chunks) {
+    const std::string * out = nullptr;
+    if (c.mode == sse_mode::full) {
+        if (full_chunk.empty()) full_chunk = encode_chunk(build_full_event(*frame, meta));
+        out = &full_chunk;
+    } else if (!c.last || c.frames_since_key >= k_delta_keyframe_interval) {
+        if (key_chunk.empty()) key_chunk = encode_chunk(build_key_event(*frame, meta));
+        out = &key_chunk;
+        c.frames_since_key = 0;
+    } else {
+        auto it = delta_chunks.find(c.last.get());
+        if (it == delta_chunks.end()) {
+            it = delta_chunks.emplace(c.last.get(), encode_chunk(build_delta_event(*c.last, *frame, meta))).first;
+        }
+        out = &it->second;
+        ++c.frames_since_key;
+    }
+    c.last = frame;
+    return *out;
+}
+
+double sse_broadcaster::beacon_rate() const {
+    return std::min(1.0, k_beacons_per_frame / (double)std::max<size_t>(1, clients_.size()));
+}
+
+void sse_broadcaster::broadcast_frame(const std::shared_ptr<const subtitle_frame> & frame) {
+    trace_span span("sse_frame", "sse", "clients", (int64_t)clients_.size());
+    const std::string meta = frame_meta_json(*frame, beacon_rate());
+    std::string full_chunk;
+    std::string key_chunk;
+    std::unordered_map<const subtitle_frame *, std::string> delta_chunks;
+
+    std::vector<int> dead;
+    for (auto & kv : clients_) {
+        const std::string & data = message_for(kv.second, frame, meta, full_chunk, key_chunk, delta_chunks);
+        if (!send_to_client(kv.first, kv.second, data)) {
+            dead.push_back(kv.first);
+        }
+    }
+    for (int fd : dead) {
+        drop_client(fd);
+    }
+}
+
+void sse_broadcaster::broadcast(const std::string & data) {
+    trace_span span("sse_write", "sse", "clients", (int64_t)clients_.size());
+    std::vector<int> dead;
+    for (auto & kv : clients_) {
+        if (!send_to_client(kv.first, kv.second, data)) {
+            dead.push_back(kv.first);
+        }
+    }
+    for (int fd : dead) {
+        drop_client(fd);
+    }
+}
+
+void sse_broadcaster::run() {
+    using clock = std::chrono::steady_clock;
+    trace_set_thread_name("sse");
+
+    static const std::string keepalive = encode_chunk(": keepalive\n\n");
+    std::vector<event_poller::event> events;
+    std::shared_ptr<const subtitle_frame> latest;
+    std::string latest_status;
+    auto next_keepalive = clock::now() + std::chrono::milliseconds(k_keepalive_ms);
+
+    while (running_) {
+        const int timeout_ms = (int)std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(next_keepalive - clock::now()).count());
+        poller_.wait(events, timeout_ms);
+
+        for (const auto & ev : events) {
+            if (ev.fd == wake_fds_[0]) {
+                char buf[256];
+                while (read(wake_fds_[0], buf, sizeof(buf)) > 0) {}
+                continue;
+            }
+
+            auto it = clients_.find(ev.fd);
+            if (it == clients_.end()) continue;
+
+            bool alive = (ev.flags & event_poller::ev_hangup) == 0;
+            if (alive && (ev.flags & event_poller::ev_readable)) {
+                // Clients never send anything after the request; EOF or
+                // an error means the viewer went away.
+                char buf[512];
+                const ssize_t n = recv(ev.fd, buf, sizeof(buf), 0);
+                alive = n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+            }
+            if (alive && (ev.flags & event_poller::ev_writable)) {
+                alive = flush_client(ev.fd, it->second);
+            }
+            if (!alive) {
+                drop_client(ev.fd);
+            }
+        }
+
+        std::vector<pending_client> new_clients;
+        std::shared_ptr<const subtitle_frame> frame;
+        std::string status;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            new_clients.swap(pending_clients_);
+            frame.swap(pending_frame_);
+            status.swap(pending_status_);
+        }
+
+        if (!status.empty()) {
+            latest_status = std::move(status);
+            broadcast(latest_status);
+        }
+        if (frame) {
+            latest = frame;
+            broadcast_frame(frame);
+        }
+
+        for (const pending_client & pc : new_clients) {
+            const int sock = pc.sock;
+            prepare_client(sock);
+            if (!poller_.add(sock, false)) {
+                close(sock);
+                continue;
+            }
+            client & c = clients_[sock];
+            c.mode = pc.mode;
+            if (!latest_status.empty() && !send_to_client(sock, c, latest_status)) {
+                drop_client(sock);
+                continue;
+            }
+            // Late joiners get the current subtitle right away (a
+            // keyframe in delta mode).
+            if (latest) {
+                std::string full_chunk;
+                std::string key_chunk;
+                std::unordered_map<const subtitle_frame *, std::string> delta_chunks;
+                const std::string meta = frame_meta_json(*latest, beacon_rate());
+                const std::string & data = message_for(c, latest, meta, full_chunk, key_chunk, delta_chunks);
+                if (!send_to_client(sock, c, data)) {
+                    drop_client(sock);
+                }
+            }
+        }
+
+        if (clock::now() >= next_keepalive) {
+            broadcast(keepalive);
+            next_keepalive = clock::now() + std::chrono::milliseconds(k_keepalive_ms);
+        }
+        n_clients_.store(clients_.size(), std::memory_order_relaxed);
+    }
+
+    // Terminate the chunked streams so EventSource reconnects cleanly.
+    static const char last_chunk[] = "0\r\n\r\n";
+    for (auto & kv : clients_) {
+        (void)!send(kv.first, last_chunk, sizeof(last_chunk) - 1, k_send_flags);
+        shutdown(kv.first, SHUT_RDWR);
+        close(kv.first);
+    }
+    clients_.clear();
+    n_clients_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,160 @@
+// Single-threaded fan-out of subtitle frames to every /events connection.
+
+#pragma once
+
+#include "subtitle_events.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Readiness poller: epoll on Linux, kqueue on macOS/BSD.
+class event_poller {
+public:
+    enum : uint32_t {
+        ev_readable = 1u << 0,
+        ev_writable = 1u << 1,
+        ev_hangup   = 1u << 2,
+    };
+
+    struct event {
+        int      fd;
+        uint32_t flags;
+    };
+
+    event_poller();
+
+    ~event_poller();
+
+    event_poller(const event_poller &) = delete;
+    event_poller & operator=(const event_poller &) = delete;
+
+    bool valid() const { return fd_ >= 0; }
+
+    bool add(int fd, bool want_write);
+
+    bool set_want_write(int fd, bool want_write);
+
+    // Closing the fd removes it from both epoll and kqueue sets; this only
+    // exists so callers don't depend on that.
+    void remove(int fd);
+
+    int wait(std::vector<event> & out, int timeout_ms);
+
+private:
+    int fd_ = -1;
+};
+
+// Owns every /events socket after the handoff. A single thread writes each
+// published frame to all clients with non-blocking sends; whatever the
+// kernel doesn't accept is kept in a per-client buffer, and clients whose
+// backlog exceeds the limit are dropped instead of slowing everyone down.
+//
+// The response headers announced chunked transfer encoding, so every SSE
+// message is written as one HTTP chunk.
+//
+// Delta-mode clients get a keyframe on connect and every
+// k_delta_keyframe_interval frames; in between they get build_delta_event()
+// against the frame they last received. Deltas are computed once per
+// distinct base frame, not once per client.
+class sse_broadcaster {
+public:
+    static constexpr size_t k_max_client_backlog      = 256 * 1024;
+    static constexpr int    k_keepalive_ms            = 15000;
+    static constexpr int    k_delta_keyframe_interval = 32;
+    // Latency beacons requested per frame across all viewers.
+    static constexpr double k_beacons_per_frame       = 16.0;
+
+    ~sse_broadcaster();
+
+    bool start();
+
+    void stop();
+
+    // Called from an HTTP worker; ownership of `sock` moves to the broadcaster.
+    void add_client(int sock, sse_mode mode);
+
+    // Server status as an `event: status` message (startup progress). The
+    // latest status is also replayed to every client that connects later.
+    void publish_status(const std::string & json);
+
+    // Called from the main loop. Only the newest frame matters: a frame that
+    // is superseded before the loop picks it up is never sent.
+    void publish(subtitle_frame frame);
+
+    size_t client_count() const;
+
+    // Clients disconnected for exceeding k_max_client_backlog.
+    uint64_t dropped_count() const;
+
+private:
+    struct pending_client {
+        int sock;
+        sse_mode mode;
+    };
+
+    struct client {
+        sse_mode    mode = sse_mode::full;
+        std::string backlog;
+        size_t      backlog_off = 0;
+
+        // Delta mode: the frame this client's state is based on.
+        std::shared_ptr<const subtitle_frame> last;
+        int frames_since_key = 0;
+    };
+
+    static void set_nonblocking(int fd);
+
+    // Non-blocking, and no SIGPIPE on sends to a closed peer.
+    static void prepare_client(int fd);
+
+    static std::string encode_chunk(const std::string & payload);
+
+    void wake();
+
+    // Returns false when the client has to be dropped.
+    bool flush_client(int fd, client & c);
+
+    bool send_to_client(int fd, client & c, const std::string & data);
+
+    void drop_client(int fd);
+
+    // Picks the message for one client and records what it was based on.
+    const std::string & message_for(client & c,
+                                    const std::shared_ptr<const subtitle_frame> & frame,
+                                    const std::string & meta,
+                                    std::string & full_chunk,
+                                    std::string & key_chunk,
+                                    std::unordered_map<const subtitle_frame *, std::string> & delta_chunks);
+
+    // Sampling keeps beacon traffic roughly constant however many viewers
+    // are connected.
+    double beacon_rate() const;
+
+    void broadcast_frame(const std::shared_ptr<const subtitle_frame> & frame);
+
+    void broadcast(const std::string & data);
+
+    void run();
+
+    event_poller                       poller_;
+    int                                wake_fds_[2] = {-1, -1};
+    std::thread                        thread_;
+    std::atomic<bool>                  running_{false};
+
+    std::mutex                         mtx_;
+    std::vector<pending_client>           pending_clients_;
+    std::shared_ptr<const subtitle_frame> pending_frame_;
+    std::string                           pending_status_;
+
+    // Event-loop thread only.
+    std::unordered_map<int, client>    clients_;
+
+    std::atomic<size_t>                n_clients_{0};
+    std::atomic<uint64_t>              n_dropped_{0};
+};
@@ -0,0 +1,98 @@
+#include "subtitle_events.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cstdio>
+
+std::string frame_meta_json(const subtitle_frame & f, double beacon) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             ",\"timing\":{\"capture\":%lld,\"infer_start\":%lld,\"infer_end\":%lld,"
+             "\"translated\":%lld,\"publish\":%lld},\"beacon\":%.4g",
+             (long long)f.timing.capture_ms, (long long)f.timing.infer_start_ms,
+             (long long)f.timing.infer_end_ms, (long long)f.timing.translated_ms,
+             (long long)f.timing.publish_ms, beacon);
+    std::string meta = buf;
+    if (f.tier >= 0) {
+        meta += ",\"tier\":" + std::to_string(f.tier);
+    }
+    if (f.language_prob >= 0.0f) {
+        snprintf(buf, sizeof(buf), ",\"language_prob\":%.3f", f.language_prob);
+        meta += buf;
+    }
+    if (f.confidence >= 0.0f) {
+        snprintf(buf, sizeof(buf), ",\"confidence\":%.3f", f.confidence);
+        meta += buf;
+    }
+    if (f.no_speech_prob >= 0.0f) {
+        snprintf(buf, sizeof(buf), ",\"no_speech_prob\":%.3f", f.no_speech_prob);
+        meta += buf;
+    }
+    if (f.stitch_remove >= 0) {
+        meta += ",\"stitch\":{\"remove\":" + std::to_string(f.stitch_remove) +
+                "," + json_str("append", f.stitch_append) + "}";
+    }
+    return meta;
+}
+
+size_t utf8_common_prefix(const std::string & a, const std::string & b) {
+    const size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    auto is_continuation = [](const std::string & s, size_t pos) {
+        return pos < s.size() && (static_cast<unsigned char>(s[pos]) & 0xC0) == 0x80;
+    };
+    while (i > 0 && (is_continuation(a, i) || is_continuation(b, i))) {
+        --i;
+    }
+    return i;
+}
+
+size_t utf16_length(const std::string & s, size_t n_bytes) {
+    size_t units = 0;
+    for (size_t i = 0; i < n_bytes; ++i) {
+        const unsigned char uc = static_cast<unsigned char>(s[i]);
+        if ((uc & 0xC0) == 0x80) continue;
+        units += (uc >= 0xF0) ? 2 : 1;
+    }
+    return units;
+}
+
+std::string build_full_event(const subtitle_frame & f, const std::string & meta) {
+    std::string json = "{\"v\":" + std::to_string(f.version) +
+                       "," + json_str("text", f.text) +
+                       "," + json_str("translated", f.translated) +
+                       "," + json_str("language", f.language) + meta + "}";
+    return "data: " + json + "\n\n";
+}
+
+std::string build_key_event(const subtitle_frame & f, const std::string & meta) {
+    std::string json = "{\"v\":" + std::to_string(f.version) +
+                       ",\"key\":true," + json_str("text", f.text) +
+                       "," + json_str("translated", f.translated) +
+                       "," + json_str("language", f.language) + meta + "}";
+    return "data: " + json + "\n\n";
+}
+
+std::string build_delta_event(const subtitle_frame & base, const subtitle_frame & f,
+                              const std::string & meta) {
+    std::string json = "{\"v\":" + std::to_string(f.version) +
+                       ",\"base\":" + std::to_string(base.version);
+
+    auto append_field = [&](const char * key, const std::string & before, const std::string & after) {
+        if (before == after) return;
+        const size_t prefix = utf8_common_prefix(before, after);
+        json += std::string(",\"") + key + "\":[" + std::to_string(utf16_length(after, prefix)) +
+                ",\"" + escape_json(after.substr(prefix)) + "\"]";
+    };
+    append_field("text",       base.text,       f.text);
+    append_field("translated", base.translated, f.translated);
+    if (base.language != f.language) {
+        json += "," + json_str("language", f.language);
+    }
+
+    json += meta + "}";
+    return "data: " + json + "\n\n";
+}
@@ -0,0 +1,75 @@
+// Published subtitle state and its SSE encodings (full events, and keyframe
+// + delta events for ?mode=delta clients).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct subtitle_state {
+    std::mutex              mtx;
+    std::string             text;
+    std::string             translated;
+    std::string             language;
+    std::string             source_lang = "ko";
+    std::string             target_lang;
+    uint64_t                version = 0;
+};
+
+// One published subtitle update. Frames are immutable once published and
+// shared between the broadcaster and the clients that last received them.
+// Pipeline timestamps of one segment, unix ms on the server clock.
+struct segment_timing {
+    int64_t capture_ms     = 0;  // newest sample of the step became available
+    int64_t infer_start_ms = 0;  // whisper_full() called
+    int64_t infer_end_ms   = 0;  // whisper_full() returned
+    int64_t translated_ms  = 0;  // translation done (= infer_end_ms if none)
+    int64_t publish_ms     = 0;  // handed to the broadcaster
+};
+
+struct subtitle_frame {
+    uint64_t       version = 0;
+    std::string    text;
+    std::string    translated;
+    std::string    language;
+    segment_timing timing;
+    int            tier = -1;   // model fallback tier, -1 without --fallback-models
+    float          language_prob = -1.0f;   // identification confidence of a pinned language (--lang-detect)
+    float          confidence = -1.0f;      // mean token probability of the step, -1 if unknown
+    float          no_speech_prob = -1.0f;  // whisper's no-speech probability for the window, -1 if unknown
+    int            stitch_remove = -1;      // --stitch: UTF-16 units to drop from the running transcript, -1 without
+    std::string    stitch_append;           // --stitch: text to append to it afterwards
+};
+
+enum class sse_mode {
+    full,
+    delta,
+};
+
+// Fields that every event format carries verbatim, starting with a comma.
+// `beacon` is the probability with which a viewer should report its receive
+// time to /api/latency (see sse_broadcaster::beacon_rate).
+std::string frame_meta_json(const subtitle_frame & f, double beacon);
+
+// Length of the common prefix of a and b, cut back to a UTF-8 code point
+// boundary so the suffix never starts mid-character.
+size_t utf8_common_prefix(const std::string & a, const std::string & b);
+
+// Number of UTF-16 code units in s[0, n_bytes); this is what String.slice()
+// counts on the browser side.
+size_t utf16_length(const std::string & s, size_t n_bytes);
+
+// Full event (default /events mode).
+std::string build_full_event(const subtitle_frame & f, const std::string & meta);
+
+// Delta-mode keyframe: the complete state, tagged with its version.
+std::string build_key_event(const subtitle_frame & f, const std::string & meta);
+
+// Delta-mode update relative to `base` (what this client last received).
+// Changed string fields are sent as [prefix, suffix]: keep the first
+// `prefix` UTF-16 units of the old value and append `suffix`. Unchanged
+// fields are omitted.
+std::string build_delta_event(const subtitle_frame & base, const subtitle_frame & f,
+                              const std::string & meta);
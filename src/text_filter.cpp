@@ -0,0 +1,162 @@
+#include "text_filter.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+std::string normalize_for_dedup(const std::string & text) {
+    std::string out;
+    out.reserve(text.size());
+
+    for (char c : text) {
+        const unsigned char uc = static_cast<unsigned char>(c);
+        if (std::isspace(uc) || std::ispunct(uc)) {
+            continue;
+        }
+        if (uc < 0x80) {
+            out.push_back(static_cast<char>(std::tolower(uc)));
+        } else {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+static std::string normalize_repeat_token(const std::string & token) {
+    size_t start = 0;
+    size_t end = token.size();
+
+    while (start < end && std::ispunct(static_cast<unsigned char>(token[start]))) {
+        ++start;
+    }
+    while (end > start && std::ispunct(static_cast<unsigned char>(token[end - 1]))) {
+        --end;
+    }
+    if (start >= end) {
+        return "";
+    }
+
+    std::string normalized = token.substr(start, end - start);
+    for (char & c : normalized) {
+        const unsigned char uc = static_cast<unsigned char>(c);
+        if (uc < 0x80) {
+            c = static_cast<char>(std::tolower(uc));
+        }
+    }
+    return normalized;
+}
+
+static std::vector<std::string> split_repetition_tokens(const std::string & text) {
+    std::vector<std::string> out;
+    std::string current;
+
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!current.empty()) {
+                std::string token = normalize_repeat_token(current);
+                if (!token.empty()) {
+                    out.push_back(token);
+                }
+                current.clear();
+            }
+            continue;
+        }
+        current.push_back(c);
+    }
+
+    if (!current.empty()) {
+        std::string token = normalize_repeat_token(current);
+        if (!token.empty()) {
+            out.push_back(token);
+        }
+    }
+
+    return out;
+}
+
+bool should_drop_repetitive_text(const std::string & text,
+                                 const std::string & prev_text,
+                                 std::string & reason) {
+    const std::vector<std::string> tokens = split_repetition_tokens(text);
+    if (tokens.empty()) {
+        return false;
+    }
+
+    if (tokens.size() >= 8) {
+        std::unordered_map<std::string, int> counts;
+        int max_count = 0;
+        for (const std::string & token : tokens) {
+            const int next = ++counts[token];
+            max_count = std::max(max_count, next);
+        }
+
+        const float dominant_ratio = (float)max_count / (float)tokens.size();
+        if (dominant_ratio >= 0.75f) {
+            reason = "dominant-token-ratio";
+            return true;
+        }
+    }
+
+    int max_run = 1;
+    int run = 1;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        if (tokens[i] == tokens[i - 1]) {
+            ++run;
+            max_run = std::max(max_run, run);
+        } else {
+            run = 1;
+        }
+    }
+    if (max_run >= 5) {
+        reason = "consecutive-token-repeat";
+        return true;
+    }
+
+    if (!prev_text.empty() && text.size() > prev_text.size() && text.rfind(prev_text, 0) == 0) {
+        std::string suffix = trim_whitespace(text.substr(prev_text.size()));
+        std::vector<std::string> suffix_tokens = split_repetition_tokens(suffix);
+        if (suffix_tokens.size() >= 4) {
+            std::unordered_set<std::string> unique_tokens(suffix_tokens.begin(), suffix_tokens.end());
+            if (unique_tokens.size() == 1) {
+                reason = "suffix-single-token-repeat";
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+double text_compression_ratio(const std::string & text) {
+    static constexpr size_t k_min_match = 4;
+    static constexpr size_t k_ref_cost  = 3;
+
+    const size_t n = text.size();
+    if (n == 0) return 0.0;
+
+    // Greedy longest match against everything before `pos`; segment text is
+    // a few hundred bytes at most, so the quadratic search is cheap.
+    size_t cost = 0;
+    size_t pos = 0;
+    while (pos < n) {
+        size_t best = 0;
+        for (size_t start = 0; start < pos; ++start) {
+            size_t len = 0;
+            while (pos + len < n && text[start + len] == text[pos + len]) {
+                ++len;
+            }
+            best = std::max(best, len);
+        }
+        if (best >= k_min_match) {
+            cost += k_ref_cost;
+            pos += best;
+        } else {
+            cost += 1;
+            pos += 1;
+        }
+    }
+    return (double)n / (double)cost;
+}
@@ -0,0 +1,23 @@
+// Filters applied to recognized text before it is published: duplicate
+// suppression and hallucinated-repetition detection.
+
+#pragma once
+
+#include <string>
+
+// Lowercased ASCII with whitespace and punctuation removed, so that two
+// segments differing only in spacing or punctuation compare equal.
+std::string normalize_for_dedup(const std::string & text);
+
+// True when `text` looks like a decoder loop (one token dominating, long
+// runs of the same token, or `prev_text` extended by a single repeated
+// token). `reason` names the rule that fired.
+bool should_drop_repetitive_text(const std::string & text,
+                                 const std::string & prev_text,
+                                 std::string & reason);
+
+// Size of `text` over an estimate of its LZ77-compressed size (literals
+// cost one byte, back-references of 4+ bytes cost three). Whisper's
+// compression-ratio check without a zlib dependency: ordinary speech stays
+// near 1, a decoder loop repeating a phrase climbs past 2.
+double text_compression_ratio(const std::string & text);
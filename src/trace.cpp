@@ -0,0 +1,206 @@
+#include "trace.h"
+#include "json.h"
+#include "spsc_ring.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+std::atomic<bool> g_trace_enabled{false};
+
+namespace {
+
+// Per-thread ring size; at a few dozen spans per step this holds minutes
+// of backlog, so drops only happen when the writer is stalled on disk.
+constexpr size_t  k_ring_events      = 16384;
+constexpr int64_t k_drain_interval_ms = 100;
+
+struct trace_event {
+    const char * name     = nullptr;
+    const char * cat      = nullptr;
+    const char * arg_name = nullptr;
+    int64_t      arg      = 0;
+    int64_t      ts_us    = 0;
+    int64_t      dur_us   = 0;
+};
+
+struct thread_buffer {
+    explicit thread_buffer(int tid) : ring(k_ring_events), tid(tid) {}
+
+    spsc_ring<trace_event>     ring;   // owning thread -> writer
+    int                        tid;
+    std::atomic<const char *>  name{nullptr};
+};
+
+std::atomic<int64_t>  g_epoch_ns{0};
+std::atomic<uint64_t> g_dropped{0};
+
+// Buffers live until exit: a thread may still hold its pointer after
+// trace_stop().
+std::mutex                                  g_registry_mtx;
+std::vector<std::unique_ptr<thread_buffer>> g_buffers;
+
+// Writer state.
+FILE *                  g_file = nullptr;
+std::string             g_path;
+std::thread             g_writer;
+std::atomic<bool>       g_writer_running{false};
+std::mutex              g_wait_mtx;
+std::condition_variable g_cv;
+uint64_t                g_written     = 0;
+bool                    g_first_event = true;
+
+thread_local thread_buffer * t_buffer      = nullptr;
+thread_local const char *    t_thread_name = nullptr;
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+thread_buffer * buffer_for_this_thread() {
+    if (!t_buffer) {
+        std::lock_guard<std::mutex> lock(g_registry_mtx);
+        g_buffers.push_back(std::make_unique<thread_buffer>((int)g_buffers.size() + 1));
+        t_buffer = g_buffers.back().get();
+        t_buffer->name.store(t_thread_name, std::memory_order_relaxed);
+    }
+    return t_buffer;
+}
+
+void write_record(const char * record) {
+    fputs(g_first_event ? "\n" : ",\n", g_file);
+    fputs(record, g_file);
+    g_first_event = false;
+}
+
+void write_event(const trace_event & ev, int tid) {
+    char line[320];
+    int n = snprintf(line, sizeof(line),
+                     "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%d",
+                     ev.name, ev.cat, (long long)ev.ts_us, (long long)ev.dur_us, (int)getpid(), tid);
+    if (ev.arg_name && n > 0 && (size_t)n < sizeof(line)) {
+        n += snprintf(line + n, sizeof(line) - (size_t)n, ",\"args\":{\"%s\":%lld}",
+                      ev.arg_name, (long long)ev.arg);
+    }
+    if (n > 0 && (size_t)n + 1 < sizeof(line)) {
+        line[n]     = '}';
+        line[n + 1] = '\0';
+        write_record(line);
+        ++g_written;
+    }
+}
+
+void drain_all() {
+    std::vector<thread_buffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mtx);
+        for (const auto & b : g_buffers) buffers.push_back(b.get());
+    }
+    trace_event ev;
+    for (thread_buffer * b : buffers) {
+        while (b->ring.try_pop(ev)) {
+            write_event(ev, b->tid);
+        }
+    }
+}
+
+void run_writer() {
+    while (true) {
+        const bool keep_running = g_writer_running.load();
+        drain_all();
+        fflush(g_file);
+        if (!keep_running) break;
+
+        std::unique_lock<std::mutex> lock(g_wait_mtx);
+        g_cv.wait_for(lock, std::chrono::milliseconds(k_drain_interval_ms));
+    }
+}
+
+} // namespace
+
+bool trace_start(const std::string & path) {
+    if (g_file) return false;
+    g_file = fopen(path.c_str(), "w");
+    if (!g_file) {
+        fprintf(stderr, "error: cannot create trace file '%s'\n", path.c_str());
+        return false;
+    }
+    static char file_buf[1 << 20];
+    setvbuf(g_file, file_buf, _IOFBF, sizeof(file_buf));
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", g_file);
+
+    g_path = path;
+    g_epoch_ns.store(steady_ns(), std::memory_order_relaxed);
+    g_writer_running = true;
+    g_writer = std::thread(run_writer);
+    g_trace_enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void trace_stop() {
+    if (!g_trace_enabled.exchange(false)) return;
+
+    g_writer_running = false;
+    g_cv.notify_one();
+    if (g_writer.joinable()) g_writer.join();
+
+    // Metadata last: names set after a thread's first span still show up.
+    char line[320];
+    snprintf(line, sizeof(line),
+             "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"live-subtitle\"}}",
+             (int)getpid());
+    write_record(line);
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mtx);
+        for (const auto & b : g_buffers) {
+            const char * name = b->name.load(std::memory_order_relaxed);
+            const std::string label = name ? name : "thread " + std::to_string(b->tid);
+            const std::string record = "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" +
+                                       std::to_string((int)getpid()) + ",\"tid\":" + std::to_string(b->tid) +
+                                       ",\"args\":{" + json_str("name", label) + "}}";
+            write_record(record.c_str());
+        }
+    }
+    fputs("\n]}\n", g_file);
+    fclose(g_file);
+    g_file = nullptr;
+
+    fprintf(stderr, "trace: %llu spans written to %s (%llu dropped)\n",
+            (unsigned long long)g_written, g_path.c_str(),
+            (unsigned long long)g_dropped.load());
+}
+
+int64_t trace_now_us() {
+    return (steady_ns() - g_epoch_ns.load(std::memory_order_relaxed)) / 1000;
+}
+
+void trace_set_thread_name(const char * name) {
+    t_thread_name = name;
+    if (t_buffer) t_buffer->name.store(name, std::memory_order_relaxed);
+}
+
+void trace_complete(const char * name, const char * cat, int64_t start_us, int64_t end_us,
+                    const char * arg_name, int64_t arg) {
+    if (!trace_enabled()) return;
+    trace_event ev;
+    ev.name     = name;
+    ev.cat      = cat;
+    ev.arg_name = arg_name;
+    ev.arg      = arg;
+    ev.ts_us    = start_us;
+    ev.dur_us   = end_us - start_us;
+    if (!buffer_for_this_thread()->ring.try_push(std::move(ev))) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint64_t trace_dropped_count() {
+    return g_dropped.load(std::memory_order_relaxed);
+}
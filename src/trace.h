@@ -0,0 +1,71 @@
+// Chrome trace-event recording of pipeline spans (--trace FILE).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Every thread that records a span gets its own lock-free ring, registered
+// on first use; a writer thread drains the rings into FILE as Chrome
+// trace-event JSON ("X" complete events), which Perfetto and
+// chrome://tracing open directly. A full ring drops the event instead of
+// blocking the pipeline. With tracing off a span costs one relaxed load.
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool trace_enabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// Opens FILE and starts the writer. Call before the threads to be traced
+// record anything.
+bool trace_start(const std::string & path);
+
+// Drains every ring, terminates the JSON and closes the file.
+void trace_stop();
+
+// Microseconds on the trace clock (steady, 0 = trace_start).
+int64_t trace_now_us();
+
+// Names the calling thread in the trace. Static string; may be called
+// before trace_start.
+void trace_set_thread_name(const char * name);
+
+// One complete span. name, cat and arg_name must be static strings;
+// arg_name == nullptr records no args.
+void trace_complete(const char * name, const char * cat, int64_t start_us, int64_t end_us,
+                    const char * arg_name = nullptr, int64_t arg = 0);
+
+uint64_t trace_dropped_count();
+
+// Records [construction, end() or destruction) as one span.
+class trace_span {
+public:
+    trace_span(const char * name, const char * cat, const char * arg_name = nullptr, int64_t arg = 0)
+        : name_(name), cat_(cat), arg_name_(arg_name), arg_(arg),
+          start_us_(trace_enabled() ? trace_now_us() : -1) {}
+
+    ~trace_span() { end(); }
+
+    trace_span(const trace_span &) = delete;
+    trace_span & operator=(const trace_span &) = delete;
+
+    void set_arg(const char * arg_name, int64_t arg) {
+        arg_name_ = arg_name;
+        arg_      = arg;
+    }
+
+    void end() {
+        if (start_us_ < 0) return;
+        trace_complete(name_, cat_, start_us_, trace_now_us(), arg_name_, arg_);
+        start_us_ = -1;
+    }
+
+private:
+    const char * name_;
+    const char * cat_;
+    const char * arg_name_;
+    int64_t      arg_;
+    int64_t      start_us_;
+};
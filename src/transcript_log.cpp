@@ -0,0 +1,262 @@
+#include "transcript_log.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+transcript_segment_view::transcript_segment_view(const std::string & path, size_t size) {
+    if (size == 0) return;
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    void * p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return;
+    madvise(p, size, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(p);
+    size_ = size;
+}
+
+transcript_segment_view::~transcript_segment_view() {
+    if (data_) munmap(const_cast<char *>(data_), size_);
+}
+
+transcript_log::~transcript_log() {
+    stop();
+}
+
+bool transcript_log::open_dir(const std::string & dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        fprintf(stderr, "error: cannot create history dir '%s': %s\n", dir.c_str(), ec.message().c_str());
+        return false;
+    }
+    dir_ = dir;
+
+    // Previous sessions stay queryable; their index is rebuilt by a scan.
+    std::vector<std::string> paths;
+    for (const auto & entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("transcript-", 0) == 0 && entry.path().extension() == ".seg") {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const std::string & path : paths) {
+        load_existing_segment(path);
+    }
+
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void transcript_log::stop() {
+    if (!running_.exchange(false)) return;
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void transcript_log::append(transcript_entry entry) {
+    if (!queue_.try_push(std::move(entry))) {
+        n_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    cv_.notify_one();
+}
+
+uint64_t transcript_log::dropped_count() const {
+    return n_dropped_.load(std::memory_order_relaxed);
+}
+
+size_t transcript_log::record_size(const transcript_entry & e) {
+    const size_t raw = sizeof(transcript_record_header) + e.language.size() + e.text.size() + e.translated.size();
+    return (raw + 7) & ~size_t(7);
+}
+
+size_t transcript_log::page_floor(size_t v) {
+    static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return v & ~(page - 1);
+}
+
+void transcript_log::load_existing_segment(const std::string & path) {
+    std::error_code ec;
+    const size_t file_size = (size_t)std::filesystem::file_size(path, ec);
+    if (ec || file_size == 0) return;
+
+    auto seg = std::make_shared<transcript_segment>();
+    seg->path = path;
+
+    transcript_segment_view view(path, file_size);
+    if (!view.data()) return;
+
+    size_t offset = 0;
+    size_t n_records = 0;
+    while (offset + sizeof(transcript_record_header) <= file_size) {
+        transcript_record_header hdr;
+        memcpy(&hdr, view.data() + offset, sizeof(hdr));
+        if (hdr.magic != k_transcript_magic || hdr.total_size < sizeof(hdr) ||
+            offset + hdr.total_size > file_size) {
+            break;
+        }
+        if (n_records == 0) seg->first_ts = hdr.timestamp_ms;
+        if (n_records % k_index_stride == 0) seg->index.emplace_back(hdr.timestamp_ms, offset);
+        seg->last_ts.store(hdr.timestamp_ms, std::memory_order_relaxed);
+        offset += hdr.total_size;
+        ++n_records;
+    }
+    if (n_records == 0) return;
+
+    seg->committed.store(offset, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(segments_mtx_);
+    segments_.push_back(std::move(seg));
+}
+
+bool transcript_log::open_new_segment(int64_t first_ts) {
+    char name[64];
+    snprintf(name, sizeof(name), "transcript-%013lld.seg", (long long)first_ts);
+    const std::string path = (std::filesystem::path(dir_) / name).string();
+
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "warning: history: cannot create '%s'\n", path.c_str());
+        return false;
+    }
+    if (ftruncate(fd, (off_t)k_segment_bytes) != 0) {
+        close(fd);
+        fprintf(stderr, "warning: history: cannot size '%s'\n", path.c_str());
+        return false;
+    }
+    void * p = mmap(nullptr, k_segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        fprintf(stderr, "warning: history: cannot map '%s'\n", path.c_str());
+        return false;
+    }
+
+    map_fd_   = fd;
+    map_      = static_cast<char *>(p);
+    map_used_ = 0;
+    synced_   = 0;
+    n_in_segment_ = 0;
+
+    auto seg = std::make_shared<transcript_segment>();
+    seg->path     = path;
+    seg->first_ts = first_ts;
+    current_ = seg;
+    std::lock_guard<std::mutex> lock(segments_mtx_);
+    segments_.push_back(std::move(seg));
+    return true;
+}
+
+void transcript_log::sync_current() {
+    if (!map_ || synced_ == map_used_) return;
+
+    const size_t from = page_floor(synced_);
+    msync(map_ + from, map_used_ - from, MS_SYNC);
+    // Everything up to the last full page is on disk now; let it go.
+    const size_t drop_end = page_floor(map_used_);
+    if (drop_end > from) {
+        madvise(map_ + from, drop_end - from, MADV_DONTNEED);
+    }
+    synced_ = map_used_;
+}
+
+void transcript_log::close_current() {
+    if (!map_) return;
+    sync_current();
+    munmap(map_, k_segment_bytes);
+    if (ftruncate(map_fd_, (off_t)map_used_) != 0) {
+        fprintf(stderr, "warning: history: cannot trim '%s'\n", current_->path.c_str());
+    }
+    close(map_fd_);
+    map_ = nullptr;
+    map_fd_ = -1;
+    current_.reset();
+}
+
+void transcript_log::write_entry(const transcript_entry & e) {
+    const size_t size = record_size(e);
+    if (size > k_segment_bytes) return;
+
+    if (!map_ || map_used_ + size > k_segment_bytes) {
+        close_current();
+        if (!open_new_segment(e.timestamp_ms)) {
+            n_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    transcript_record_header hdr = {};
+    hdr.magic          = k_transcript_magic;
+    hdr.total_size     = (uint32_t)size;
+    hdr.timestamp_ms   = e.timestamp_ms;
+    hdr.version        = e.version;
+    hdr.language_len   = (uint32_t)e.language.size();
+    hdr.text_len       = (uint32_t)e.text.size();
+    hdr.translated_len = (uint32_t)e.translated.size();
+    hdr.revises        = e.revises;
+
+    char * p = map_ + map_used_;
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+    memcpy(p, e.language.data(), e.language.size());
+    p += e.language.size();
+    memcpy(p, e.text.data(), e.text.size());
+    p += e.text.size();
+    memcpy(p, e.translated.data(), e.translated.size());
+
+    if (n_in_segment_ % k_index_stride == 0) {
+        std::lock_guard<std::mutex> lock(current_->index_mtx);
+        current_->index.emplace_back(e.timestamp_ms, map_used_);
+    }
+    ++n_in_segment_;
+    map_used_ += size;
+
+    current_->last_ts.store(e.timestamp_ms, std::memory_order_relaxed);
+    current_->committed.store(map_used_, std::memory_order_release);
+}
+
+void transcript_log::run() {
+    auto last_sync = std::chrono::steady_clock::now();
+    transcript_entry entry;
+
+    while (true) {
+        const bool keep_running = running_.load();
+        bool wrote = false;
+        while (queue_.try_pop(entry)) {
+            write_entry(entry);
+            wrote = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!keep_running ||
+            now - last_sync >= std::chrono::milliseconds(k_sync_interval_ms)) {
+            sync_current();
+            last_sync = now;
+        }
+        if (!keep_running) break;
+
+        if (!wrote) {
+            std::unique_lock<std::mutex> lock(wait_mtx_);
+            cv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+    close_current();
+}
+
+std::string format_cue_time(int64_t ms, bool vtt) {
+    if (ms < 0) ms = 0;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld%c%03lld",
+             (long long)(ms / 3600000), (long long)(ms / 60000 % 60),
+             (long long)(ms / 1000 % 60), vtt ? '.' : ',', (long long)(ms % 1000));
+    return buf;
+}
@@ -0,0 +1,202 @@
+// Durable transcript history: append-only, memory-mapped segment files.
+
+#pragma once
+
+#include "spsc_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct transcript_entry {
+    int64_t     timestamp_ms = 0;
+    uint64_t    version      = 0;
+    std::string language;
+    std::string text;
+    std::string translated;
+    uint32_t    revises = 0;   // --stitch: trailing words of earlier entries this one replaces
+};
+
+// On-disk record: header followed by language, text and translated bytes,
+// padded to 8 bytes. A zero magic marks the end of a segment.
+struct transcript_record_header {
+    uint32_t magic;
+    uint32_t total_size;
+    int64_t  timestamp_ms;
+    uint64_t version;
+    uint32_t language_len;
+    uint32_t text_len;
+    uint32_t translated_len;
+    uint32_t revises;   // 0 in records written before --stitch
+};
+
+static constexpr uint32_t k_transcript_magic = 0x5254534cu;  // "LSTR"
+
+// One segment file. The writer thread owns the read-write mapping; readers
+// only look at [0, committed) through their own read-only mappings.
+struct transcript_segment {
+    std::string          path;
+    int64_t              first_ts = 0;
+    std::atomic<int64_t> last_ts{0};
+    std::atomic<size_t>  committed{0};
+
+    // Sparse time index: (timestamp, offset) every k_index_stride records.
+    std::mutex                               index_mtx;
+    std::vector<std::pair<int64_t, size_t>>  index;
+};
+
+// Read-only view of a segment for one HTTP response; unmapped afterwards so
+// history queries don't leave pages charged to the process.
+class transcript_segment_view {
+public:
+    transcript_segment_view(const std::string & path, size_t size);
+
+    ~transcript_segment_view();
+
+    transcript_segment_view(const transcript_segment_view &) = delete;
+    transcript_segment_view & operator=(const transcript_segment_view &) = delete;
+
+    const char * data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char * data_ = nullptr;
+    size_t       size_ = 0;
+};
+
+// Durable history of emitted subtitles.
+//
+// append() is called from the inference thread and never blocks: entries go
+// through a lock-free ring to a writer thread, which copies them into the
+// current segment's mapping and msyncs in batches. Synced pages are dropped
+// from the mapping (MADV_DONTNEED), so resident memory stays flat no matter
+// how long the session runs; the data lives on in the file and page cache.
+class transcript_log {
+public:
+    static constexpr size_t  k_segment_bytes  = 64u * 1024u * 1024u;
+    static constexpr size_t  k_index_stride   = 64;
+    static constexpr size_t  k_queue_capacity = 1024;
+    static constexpr int64_t k_sync_interval_ms = 1000;
+
+    transcript_log() : queue_(k_queue_capacity) {}
+
+    ~transcript_log();
+
+    bool open_dir(const std::string & dir);
+
+    void stop();
+
+    // Inference thread. Drops (and counts) the entry if the writer is behind.
+    void append(transcript_entry entry);
+
+    uint64_t dropped_count() const;
+
+    // Calls fn(entry) for every record with from_ms <= timestamp <= to_ms, in
+    // order, reading straight from the segment files. fn returns false to stop.
+    template <typename Fn>
+    void for_each(int64_t from_ms, int64_t to_ms, Fn && fn) const {
+        std::vector<std::shared_ptr<transcript_segment>> segments;
+        {
+            std::lock_guard<std::mutex> lock(segments_mtx_);
+            segments = segments_;
+        }
+
+        for (const auto & seg : segments) {
+            const size_t committed = seg->committed.load(std::memory_order_acquire);
+            if (committed == 0 || seg->first_ts > to_ms ||
+                seg->last_ts.load(std::memory_order_relaxed) < from_ms) {
+                continue;
+            }
+
+            size_t offset = 0;
+            {
+                std::lock_guard<std::mutex> lock(seg->index_mtx);
+                // Start before every record at from_ms: an index point may
+                // fall among records sharing a timestamp.
+                auto it = std::lower_bound(seg->index.begin(), seg->index.end(), from_ms,
+                    [](const std::pair<int64_t, size_t> & e, int64_t ts) { return e.first < ts; });
+                if (it != seg->index.begin()) offset = std::prev(it)->second;
+            }
+
+            transcript_segment_view view(seg->path, committed);
+            if (!view.data()) continue;
+
+            transcript_entry entry;
+            while (offset + sizeof(transcript_record_header) <= committed) {
+                transcript_record_header hdr;
+                memcpy(&hdr, view.data() + offset, sizeof(hdr));
+                if (hdr.magic != k_transcript_magic || offset + hdr.total_size > committed) break;
+
+                if (hdr.timestamp_ms > to_ms) return;
+                if (hdr.timestamp_ms >= from_ms) {
+                    const char * p = view.data() + offset + sizeof(hdr);
+                    entry.timestamp_ms = hdr.timestamp_ms;
+                    entry.version      = hdr.version;
+                    entry.revises      = hdr.revises;
+                    entry.language.assign(p, hdr.language_len);
+                    p += hdr.language_len;
+                    entry.text.assign(p, hdr.text_len);
+                    p += hdr.text_len;
+                    entry.translated.assign(p, hdr.translated_len);
+                    if (!fn(entry)) return;
+                }
+                offset += hdr.total_size;
+            }
+        }
+    }
+
+private:
+    static size_t record_size(const transcript_entry & e);
+
+    static size_t page_floor(size_t v);
+
+    void load_existing_segment(const std::string & path);
+
+    bool open_new_segment(int64_t first_ts);
+
+    void sync_current();
+
+    // Seal: shrink the file to its records so a finished segment costs no
+    // more disk than its content.
+    void close_current();
+
+    void write_entry(const transcript_entry & e);
+
+    void run();
+
+    std::string                       dir_;
+    spsc_ring<transcript_entry>       queue_;
+    std::thread                       thread_;
+    std::atomic<bool>                 running_{false};
+    std::mutex                        wait_mtx_;
+    std::condition_variable           cv_;
+    std::atomic<uint64_t>             n_dropped_{0};
+
+    mutable std::mutex                               segments_mtx_;
+    std::vector<std::shared_ptr<transcript_segment>> segments_;
+
+    // Writer thread only.
+    std::shared_ptr<transcript_segment> current_;
+    int    map_fd_       = -1;
+    char * map_          = nullptr;
+    size_t map_used_     = 0;
+    size_t synced_       = 0;
+    size_t n_in_segment_ = 0;
+};
+
+// SRT/WebVTT cue timestamps. Each record is shown until the next one, for
+// at most k_max_cue_ms.
+static constexpr int64_t k_max_cue_ms = 5000;
+
+// HH:MM:SS,mmm (SRT) or HH:MM:SS.mmm (WebVTT).
+std::string format_cue_time(int64_t ms, bool vtt);
@@ -0,0 +1,240 @@
+#include "transcript_stitcher.h"
+#include "subtitle_events.h"
+#include "text_filter.h"
+
+#include <algorithm>
+
+// Code point at s[pos] and its byte length (1 for invalid bytes).
+static uint32_t utf8_at(const std::string & s, size_t pos, size_t & len) {
+    const unsigned char c = (unsigned char)s[pos];
+    len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+    if (pos + len > s.size()) len = 1;
+    if (len == 1) return c;
+    uint32_t cp = c & (0x7F >> len);
+    for (size_t i = 1; i < len; ++i) cp = (cp << 6) | ((unsigned char)s[pos + i] & 0x3F);
+    return cp;
+}
+
+// Scripts written without spaces between words.
+static bool is_unspaced_script(uint32_t cp) {
+    return (cp >= 0x3040 && cp <= 0x30FF) ||   // hiragana, katakana
+           (cp >= 0x3400 && cp <= 0x4DBF) ||   // CJK extension A
+           (cp >= 0x4E00 && cp <= 0x9FFF) ||   // CJK unified ideographs
+           (cp >= 0xF900 && cp <= 0xFAFF);     // CJK compatibility ideographs
+}
+
+std::vector<transcript_stitcher::token> transcript_stitcher::tokenize(const std::string & text) {
+    std::vector<token> out;
+    bool space_before = true;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const unsigned char c = (unsigned char)text[pos];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            space_before = true;
+            ++pos;
+            continue;
+        }
+        size_t len = 0;
+        const uint32_t cp = utf8_at(text, pos, len);
+        if (is_unspaced_script(cp)) {
+            out.push_back({ text.substr(pos, len), "", space_before });
+            pos += len;
+        } else {
+            // Up to the next space or unspaced-script character.
+            size_t end = pos + len;
+            while (end < text.size()) {
+                const unsigned char e = (unsigned char)text[end];
+                if (e == ' ' || e == '\t' || e == '\n' || e == '\r') break;
+                size_t n = 0;
+                if (is_unspaced_script(utf8_at(text, end, n))) break;
+                end += n;
+            }
+            out.push_back({ text.substr(pos, end - pos), "", space_before });
+            pos = end;
+        }
+        space_before = false;
+    }
+    for (auto & t : out) {
+        t.norm = normalize_for_dedup(t.raw);
+        if (t.norm.empty()) t.norm = t.raw;   // punctuation-only token
+    }
+    return out;
+}
+
+std::string transcript_stitcher::render(const std::vector<token> & tokens, size_t from, bool at_start) const {
+    std::string out;
+    for (size_t i = from; i < tokens.size(); ++i) {
+        if (tokens[i].space_before && !(at_start && i == from)) out += ' ';
+        out += tokens[i].raw;
+    }
+    return out;
+}
+
+stitch_update transcript_stitcher::stitch(const std::string & hypothesis) {
+    const std::vector<token> hyp = tokenize(hypothesis);
+    steps_.fetch_add(1, std::memory_order_relaxed);
+    hypothesis_tokens_.fetch_add(hyp.size(), std::memory_order_relaxed);
+
+    const size_t n = tail_.size();
+    const size_t m = hyp.size();
+
+    // Score of aligning tail_[s, i) with hyp[0, j): +1 per match, -1 per
+    // substitution, insertion or deletion. Any s is free (S[i][0] = 0).
+    std::vector<int> score((n + 1) * (m + 1), 0);
+    auto S = [&](size_t i, size_t j) -> int & { return score[i * (m + 1) + j]; };
+    for (size_t j = 1; j <= m; ++j) S(0, j) = -(int)j;
+    for (size_t i = 1; i <= n; ++i) {
+        for (size_t j = 1; j <= m; ++j) {
+            const int diag = S(i - 1, j - 1) + (tail_[i - 1].norm == hyp[j - 1].norm ? 1 : -1);
+            S(i, j) = std::max(diag, std::max(S(i - 1, j), S(i, j - 1)) - 1);
+        }
+    }
+
+    // The alignment must consume the whole tail; it may end anywhere in hyp.
+    size_t end_j = 0;
+    int best = 0;
+    for (size_t j = 1; j <= m && n > 0; ++j) {
+        if (S(n, j) >= best) {
+            best  = S(n, j);
+            end_j = j;
+        }
+    }
+
+    size_t keep_tail = n;   // tail tokens that survive
+    size_t from_hyp  = 0;   // first hyp token appended
+    if (n == 0 || m == 0 || best < std::min(k_min_overlap, (int)m)) {
+        no_overlap_.fetch_add(n > 0 && m > 0 ? 1 : 0, std::memory_order_relaxed);
+    } else {
+        // Trace the alignment back, then find its first disagreement after
+        // the first match.
+        enum class op { match, substitute, drop_tail, insert_hyp };
+        std::vector<op> ops;
+        size_t i = n, j = end_j;
+        while (i > 0 && j > 0) {
+            const bool eq = tail_[i - 1].norm == hyp[j - 1].norm;
+            if (S(i, j) == S(i - 1, j - 1) + (eq ? 1 : -1)) {
+                ops.push_back(eq ? op::match : op::substitute);
+                --i;
+                --j;
+            } else if (S(i, j) == S(i - 1, j) - 1) {
+                ops.push_back(op::drop_tail);
+                --i;
+            } else {
+                ops.push_back(op::insert_hyp);
+                --j;
+            }
+        }
+        // (i, j) is now where the alignment starts; hyp[0, j) are fragments.
+        std::reverse(ops.begin(), ops.end());
+
+        from_hyp = end_j;
+        bool matched = false;
+        for (const op o : ops) {
+            if (o == op::match) {
+                matched = true;
+            } else if (matched) {
+                keep_tail = i;
+                from_hyp  = j;
+                break;
+            }
+            if (o != op::insert_hyp) ++i;
+            if (o != op::drop_tail)  ++j;
+        }
+        // Nothing to put in place of the disagreeing words: the window just
+        // lost them, keep what was emitted.
+        if (from_hyp == m) keep_tail = n;
+    }
+
+    stitch_update out;
+    out.window_tokens = m;
+    if (keep_tail == n && from_hyp == m) {
+        unchanged_.fetch_add(1, std::memory_order_relaxed);
+        return out;
+    }
+
+    const std::string removed = render(tail_, keep_tail, keep_tail == 0 && !trimmed_);
+    out.remove_tokens = n - keep_tail;
+    out.remove_utf16  = utf16_length(removed, removed.size());
+
+    tail_.erase(tail_.begin() + (ptrdiff_t)keep_tail, tail_.end());
+    const bool at_start = tail_.empty() && !trimmed_;
+    const size_t first_new = tail_.size();
+    tail_.insert(tail_.end(), hyp.begin() + (ptrdiff_t)from_hyp, hyp.end());
+    out.append = render(tail_, first_new, at_start);
+    out.text   = render(tail_, first_new, true);
+    out.text_tokens = tail_.size() - first_new;
+
+    if (tail_.size() > k_tail_tokens) {
+        tail_.erase(tail_.begin(), tail_.end() - (ptrdiff_t)k_tail_tokens);
+        trimmed_ = true;
+    }
+
+    new_tokens_.fetch_add(m - from_hyp, std::memory_order_relaxed);
+    revised_tokens_.fetch_add(out.remove_tokens, std::memory_order_relaxed);
+    return out;
+}
+
+std::string transcript_stitcher::tail_text(size_t n_tokens) const {
+    return render(tail_, tail_.size() - std::min(n_tokens, tail_.size()), true);
+}
+
+void transcript_stitcher::reset() {
+    tail_.clear();
+    trimmed_ = false;
+}
+
+std::string transcript_stitcher::to_json() const {
+    return "{\"steps\":" + std::to_string(steps_.load(std::memory_order_relaxed)) +
+           ",\"hypothesis_tokens\":" + std::to_string(hypothesis_tokens_.load(std::memory_order_relaxed)) +
+           ",\"new_tokens\":" + std::to_string(new_tokens_.load(std::memory_order_relaxed)) +
+           ",\"revised_tokens\":" + std::to_string(revised_tokens_.load(std::memory_order_relaxed)) +
+           ",\"unchanged\":" + std::to_string(unchanged_.load(std::memory_order_relaxed)) +
+           ",\"no_overlap\":" + std::to_string(no_overlap_.load(std::memory_order_relaxed)) + "}";
+}
+
+size_t stitched_translation::revise(const stitch_update & u) {
+    size_t remove = u.remove_tokens;
+    size_t rewind = 0;
+    while (remove > 0 && !fragments_.empty()) {
+        const size_t tokens = fragments_.back().tokens;
+        fragments_.pop_back();
+        total_tokens_ -= tokens;
+        if (tokens > remove) {
+            rewind = tokens - remove;
+            break;
+        }
+        remove -= tokens;
+    }
+    return rewind;
+}
+
+void stitched_translation::append(size_t tokens, const std::string & target_lang, std::string translated) {
+    fragments_.push_back({ tokens, target_lang, std::move(translated) });
+    total_tokens_ += tokens;
+    // Corrections never reach past the stitcher's tail.
+    while (fragments_.size() > 1 && total_tokens_ - fragments_.front().tokens >= transcript_stitcher::k_tail_tokens) {
+        total_tokens_ -= fragments_.front().tokens;
+        fragments_.pop_front();
+    }
+}
+
+std::string stitched_translation::window(size_t window_tokens, const std::string & target_lang) const {
+    size_t first   = fragments_.size();
+    size_t covered = 0;
+    while (first > 0 && covered < window_tokens && fragments_[first - 1].target_lang == target_lang) {
+        --first;
+        covered += fragments_[first].tokens;
+    }
+    std::string out;
+    for (size_t i = first; i < fragments_.size(); ++i) {
+        if (fragments_[i].translated.empty()) continue;
+        if (!out.empty()) out += ' ';
+        out += fragments_[i].translated;
+    }
+    return out;
+}
+
+void stitched_translation::reset() {
+    fragments_.clear();
+    total_tokens_ = 0;
+}
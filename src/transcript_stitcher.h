@@ -0,0 +1,117 @@
+// Overlap-aware stitching of consecutive window transcriptions (--stitch).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// What one window adds to the running transcript: drop its last
+// remove_tokens tokens, then append `append`.
+struct stitch_update {
+    size_t      remove_tokens = 0;
+    size_t      remove_utf16  = 0;   // the same span in UTF-16 units of the rendered transcript
+    std::string append;              // rendered, with its leading separator
+    std::string text;                // the new words alone (translation, history)
+    size_t      text_tokens   = 0;   // tokens in `text`
+    size_t      window_tokens = 0;   // tokens in the hypothesis
+
+    bool empty() const { return remove_tokens == 0 && append.empty(); }
+};
+
+// Consecutive windows overlap by up to --length, so each step's text mostly
+// repeats the previous one. The stitcher aligns every new hypothesis
+// against the tail of the running transcript with a token-level edit
+// distance over normalized tokens (case and punctuation ignored) and
+// reports only what changed: the genuinely new suffix, plus a correction
+// when the hypothesis disagrees with words already emitted.
+//
+// The alignment is free to start anywhere in the tail (older words have
+// slid out of the window) but must reach the tail's end; unmatched words
+// at the hypothesis start are cut-off fragments and are ignored. Trailing
+// transcript words the hypothesis merely lacks are kept: a shorter window
+// dropping them is likelier than a correction. Words are split on spaces;
+// kana and Han characters count as one token each since Japanese and
+// Chinese are written without them.
+//
+// stitch() and reset() are called from one thread; to_json() may be called
+// from any thread.
+class transcript_stitcher {
+public:
+    static constexpr size_t k_tail_tokens = 64;   // alignment window
+    static constexpr int    k_min_overlap = 2;    // score below which nothing overlaps
+
+    stitch_update stitch(const std::string & hypothesis);
+
+    // The last n_tokens tokens of the transcript (as many as the tail
+    // holds), rendered without a leading separator.
+    std::string tail_text(size_t n_tokens) const;
+
+    // Session change: the next hypothesis starts a new transcript.
+    void reset();
+
+    // {"steps":..,"hypothesis_tokens":..,"new_tokens":..,"revised_tokens":..,
+    //  "unchanged":..,"no_overlap":..}
+    std::string to_json() const;
+
+private:
+    struct token {
+        std::string raw;
+        std::string norm;
+        bool        space_before = true;
+    };
+
+    static std::vector<token> tokenize(const std::string & text);
+
+    std::string render(const std::vector<token> & tokens, size_t from, bool at_start) const;
+
+    std::vector<token> tail_;
+    bool               trimmed_ = false;   // older tokens have slid out of tail_
+
+    std::atomic<uint64_t> steps_{0};
+    std::atomic<uint64_t> hypothesis_tokens_{0};
+    std::atomic<uint64_t> new_tokens_{0};
+    std::atomic<uint64_t> revised_tokens_{0};
+    std::atomic<uint64_t> unchanged_{0};
+    std::atomic<uint64_t> no_overlap_{0};
+};
+
+// The translated counterpart of the running transcript (--stitch with a
+// translation target). Each update's words are translated once, as one
+// fragment; a window is shown as the translations of the fragments it
+// spans, so the translation viewers see matches the displayed text without
+// translating the whole window every step.
+//
+// A correction that cuts into a fragment drops all of it: the fragment's
+// surviving words are translated again together with the update.
+//
+// Called from the thread that drives the stitcher.
+class stitched_translation {
+public:
+    // Drops the fragments update `u` revises; returns how many transcript
+    // tokens before u.text the next fragment has to cover again.
+    size_t revise(const stitch_update & u);
+
+    // The next fragment: `tokens` transcript tokens, translated into
+    // `target_lang` (empty when they were not translated).
+    void append(size_t tokens, const std::string & target_lang, std::string translated);
+
+    // Translations of the trailing fragments spanning the last
+    // `window_tokens` tokens, back to the last change of target language.
+    std::string window(size_t window_tokens, const std::string & target_lang) const;
+
+    void reset();
+
+private:
+    struct fragment {
+        size_t      tokens = 0;
+        std::string target_lang;
+        std::string translated;
+    };
+
+    std::deque<fragment> fragments_;
+    size_t               total_tokens_ = 0;
+};
@@ -0,0 +1,61 @@
+#include "translator.h"
+#include "json.h"
+
+#include "httplib.h"
+
+translator::translator(const std::string & url, int connect_timeout_ms, int read_timeout_ms)
+    : client_(std::make_unique<httplib::Client>(url)) {
+    client_->set_connection_timeout(connect_timeout_ms / 1000, (connect_timeout_ms % 1000) * 1000);
+    client_->set_read_timeout(read_timeout_ms / 1000, (read_timeout_ms % 1000) * 1000);
+}
+
+translator::~translator() = default;
+
+std::string translator::translate(const std::string & text, const std::string & source_lang,
+                                  const std::string & target_lang, bool & cached) {
+    // Tab separator avoids collision with text/lang content
+    const std::string key = text + "\t" + target_lang;
+    cached = key == cache_key_;
+    if (cached) {
+        cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        return cache_result_;
+    }
+
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    std::string body = "{" + json_str("q", text) +
+                       "," + json_str("source", source_lang) +
+                       "," + json_str("target", target_lang) + "}";
+
+    std::string translated;
+    auto res = client_->Post("/translate", body, "application/json");
+    if (!res || res->status != 200 || !json_get_string_field(res->body, "translatedText", translated)) {
+        translated.clear();
+        failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    cache_key_    = key;
+    cache_result_ = translated;
+    return translated;
+}
+
+void translator::reset_cache() {
+    cache_key_.clear();
+    cache_result_.clear();
+}
+
+std::string translator::to_json() const {
+    return "{\"requests\":" + std::to_string(requests()) +
+           ",\"cache_hits\":" + std::to_string(cache_hits()) +
+           ",\"failures\":" + std::to_string(failures()) + "}";
+}
+
+std::string fetch_translate_languages(const std::string & url) {
+    httplib::Client client(url);
+    client.set_connection_timeout(2);
+    client.set_read_timeout(3);
+    auto r = client.Get("/languages");
+    if (r && r->status == 200) {
+        return r->body;
+    }
+    return "[]";
+}
@@ -0,0 +1,63 @@
+// LibreTranslate client used by the main loop (--translate-url).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace httplib { class Client; }
+
+// Translates one subtitle at a time against a LibreTranslate server.
+//
+// Consecutive steps often recognize the same text (a pause, or a window
+// that has not moved past the utterance), so the previous request is
+// remembered: the same text and target again returns the previous result
+// without a round trip. Failures are cached the same way, so a text that
+// failed is not retried every step.
+//
+// translate() and reset_cache() are called from one thread; the counters
+// may be read from any thread.
+class translator {
+public:
+    static constexpr int k_connect_timeout_ms = 2000;
+    static constexpr int k_read_timeout_ms    = 3000;
+
+    explicit translator(const std::string & url,
+                        int connect_timeout_ms = k_connect_timeout_ms,
+                        int read_timeout_ms    = k_read_timeout_ms);
+    ~translator();
+
+    translator(const translator &) = delete;
+    translator & operator=(const translator &) = delete;
+
+    // "" when the request failed. `cached` says whether the result came
+    // from the previous request.
+    std::string translate(const std::string & text, const std::string & source_lang,
+                          const std::string & target_lang, bool & cached);
+
+    // A new session must not be served the previous session's result.
+    void reset_cache();
+
+    uint64_t requests()   const { return requests_.load(std::memory_order_relaxed); }
+    uint64_t cache_hits() const { return cache_hits_.load(std::memory_order_relaxed); }
+    uint64_t failures()   const { return failures_.load(std::memory_order_relaxed); }
+
+    // {"requests":..,"cache_hits":..,"failures":..}
+    std::string to_json() const;
+
+private:
+    std::unique_ptr<httplib::Client> client_;
+
+    // Previous request (text + '\t' + target) and its result.
+    std::string cache_key_;
+    std::string cache_result_;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+// GET /languages of the server at `url`, or "[]" when it cannot be reached.
+std::string fetch_translate_languages(const std::string & url);
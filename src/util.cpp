@@ -0,0 +1,46 @@
+#include "util.h"
+
+#include <chrono>
+#include <cctype>
+
+int64_t unix_time_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string trim_whitespace(const std::string & s) {
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+    return s.substr(begin, end - begin);
+}
+
+std::string to_lower_ascii(std::string s) {
+    for (char & c : s) {
+        const unsigned char uc = static_cast<unsigned char>(c);
+        c = static_cast<char>(std::tolower(uc));
+    }
+    return s;
+}
+
+std::string to_title_case_ascii(std::string s) {
+    bool capitalize = true;
+    for (char & c : s) {
+        const unsigned char uc = static_cast<unsigned char>(c);
+        if (std::isspace(uc) || c == '-' || c == '_') {
+            capitalize = true;
+            continue;
+        }
+        if (capitalize && std::isalpha(uc)) {
+            c = static_cast<char>(std::toupper(uc));
+            capitalize = false;
+            continue;
+        }
+        if (std::isalpha(uc)) {
+            c = static_cast<char>(std::tolower(uc));
+        }
+        capitalize = false;
+    }
+    return s;
+}
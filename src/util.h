@@ -0,0 +1,19 @@
+// Small helpers shared by the pipeline components.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Sample rate of everything past the audio source (WHISPER_SAMPLE_RATE).
+static constexpr int k_sample_rate = 16000;
+
+int64_t unix_time_ms();
+
+// s without leading/trailing whitespace.
+std::string trim_whitespace(const std::string & s);
+
+std::string to_lower_ascii(std::string s);
+
+// "english" -> "English", "haitian creole" -> "Haitian Creole".
+std::string to_title_case_ascii(std::string s);
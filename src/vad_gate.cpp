@@ -0,0 +1,106 @@
+#include "vad_gate.h"
+
+#include <algorithm>
+#include <cmath>
+
+float average_abs_energy(const std::vector<float> & samples) {
+    if (samples.empty()) {
+        return 0.0f;
+    }
+
+    float energy = 0.0f;
+    for (float sample : samples) {
+        energy += fabsf(sample);
+    }
+    return energy / samples.size();
+}
+
+bool should_process_audio_chunk(const std::vector<float> & samples,
+                                float vad_thold,
+                                float noise_floor,
+                                bool noise_floor_ready,
+                                float & energy_out,
+                                float & gate_out) {
+    energy_out = 0.0f;
+    gate_out = 0.0f;
+
+    if (samples.empty()) {
+        return false;
+    }
+
+    energy_out = average_abs_energy(samples);
+    const float vad_unit = std::max(0.0f, std::min(vad_thold, 1.0f));
+
+    // Base gate for environments where we don't have enough noise history yet.
+    const float base_gate = 0.00008f + 0.00020f * vad_unit;
+    gate_out = base_gate;
+
+    // Learn room noise over time and require speech energy above that floor.
+    if (noise_floor_ready) {
+        const float adaptive_gate = noise_floor * (1.6f + 1.2f * vad_unit);
+        gate_out = std::max(base_gate, adaptive_gate);
+    }
+
+    return energy_out >= gate_out;
+}
+
+const char * vad_outcome_name(vad_outcome outcome) {
+    switch (outcome) {
+        case vad_outcome::silent: return "silent";
+        case vad_outcome::warmup: return "warmup";
+        case vad_outcome::skip:   return "vad_skip";
+        case vad_outcome::bypass: return "vad_bypass";
+        case vad_outcome::pass:   return "infer";
+    }
+    return "infer";
+}
+
+vad_step vad_gate::judge(const std::vector<float> & samples, float vad_thold, bool use_vad) {
+    vad_step step;
+    const bool has_voice_energy = should_process_audio_chunk(
+        samples, vad_thold, noise_floor_, noise_floor_ready_, step.energy, step.gate);
+    step.noise_floor = noise_floor_;
+
+    if (!noise_floor_ready_) {
+        noise_floor_ = step.energy;
+        noise_floor_ready_ = true;
+    } else if (step.energy <= noise_floor_) {
+        noise_floor_ = 0.85f * noise_floor_ + 0.15f * step.energy;
+    } else {
+        const float clipped_rise = std::min(step.energy, noise_floor_ * 1.3f);
+        noise_floor_ = 0.96f * noise_floor_ + 0.04f * clipped_rise;
+    }
+
+    // Always ignore near-silent chunks, even when --no-vad is set.
+    if (step.energy < 0.00002f) {
+        step.outcome = vad_outcome::silent;
+        return step;
+    }
+
+    if (use_vad && warmup_chunks_ > 0) {
+        // Allow very strong speech energy even during startup warmup.
+        const bool obvious_voice = step.energy >= (step.gate * 2.2f);
+        if (!obvious_voice) {
+            --warmup_chunks_;
+            step.outcome = vad_outcome::warmup;
+            return step;
+        }
+        warmup_chunks_ = 0;
+    }
+
+    if (use_vad && !has_voice_energy) {
+        ++stall_chunks_;
+
+        const float vad_unit = std::max(0.0f, std::min(vad_thold, 1.0f));
+        const float stall_bypass_gate = 0.00002f + 0.00008f * vad_unit;
+        if (stall_chunks_ < 6 || step.energy < stall_bypass_gate) {
+            step.outcome = vad_outcome::skip;
+            return step;
+        }
+        step.outcome = vad_outcome::bypass;
+    } else {
+        step.outcome = vad_outcome::pass;
+    }
+    stall_chunks_ = 0;
+    return step;
+}
@@ -0,0 +1,53 @@
+// Energy-based voice activity gate that decides which audio steps are worth
+// a whisper_full call. Shared by the main loop and the replay benchmark so
+// both judge a step exactly the same way.
+
+#pragma once
+
+#include <vector>
+
+float average_abs_energy(const std::vector<float> & samples);
+
+// True when the step's mean |sample| clears the gate. The gate starts at a
+// fixed base and, once a noise floor is known, scales with it.
+bool should_process_audio_chunk(const std::vector<float> & samples,
+                                float vad_thold,
+                                float noise_floor,
+                                bool noise_floor_ready,
+                                float & energy_out,
+                                float & gate_out);
+
+enum class vad_outcome {
+    silent,     // below the absolute floor, dropped even with --no-vad
+    warmup,     // dropped while the noise floor settles
+    skip,       // below the gate
+    bypass,     // below the gate, but inferred after a long stall
+    pass,       // above the gate
+};
+
+// Name used in logs and the recorder sidecar.
+const char * vad_outcome_name(vad_outcome outcome);
+
+inline bool vad_runs_inference(vad_outcome outcome) {
+    return outcome == vad_outcome::bypass || outcome == vad_outcome::pass;
+}
+
+struct vad_step {
+    vad_outcome outcome     = vad_outcome::silent;
+    float       energy      = 0.0f;
+    float       gate        = 0.0f;
+    float       noise_floor = 0.0f;   // the floor this step was judged against
+};
+
+// Per-stream gate state: adaptive noise floor, start-up warmup and the
+// stall counter that lets quiet speech through after a run of skips.
+class vad_gate {
+public:
+    vad_step judge(const std::vector<float> & samples, float vad_thold, bool use_vad);
+
+private:
+    float noise_floor_       = 0.0f;
+    bool  noise_floor_ready_ = false;
+    int   warmup_chunks_     = 2;
+    int   stall_chunks_      = 0;
+};
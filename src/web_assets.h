@@ -0,0 +1,24 @@
+// Web UI assets embedded at build time (generated from web/ by
+// cmake/embed_web_assets.cmake)
+
+#pragma once
+
+#include <cstddef>
+
+struct web_asset_blob {
+    const unsigned char * data;
+    size_t                size;   // 0 = variant not available
+};
+
+struct web_asset {
+    const char *   path;          // URL path ("/" for index.html)
+    const char *   content_type;
+    const char *   etag;          // weak, shared by all encodings
+    const char *   cache_control;
+    web_asset_blob identity;
+    web_asset_blob gzip;
+    web_asset_blob brotli;
+};
+
+const web_asset * web_assets_begin();
+const web_asset * web_assets_end();
@@ -0,0 +1,65 @@
+#include "work_stealing_queue.h"
+
+#include <chrono>
+
+work_stealing_queue::work_stealing_queue(size_t n_workers) {
+    for (size_t i = 0; i < n_workers; ++i) {
+        lanes_.push_back(std::make_unique<lane>());
+    }
+}
+
+void work_stealing_queue::push(size_t worker, task t) {
+    // Counted before it becomes visible: a thief could otherwise run it and
+    // bring pending_ to zero while the producer is still pushing.
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(lanes_[worker]->mtx);
+        lanes_[worker]->tasks.push_front(std::move(t));
+    }
+    std::lock_guard<std::mutex> lock(wait_mtx_);
+    cv_.notify_all();
+}
+
+bool work_stealing_queue::try_pop(size_t worker, task & out) {
+    {
+        lane & own = *lanes_[worker];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < lanes_.size(); ++k) {
+        lane & victim = *lanes_[(worker + k) % lanes_.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void work_stealing_queue::work(size_t worker) {
+    task t;
+    while (true) {
+        if (try_pop(worker, t)) {
+            t(worker);
+            t = nullptr;
+            // Tasks pushed by t were counted before this decrement, so
+            // pending_ only reaches zero once everything is done.
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(wait_mtx_);
+                cv_.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wait_mtx_);
+        if (pending_.load(std::memory_order_acquire) == 0) break;
+        // Another worker's running task may still push more work.
+        cv_.wait_for(lock, std::chrono::milliseconds(50));
+    }
+}
@@ -0,0 +1,53 @@
+// Task pool with one deque per worker thread and stealing between them.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Each worker runs tasks from the front of its own deque and, when that is
+// empty, steals from the back of another worker's. A task may push more
+// tasks (e.g. a file that splits into chunks); they go to the front of the
+// pushing worker's deque, so it keeps working on what it just produced
+// while idle workers take the far end.
+//
+// Tasks are expected to be coarse (seconds of inference), so every deque
+// is guarded by a plain mutex.
+class work_stealing_queue {
+public:
+    using task = std::function<void(size_t worker)>;
+
+    explicit work_stealing_queue(size_t n_workers);
+
+    size_t worker_count() const { return lanes_.size(); }
+
+    void push(size_t worker, task t);
+
+    // Runs tasks as `worker` until every task, including ones pushed while
+    // running, has finished. Call from one thread per worker index, after
+    // the initial tasks have been pushed.
+    void work(size_t worker);
+
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct lane {
+        std::mutex       mtx;
+        std::deque<task> tasks;
+    };
+
+    bool try_pop(size_t worker, task & out);
+
+    std::vector<std::unique_ptr<lane>> lanes_;
+    std::atomic<size_t>                pending_{0};   // queued + running
+    std::atomic<uint64_t>              steals_{0};
+    std::mutex                         wait_mtx_;
+    std::condition_variable            cv_;
+};
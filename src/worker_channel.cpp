@@ -0,0 +1,476 @@
+#include "worker_channel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+extern char ** environ;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory rings need lock-free 64-bit atomics");
+static_assert(std::atomic<int64_t>::is_always_lock_free,  "shared-memory rings need lock-free 64-bit atomics");
+
+static constexpr uint32_t k_channel_magic   = 0x4c535743;   // "LSWC"
+static constexpr uint32_t k_channel_version = 4;
+
+struct worker_channel::ring_ctl {
+    alignas(64) std::atomic<uint64_t> head{0};   // bytes written (producer)
+    alignas(64) std::atomic<uint64_t> tail{0};   // bytes read (consumer)
+};
+
+struct worker_channel::shared_block {
+    uint32_t magic   = k_channel_magic;
+    uint32_t version = k_channel_version;
+    uint64_t total_bytes = 0;
+    int32_t  index     = 0;
+    int32_t  front_pid = 0;
+
+    // Front -> worker.
+    std::atomic<uint32_t> shutdown{0};
+    std::atomic<uint64_t> session_gen{0};
+    std::atomic<uint64_t> lang_seq{0};      // seqlock over lang_words; odd = being written
+    std::atomic<uint64_t> lang_words[4];    // source (16 bytes), target (16 bytes)
+
+    // Worker -> front.
+    std::atomic<uint32_t> ready{0};
+    std::atomic<int32_t>  multilingual{-1};
+    std::atomic<int64_t>  heartbeat_ms{0};
+    std::atomic<int32_t>  load_permille{0};
+    std::atomic<uint64_t> steps{0};
+    std::atomic<uint64_t> dropped_messages{0};
+
+    std::atomic<uint64_t> audio_overflow{0};
+
+    ring_ctl audio;    // front -> worker
+    ring_ctl result;   // worker -> front
+};
+
+// Control block rounded up to a cache line; the ring data follows it.
+size_t worker_channel::header_bytes() {
+    return (sizeof(shared_block) + 63) & ~(size_t)63;
+}
+
+// ---------------------------------------------------------------------------
+// Setup
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<worker_channel> worker_channel::create(const std::string & name, int index, std::string & error) {
+    const size_t header = header_bytes();
+    const size_t total  = header + k_audio_bytes + k_result_bytes;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        shm_unlink(name.c_str());   // left over from a front that was killed
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        error = std::string("shm_open: ") + strerror(errno);
+        return nullptr;
+    }
+    if (ftruncate(fd, (off_t)total) != 0) {
+        error = std::string("ftruncate: ") + strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+    void * base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int map_errno = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        error = std::string("mmap: ") + strerror(map_errno);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    std::unique_ptr<worker_channel> ch(new worker_channel());
+    ch->name_  = name;
+    ch->owner_ = true;
+    ch->base_  = base;
+    ch->size_  = total;
+    ch->block_ = new (base) shared_block();
+    ch->block_->total_bytes = total;
+    ch->block_->index       = index;
+    ch->block_->front_pid   = (int32_t)getpid();
+    for (auto & w : ch->block_->lang_words) w.store(0, std::memory_order_relaxed);
+    ch->audio_data_  = static_cast<unsigned char *>(base) + header;
+    ch->result_data_ = ch->audio_data_ + k_audio_bytes;
+    return ch;
+}
+
+std::unique_ptr<worker_channel> worker_channel::open(const std::string & name, std::string & error) {
+    const size_t header = header_bytes();
+    const size_t total  = header + k_audio_bytes + k_result_bytes;
+
+    const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        error = std::string("shm_open: ") + strerror(errno);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != total) {
+        error = "segment size mismatch (front and worker are different builds?)";
+        close(fd);
+        return nullptr;
+    }
+    void * base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int map_errno = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        error = std::string("mmap: ") + strerror(map_errno);
+        return nullptr;
+    }
+
+    auto * block = static_cast<shared_block *>(base);
+    if (block->magic != k_channel_magic || block->version != k_channel_version || block->total_bytes != total) {
+        error = "segment layout mismatch (front and worker are different builds?)";
+        munmap(base, total);
+        return nullptr;
+    }
+
+    std::unique_ptr<worker_channel> ch(new worker_channel());
+    ch->name_  = name;
+    ch->base_  = base;
+    ch->size_  = total;
+    ch->block_ = block;
+    ch->audio_data_  = static_cast<unsigned char *>(base) + header;
+    ch->result_data_ = ch->audio_data_ + k_audio_bytes;
+    return ch;
+}
+
+worker_channel::~worker_channel() {
+    if (base_) munmap(base_, size_);
+    if (owner_) shm_unlink(name_.c_str());
+}
+
+int worker_channel::index() const {
+    return block_->index;
+}
+
+// ---------------------------------------------------------------------------
+// Rings
+// ---------------------------------------------------------------------------
+
+size_t worker_channel::ring_write(ring_ctl & ring, unsigned char * data, size_t cap,
+                                  const void * src, size_t n, bool all_or_nothing) {
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    const size_t room = cap - (size_t)(head - tail);
+    if (n > room) {
+        if (all_or_nothing) return 0;
+        n = room;
+    }
+
+    const size_t off   = (size_t)(head & (cap - 1));
+    const size_t first = std::min(n, cap - off);
+    memcpy(data + off, src, first);
+    memcpy(data, static_cast<const unsigned char *>(src) + first, n - first);
+    ring.head.store(head + n, std::memory_order_release);
+    return n;
+}
+
+size_t worker_channel::ring_read(ring_ctl & ring, const unsigned char * data, size_t cap,
+                                 void * dst, size_t n, bool peek) {
+    const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    n = std::min(n, (size_t)(head - tail));
+
+    const size_t off   = (size_t)(tail & (cap - 1));
+    const size_t first = std::min(n, cap - off);
+    memcpy(dst, data + off, first);
+    memcpy(static_cast<unsigned char *>(dst) + first, data, n - first);
+    if (!peek) ring.tail.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+size_t worker_channel::write_audio(const float * samples, size_t n) {
+    // Byte counts stay multiples of 4, so a sample is never split.
+    const size_t written = ring_write(block_->audio, audio_data_, k_audio_bytes,
+                                      samples, n * sizeof(float), false) / sizeof(float);
+    if (written < n) {
+        block_->audio_overflow.fetch_add(n - written, std::memory_order_relaxed);
+    }
+    return written;
+}
+
+size_t worker_channel::read_audio(float * out, size_t max_samples) {
+    return ring_read(block_->audio, audio_data_, k_audio_bytes, out, max_samples * sizeof(float), false) /
+           sizeof(float);
+}
+
+bool worker_channel::write_message(worker_message type, const std::string & payload) {
+    // One contiguous write, so the front sees a record whole or not at all.
+    std::string record(8 + payload.size(), '\0');
+    const uint32_t len = (uint32_t)payload.size();
+    const uint32_t t   = (uint32_t)type;
+    memcpy(&record[0], &len, 4);
+    memcpy(&record[4], &t, 4);
+    memcpy(&record[8], payload.data(), payload.size());
+    if (ring_write(block_->result, result_data_, k_result_bytes, record.data(), record.size(), true) == 0) {
+        block_->dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool worker_channel::read_message(worker_message & type, std::string & payload) {
+    unsigned char hdr[8];
+    if (ring_read(block_->result, result_data_, k_result_bytes, hdr, sizeof(hdr), true) < sizeof(hdr)) {
+        return false;
+    }
+    uint32_t len = 0;
+    uint32_t t   = 0;
+    memcpy(&len, hdr, 4);
+    memcpy(&t, hdr + 4, 4);
+
+    payload.resize(8 + (size_t)len);
+    ring_read(block_->result, result_data_, k_result_bytes, &payload[0], payload.size(), false);
+    payload.erase(0, 8);
+    type = (worker_message)t;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Control block
+// ---------------------------------------------------------------------------
+
+void worker_channel::begin_session() {
+    block_->session_gen.fetch_add(1, std::memory_order_release);
+}
+
+static void pack_lang(const std::string & code, std::atomic<uint64_t> * words) {
+    uint64_t w[2] = {0, 0};
+    memcpy(w, code.data(), std::min(code.size(), worker_channel::k_max_lang));
+    words[0].store(w[0], std::memory_order_relaxed);
+    words[1].store(w[1], std::memory_order_relaxed);
+}
+
+static std::string unpack_lang(const uint64_t * w) {
+    char buf[17] = {};
+    memcpy(buf, w, 16);
+    return std::string(buf, strnlen(buf, 16));
+}
+
+bool worker_channel::set_languages(const std::string & source_lang, const std::string & target_lang) {
+    if (source_lang.size() > k_max_lang || target_lang.size() > k_max_lang) return false;
+
+    const uint64_t seq = block_->lang_seq.load(std::memory_order_relaxed);
+    block_->lang_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    pack_lang(source_lang, &block_->lang_words[0]);
+    pack_lang(target_lang, &block_->lang_words[2]);
+    block_->lang_seq.store(seq + 2, std::memory_order_release);
+    return true;
+}
+
+bool worker_channel::read_languages(uint64_t & seq, std::string & source_lang, std::string & target_lang) const {
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        const uint64_t s1 = block_->lang_seq.load(std::memory_order_acquire);
+        if (s1 == seq) return false;
+        if (s1 & 1) continue;
+
+        uint64_t w[4];
+        for (int i = 0; i < 4; ++i) w[i] = block_->lang_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block_->lang_seq.load(std::memory_order_relaxed) != s1) continue;
+
+        source_lang = unpack_lang(&w[0]);
+        target_lang = unpack_lang(&w[2]);
+        seq = s1;
+        return true;
+    }
+    return false;
+}
+
+void worker_channel::request_shutdown() {
+    block_->shutdown.store(1, std::memory_order_release);
+}
+
+void worker_channel::reset_worker_state() {
+    block_->audio.tail.store(block_->audio.head.load(std::memory_order_relaxed), std::memory_order_release);
+    block_->ready.store(0, std::memory_order_relaxed);
+    block_->heartbeat_ms.store(0, std::memory_order_relaxed);
+    block_->load_permille.store(0, std::memory_order_relaxed);
+}
+
+int64_t worker_channel::heartbeat_ms() const {
+    return block_->heartbeat_ms.load(std::memory_order_relaxed);
+}
+
+bool worker_channel::worker_ready() const {
+    return block_->ready.load(std::memory_order_acquire) != 0;
+}
+
+int worker_channel::model_multilingual() const {
+    return block_->multilingual.load(std::memory_order_relaxed);
+}
+
+int worker_channel::load_permille() const {
+    return block_->load_permille.load(std::memory_order_relaxed);
+}
+
+uint64_t worker_channel::steps() const {
+    return block_->steps.load(std::memory_order_relaxed);
+}
+
+size_t worker_channel::audio_backlog_samples() const {
+    return (size_t)(block_->audio.head.load(std::memory_order_relaxed) -
+                    block_->audio.tail.load(std::memory_order_relaxed)) / sizeof(float);
+}
+
+uint64_t worker_channel::audio_overflow_samples() const {
+    return block_->audio_overflow.load(std::memory_order_relaxed);
+}
+
+uint64_t worker_channel::dropped_messages() const {
+    return block_->dropped_messages.load(std::memory_order_relaxed);
+}
+
+uint64_t worker_channel::session_generation() const {
+    return block_->session_gen.load(std::memory_order_acquire);
+}
+
+bool worker_channel::shutdown_requested() const {
+    return block_->shutdown.load(std::memory_order_acquire) != 0;
+}
+
+bool worker_channel::front_alive() const {
+    return getppid() == (pid_t)block_->front_pid;
+}
+
+void worker_channel::set_ready(bool ready) {
+    block_->ready.store(ready ? 1 : 0, std::memory_order_release);
+}
+
+void worker_channel::set_model_multilingual(bool multilingual) {
+    block_->multilingual.store(multilingual ? 1 : 0, std::memory_order_relaxed);
+}
+
+void worker_channel::heartbeat(int64_t now_ms) {
+    block_->heartbeat_ms.store(now_ms, std::memory_order_relaxed);
+}
+
+void worker_channel::report_step(int load_permille) {
+    block_->load_permille.store(load_permille, std::memory_order_relaxed);
+    block_->steps.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Frame encoding
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct frame_wire {
+    uint64_t version;
+    int64_t  capture_ms;
+    int64_t  infer_start_ms;
+    int64_t  infer_end_ms;
+    int64_t  translated_ms;
+    int64_t  publish_ms;
+    int32_t  tier;
+    float    language_prob;
+    float    confidence;
+    float    no_speech_prob;
+    int32_t  stitch_remove;
+    uint32_t n_text;
+    uint32_t n_translated;
+    uint32_t n_language;
+    uint32_t n_stitch_append;
+};
+
+} // namespace
+
+std::string encode_frame(const subtitle_frame & f) {
+    frame_wire w;
+    w.version        = f.version;
+    w.capture_ms     = f.timing.capture_ms;
+    w.infer_start_ms = f.timing.infer_start_ms;
+    w.infer_end_ms   = f.timing.infer_end_ms;
+    w.translated_ms  = f.timing.translated_ms;
+    w.publish_ms     = f.timing.publish_ms;
+    w.tier           = f.tier;
+    w.language_prob  = f.language_prob;
+    w.confidence     = f.confidence;
+    w.no_speech_prob = f.no_speech_prob;
+    w.stitch_remove  = f.stitch_remove;
+    w.n_text         = (uint32_t)f.text.size();
+    w.n_translated   = (uint32_t)f.translated.size();
+    w.n_language     = (uint32_t)f.language.size();
+    w.n_stitch_append = (uint32_t)f.stitch_append.size();
+
+    std::string out(reinterpret_cast<const char *>(&w), sizeof(w));
+    out += f.text;
+    out += f.translated;
+    out += f.language;
+    out += f.stitch_append;
+    return out;
+}
+
+bool decode_frame(const std::string & payload, subtitle_frame & out) {
+    frame_wire w;
+    if (payload.size() < sizeof(w)) return false;
+    memcpy(&w, payload.data(), sizeof(w));
+    if (payload.size() != sizeof(w) + (size_t)w.n_text + w.n_translated + w.n_language + w.n_stitch_append) return false;
+
+    size_t pos = sizeof(w);
+    out.version               = w.version;
+    out.timing.capture_ms     = w.capture_ms;
+    out.timing.infer_start_ms = w.infer_start_ms;
+    out.timing.infer_end_ms   = w.infer_end_ms;
+    out.timing.translated_ms  = w.translated_ms;
+    out.timing.publish_ms     = w.publish_ms;
+    out.tier                  = w.tier;
+    out.language_prob         = w.language_prob;
+    out.confidence            = w.confidence;
+    out.no_speech_prob        = w.no_speech_prob;
+    out.stitch_remove         = w.stitch_remove;
+    out.text.assign(payload, pos, w.n_text);
+    pos += w.n_text;
+    out.translated.assign(payload, pos, w.n_translated);
+    pos += w.n_translated;
+    out.language.assign(payload, pos, w.n_language);
+    pos += w.n_language;
+    out.stitch_append.assign(payload, pos, w.n_stitch_append);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Processes
+// ---------------------------------------------------------------------------
+
+std::string current_executable_path(const char * argv0) {
+#if defined(__APPLE__)
+    char buf[PATH_MAX];
+    uint32_t size = sizeof(buf);
+    if (_NSGetExecutablePath(buf, &size) == 0) return buf;
+#else
+    char buf[PATH_MAX];
+    const ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (n > 0) return std::string(buf, (size_t)n);
+#endif
+    return argv0;
+}
+
+pid_t spawn_process(const std::string & exe, const std::vector<std::string> & args, std::string & error) {
+    std::vector<char *> argv;
+    for (const std::string & a : args) argv.push_back(const_cast<char *>(a.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid = -1;
+    const int rc = posix_spawn(&pid, exe.c_str(), nullptr, nullptr, argv.data(), environ);
+    if (rc != 0) {
+        error = strerror(rc);
+        return -1;
+    }
+    return pid;
+}
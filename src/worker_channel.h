@@ -0,0 +1,138 @@
+// Shared-memory transport between the --workers front process and its
+// inference workers, plus the process helpers the front uses to run them.
+
+#pragma once
+
+#include "subtitle_events.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+// Result records sent worker -> front.
+enum class worker_message : uint32_t {
+    frame  = 1,   // encode_frame() payload
+    status = 2,   // `event: status` JSON
+};
+
+// One POSIX shared-memory segment per worker slot, created by the front and
+// opened by the worker (--worker-shm NAME). Two lock-free SPSC byte rings
+// carry the traffic: 16 kHz float audio front -> worker, and length-prefixed
+// result records worker -> front. A control block next to them holds the
+// session generation and languages (front -> worker) and the worker's
+// heartbeat and load (worker -> front).
+//
+// Every shared field is a lock-free std::atomic, so neither side ever waits
+// on the other and a worker that crashes mid-write leaves no lock behind:
+// records only become visible once complete, and the front resets the
+// audio ring before it starts a replacement worker.
+class worker_channel {
+public:
+    static constexpr size_t k_audio_bytes  = 4u << 20;   // ~65 s of 16 kHz float
+    static constexpr size_t k_result_bytes = 1u << 20;
+    static constexpr size_t k_max_lang     = 15;         // language code bytes
+
+    // Front. Replaces a stale segment of the same name.
+    static std::unique_ptr<worker_channel> create(const std::string & name, int index, std::string & error);
+
+    // Worker.
+    static std::unique_ptr<worker_channel> open(const std::string & name, std::string & error);
+
+    ~worker_channel();
+
+    worker_channel(const worker_channel &) = delete;
+    worker_channel & operator=(const worker_channel &) = delete;
+
+    const std::string & name() const { return name_; }
+    int index() const;
+
+    // ---- Front side ----
+
+    // Returns the number of samples accepted; the rest did not fit.
+    size_t write_audio(const float * samples, size_t n);
+
+    bool read_message(worker_message & type, std::string & payload);
+
+    // A new session takes over the slot: the worker drops its audio history
+    // and text at its next step.
+    void begin_session();
+
+    // Codes longer than k_max_lang are rejected.
+    bool set_languages(const std::string & source_lang, const std::string & target_lang);
+
+    void request_shutdown();
+
+    // Before starting a replacement worker: drop the audio the dead one
+    // never consumed and clear its heartbeat/readiness.
+    void reset_worker_state();
+
+    int64_t  heartbeat_ms() const;
+    bool     worker_ready() const;
+    int      model_multilingual() const;   // -1 until a worker has loaded the model
+    int      load_permille() const;
+    uint64_t steps() const;
+    size_t   audio_backlog_samples() const;
+    uint64_t audio_overflow_samples() const;
+    uint64_t dropped_messages() const;
+
+    // ---- Worker side ----
+
+    size_t read_audio(float * out, size_t max_samples);
+
+    // False (and counted) when the front is not draining results.
+    bool write_message(worker_message type, const std::string & payload);
+
+    uint64_t session_generation() const;
+
+    // True when the languages changed since `seq` (which is updated).
+    bool read_languages(uint64_t & seq, std::string & source_lang, std::string & target_lang) const;
+
+    bool shutdown_requested() const;
+
+    // False once the front process is gone (the worker was reparented).
+    bool front_alive() const;
+
+    void set_ready(bool ready);
+    void set_model_multilingual(bool multilingual);
+    void heartbeat(int64_t now_ms);
+
+    // Inference time / audio time of recent steps, in 1/1000.
+    void report_step(int load_permille);
+
+private:
+    struct ring_ctl;
+    struct shared_block;
+
+    worker_channel() = default;
+
+    static size_t header_bytes();
+
+    static size_t ring_write(ring_ctl & ring, unsigned char * data, size_t cap,
+                             const void * src, size_t n, bool all_or_nothing);
+    static size_t ring_read(ring_ctl & ring, const unsigned char * data, size_t cap,
+                            void * dst, size_t n, bool peek);
+
+    std::string     name_;
+    bool            owner_ = false;
+    void *          base_  = nullptr;
+    size_t          size_  = 0;
+    shared_block *  block_ = nullptr;
+    unsigned char * audio_data_  = nullptr;
+    unsigned char * result_data_ = nullptr;
+};
+
+// Compact binary form of a frame for worker_message::frame.
+std::string encode_frame(const subtitle_frame & f);
+bool decode_frame(const std::string & payload, subtitle_frame & out);
+
+// Path of the running executable (for spawning workers), falling back to
+// argv0.
+std::string current_executable_path(const char * argv0);
+
+// Starts `exe` with `args` (args[0] included). Returns the pid or -1.
+pid_t spawn_process(const std::string & exe, const std::vector<std::string> & args, std::string & error);
@@ -0,0 +1,219 @@
+const subtitle = document.getElementById('subtitle');
+const original = document.getElementById('original');
+const langBadge = document.getElementById('language-badge');
+const container = document.getElementById('subtitle-container');
+const status = document.getElementById('status');
+const sourceLangSelect = document.getElementById('source-lang-select');
+const targetLangSelect = document.getElementById('target-lang-select');
+const targetLangRow = document.getElementById('target-lang-row');
+const pageParams = new URLSearchParams(window.location.search);
+const settingsMode = pageParams.get('settings') === '1';
+// ?session=ID picks the ingest session when the server runs --workers.
+const sessionId = pageParams.get('session');
+if (settingsMode) {
+    document.body.classList.add('settings-mode');
+}
+let fadeTimer = null;
+let translateEnabled = false;
+let settingsLoaded = false;
+
+function withSession(path) {
+    if (!sessionId) return path;
+    return path + (path.includes('?') ? '&' : '?') + 'session=' + encodeURIComponent(sessionId);
+}
+
+function clearSelectOptions(select) {
+    while (select.firstChild) select.removeChild(select.firstChild);
+}
+
+function addOption(select, value, text) {
+    const opt = document.createElement('option');
+    opt.value = value;
+    opt.textContent = text;
+    select.appendChild(opt);
+}
+
+async function postConfig(patch) {
+    await fetch(withSession('/api/config'), {
+        method: 'POST',
+        headers: {'Content-Type': 'application/json'},
+        body: JSON.stringify(patch)
+    });
+}
+
+async function loadSourceLanguages(selected) {
+    const res = await fetch('/api/source-languages');
+    if (!res.ok) throw new Error('source languages unavailable');
+    const languages = await res.json();
+    clearSelectOptions(sourceLangSelect);
+    if (!Array.isArray(languages) || !languages.length) {
+        addOption(sourceLangSelect, 'ko', 'Korean');
+    } else {
+        for (const lang of languages) {
+            addOption(sourceLangSelect, lang.code, lang.name);
+        }
+    }
+    sourceLangSelect.value = selected || sourceLangSelect.value || 'ko';
+}
+
+async function loadTargetLanguages(selected) {
+    if (!translateEnabled) {
+        targetLangRow.style.display = 'none';
+        return;
+    }
+
+    targetLangRow.style.display = 'flex';
+    const langRes = await fetch('/api/languages');
+    const languages = await langRes.json();
+
+    clearSelectOptions(targetLangSelect);
+    addOption(targetLangSelect, '', 'Translate off');
+    if (Array.isArray(languages)) {
+        for (const lang of languages) {
+            addOption(targetLangSelect, lang.code, lang.name);
+        }
+    }
+    targetLangSelect.value = selected || '';
+}
+
+async function loadSettings() {
+    if (!settingsMode) return;
+
+    try {
+        // A --workers session exists once /events has connected; until
+        // then the server answers 404 and the "ready" status retries.
+        const res = await fetch(withSession('/api/config'));
+        if (!res.ok) throw new Error('config unavailable');
+        const cfg = await res.json();
+        translateEnabled = !!cfg.translate_enabled;
+        await loadSourceLanguages(cfg.source_lang || 'ko');
+        await loadTargetLanguages(cfg.target_lang || '');
+        settingsLoaded = true;
+    } catch (e) {
+        targetLangRow.style.display = 'none';
+    }
+}
+
+sourceLangSelect.addEventListener('change', async () => {
+    try {
+        await postConfig({source_lang: sourceLangSelect.value});
+    } catch (e) { /* ignore */ }
+});
+
+targetLangSelect.addEventListener('change', async () => {
+    try {
+        await postConfig({target_lang: targetLangSelect.value});
+    } catch (e) { /* ignore */ }
+});
+
+// Delta-mode stream state (see build_delta_event in src/subtitle_events.cpp).
+let current = null;
+
+// A patch is either a full string or [prefix, suffix] relative to the
+// previous value; an absent field is unchanged.
+function applyPatch(prev, patch) {
+    if (patch === undefined) return prev;
+    if (Array.isArray(patch)) return prev.slice(0, patch[0]) + patch[1];
+    return patch;
+}
+
+function setText(el, text) {
+    if (el.textContent !== text) el.textContent = text;
+}
+
+function render(data) {
+    if (!data.text) return;
+
+    if (data.translated) {
+        setText(subtitle, data.translated);
+        setText(original, data.text || '');
+        if (settingsMode && original.textContent) {
+            original.classList.add('show-original');
+        }
+    } else {
+        setText(subtitle, data.text);
+        setText(original, '');
+        original.classList.remove('show-original');
+    }
+
+    if (data.language) {
+        setText(langBadge, data.language.toUpperCase());
+    }
+
+    container.classList.remove('fade');
+    if (fadeTimer) clearTimeout(fadeTimer);
+    fadeTimer = setTimeout(() => {
+        container.classList.add('fade');
+    }, 5000);
+}
+
+// Report receive time for a sampled subset of frames (the server scales the
+// sampling rate with the number of viewers).
+function sendLatencyBeacon(data) {
+    if (!data.v || !data.beacon || Math.random() >= data.beacon) return;
+    const body = JSON.stringify({v: data.v, t: Date.now()});
+    if (navigator.sendBeacon) {
+        navigator.sendBeacon(withSession('/api/latency'), body);
+    } else {
+        fetch(withSession('/api/latency'), {method: 'POST', body: body, keepalive: true}).catch(() => {});
+    }
+}
+
+function connect() {
+    const es = new EventSource(withSession('/events?mode=delta'));
+    current = null;
+
+    es.onopen = () => {
+        status.textContent = '\u25CF Connected';
+        status.className = 'connected';
+    };
+
+    // Startup progress; the server answers before the model is loaded.
+    es.addEventListener('status', (event) => {
+        try {
+            const data = JSON.parse(event.data);
+            if (data.state === 'ready') {
+                status.textContent = '\u25CF Connected';
+                status.className = 'connected';
+                if (settingsMode && !settingsLoaded) loadSettings();
+            } else {
+                status.textContent = '\u25CF Loading' + (data.phase ? ' (' + data.phase + ')' : '');
+                status.className = 'loading';
+            }
+        } catch (e) { /* ignore parse errors */ }
+    });
+
+    es.onmessage = (event) => {
+        try {
+            const data = JSON.parse(event.data);
+            if (data.key) {
+                current = {v: data.v, text: data.text, translated: data.translated, language: data.language};
+            } else {
+                if (!current || data.base !== current.v) {
+                    // Out of sync; a new connection starts with a keyframe.
+                    es.close();
+                    connect();
+                    return;
+                }
+                current = {
+                    v: data.v,
+                    text: applyPatch(current.text, data.text),
+                    translated: applyPatch(current.translated, data.translated),
+                    language: applyPatch(current.language, data.language),
+                };
+            }
+            render(current);
+            sendLatencyBeacon(data);
+        } catch (e) { /* ignore parse errors */ }
+    };
+
+    es.onerror = () => {
+        status.textContent = '\u25CF Disconnected';
+        status.className = 'disconnected';
+        es.close();
+        setTimeout(connect, 2000);
+    };
+}
+
+loadSettings();
+connect();